@@ -0,0 +1,37 @@
+#version 450
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+const uint kNoTexture = 0xFFFFFFFFu;
+
+// Features fixed per pipeline, so the unused paths are compiled out. The ids are MeshShader's in
+// src/model/mesh_shader.h.
+layout(constant_id = 0) const bool kTextured = true;
+layout(constant_id = 1) const bool kAlphaTest = false;
+
+layout(set = 1, binding = 0) uniform sampler2DArray textures[];
+
+layout(push_constant) uniform Draw {
+    uint instanceOffset;
+    uint textureIndex;
+} draw;
+
+layout(location = 0) in vec2 inUV;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) flat in uint inTextureLayer;
+layout(location = 3) flat in float inAlphaCutoff;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec4 color = inColor;
+    if (kTextured && draw.textureIndex != kNoTexture) {
+        color *= texture(textures[draw.textureIndex], vec3(inUV, inTextureLayer));
+    }
+
+    if (kAlphaTest && color.a < inAlphaCutoff) {
+        discard;
+    }
+
+    outColor = color;
+}
\ No newline at end of file
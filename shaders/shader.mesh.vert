@@ -0,0 +1,42 @@
+#version 450
+
+layout(binding = 0) uniform Camera {
+    mat4 proj;
+    mat4 view;
+} camera;
+
+// The model matrix and the parameters of the mesh's material.
+struct Instance {
+    mat4 model;
+    vec4 baseColor;
+    uint textureLayer;
+    float alphaCutoff;
+};
+
+layout(std430, binding = 1) readonly buffer Instances {
+    Instance instances[];
+} instances;
+
+layout(push_constant) uniform Draw {
+    uint instanceOffset;
+    uint textureIndex;
+} draw;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) in vec4 inColor;
+
+layout(location = 0) out vec2 outUV;
+layout(location = 1) out vec4 outColor;
+layout(location = 2) flat out uint outTextureLayer;
+layout(location = 3) flat out float outAlphaCutoff;
+
+void main() {
+    Instance instance = instances.instances[draw.instanceOffset + gl_InstanceIndex];
+    gl_Position = camera.proj * camera.view * instance.model * vec4(inPosition, 1.0);
+
+    outUV = inUV;
+    outColor = inColor * instance.baseColor;
+    outTextureLayer = instance.textureLayer;
+    outAlphaCutoff = instance.alphaCutoff;
+}
\ No newline at end of file
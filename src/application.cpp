@@ -1,6 +1,7 @@
 #include "application.h"
 
 #include "scenes/cubes_one.h"
+#include "scenes/gltf_scene.h"
 #include "spdlog/spdlog.h"
 #include "vulkan_context_builder.h"
 #include "vulkan_engine.h"
@@ -11,6 +12,14 @@ namespace
 {
 constexpr int kWindowWidth = 1280;
 constexpr int kWindowHeight = 720;
+
+// Shaders are compiled from here at runtime, and reloaded when they change, when the directory exists. Only debug
+// builds define it.
+#ifdef STEEPLEJACK_SHADER_SOURCE_DIR
+constexpr const char* kShaderSourceDirectory = STEEPLEJACK_SHADER_SOURCE_DIR;
+#else
+constexpr const char* kShaderSourceDirectory = "";
+#endif
 }
 
 namespace steeplejack
@@ -18,7 +27,7 @@ namespace steeplejack
 
 Application::Application() = default;
 
-int Application::run()
+int Application::run(const std::string& model_path)
 {
 #ifdef NDEBUG
     const bool enableValidationLayers = false;
@@ -32,31 +41,36 @@ int Application::run()
     {
         using namespace steeplejack;
 
-        auto layout_builder = [](DescriptorSetLayoutBuilder& builder)
+        auto scene_factory = [&model_path](const Device& device) -> std::unique_ptr<RenderScene>
         {
-            builder
-                .add_uniform_buffer()          // camera
-                .add_uniform_buffer()          // model
-                .add_combined_image_sampler(); // texture
-        };
+            if (!model_path.empty())
+            {
+                return std::make_unique<GltfScene>(device, model_path);
+            }
 
-        auto scene_factory = [](const Device& device) { return std::make_unique<CubesOne>(device); };
+            return std::make_unique<CubesOne>(device);
+        };
 
         auto context = VulkanContextBuilder()
                            .add_window(kWindowWidth, kWindowHeight, "Steeplejack")
                            .add_device(enable_validation_layers)
+                           .add_asset_reader()
+                           .add_shader_compiler(kShaderSourceDirectory)
+                           .add_shader_modules()
+                           .add_pipeline_cache()
                            .add_graphics_queue()
-                           .add_adhoc_queues()
                            .add_graphics_buffers()
-                           .add_descriptor_set_layout(layout_builder)
-                           .add_sampler()
+                           .add_sampler_cache()
+                           .add_bindless_textures()
                            .add_texture_factory()
                            .add_scene(scene_factory)
+                           .add_descriptor_set_layout()
                            .add_swapchain()
                            .add_depth_buffer()
                            .add_render_pass()
-                           .add_framebuffers()
+                           .add_multisampler()
                            .add_graphics_pipeline()
+                           .add_pipeline_manager()
                            .add_gui()
                            .build();
 
@@ -9,7 +9,8 @@ class Application
 {
   public:
     Application();
-    static int run();
+    // Shows the glTF model at model_path, relative to the working directory, or the demo scene when it is empty.
+    static int run(const std::string& model_path);
 };
 
 } // namespace steeplejack
@@ -9,7 +9,10 @@
 
 using namespace steeplejack;
 
-Gui::Gui(const Window& window, const Device& device, const RenderPass& render_pass) :
+Gui::Gui(const Window& window,
+         const Device& device,
+         const PipelineCache& pipeline_cache,
+         const RenderPass& render_pass) :
     m_device(device), m_descriptor_pool(create_descriptor_pool()), m_framerate()
 {
     spdlog::info("Creating GUI");
@@ -30,10 +33,11 @@ Gui::Gui(const Window& window, const Device& device, const RenderPass& render_pa
     init_info.Device = device;
     init_info.QueueFamily = device.graphics_queue_index();
     init_info.Queue = device.graphics_queue();
-    init_info.RenderPass = render_pass;
+    init_info.UseDynamicRendering = true;
+    init_info.PipelineRenderingCreateInfo = render_pass.pipeline_rendering_info();
     init_info.DescriptorPool = m_descriptor_pool;
 
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = pipeline_cache;
     init_info.Allocator = nullptr;
 
     init_info.MinImageCount = Device::max_frames_in_flight;
@@ -2,6 +2,7 @@
 
 #include "framerate.h"
 #include "vulkan/device.h"
+#include "vulkan/pipeline_cache.h"
 #include "vulkan/render_pass.h"
 #include "vulkan/swapchain.h"
 #include "vulkan/window.h"
@@ -24,7 +25,7 @@ class Gui
     static void check_vk_result(VkResult result);
 
   public:
-    Gui(const Window& window, const Device& device, const RenderPass& render_pass);
+    Gui(const Window& window, const Device& device, const PipelineCache& pipeline_cache, const RenderPass& render_pass);
     ~Gui();
 
     void begin_frame();
@@ -1,7 +1,7 @@
 #include "application.h"
 
-int main()
+int main(int argc, char* argv[])
 {
     steeplejack::Application const app;
-    return steeplejack::Application::run();
+    return steeplejack::Application::run(argc > 1 ? argv[1] : "");
 }
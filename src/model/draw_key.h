@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace steeplejack
+{
+// 64-bit sort key for a draw packet. The top bit sends blended draws after all opaque ones. Below it, opaque keys hold
+// pipeline, raster state, texture, geometry and then depth, so that sorting groups draws by the most expensive state
+// first and orders equal-state draws front to back. Blended keys hold the depth first, inverted, so that they are drawn
+// back to front whatever their state, and then pipeline, raster state, texture and geometry.
+struct DrawKey
+{
+    static constexpr uint32_t kPipelineBits = 8;
+    static constexpr uint32_t kRasterBits = 5;
+    static constexpr uint32_t kTextureBits = 16;
+    static constexpr uint32_t kGeometryBits = 16;
+    static constexpr uint32_t kDepthBits = 18;
+
+    // Shifts of the state fields within the state bits, which start at bit 0 of blended keys and above the depth of
+    // opaque ones.
+    static constexpr uint32_t kGeometryShift = 0;
+    static constexpr uint32_t kTextureShift = kGeometryShift + kGeometryBits;
+    static constexpr uint32_t kRasterShift = kTextureShift + kTextureBits;
+    static constexpr uint32_t kPipelineShift = kRasterShift + kRasterBits;
+    static constexpr uint32_t kStateBits = kPipelineShift + kPipelineBits;
+    static constexpr uint32_t kBlendedShift = kStateBits + kDepthBits;
+    static_assert(kBlendedShift == 63, "DrawKey fields must fill the key below the blended bit");
+
+    static constexpr uint32_t kMaxPipelines = 1U << kPipelineBits;
+    static constexpr uint32_t kMaxRasterStates = 1U << kRasterBits;
+    static constexpr uint32_t kMaxTextures = 1U << kTextureBits;
+    static constexpr uint32_t kMaxGeometries = 1U << kGeometryBits;
+    static constexpr uint32_t kMaxDepth = (1U << kDepthBits) - 1;
+
+    static constexpr uint64_t kBlendedBit = uint64_t{1} << kBlendedShift;
+    static constexpr uint64_t kStateMask = (uint64_t{1} << kStateBits) - 1;
+
+    // depth is normalized view distance; values outside [0, 1] are clamped. Ids must fit their fields: masking them
+    // would silently give unrelated draws the same state.
+    static constexpr uint64_t
+    encode(uint32_t pipeline, uint32_t raster, uint32_t texture, uint32_t geometry, float depth, bool blended = false)
+    {
+        assert(pipeline < kMaxPipelines && raster < kMaxRasterStates && texture < kMaxTextures &&
+               geometry < kMaxGeometries);
+
+        const auto quantized_depth = static_cast<uint32_t>(std::clamp(depth, 0.0F, 1.0F) * kMaxDepth);
+        const uint64_t state = (static_cast<uint64_t>(pipeline & (kMaxPipelines - 1)) << kPipelineShift) |
+            (static_cast<uint64_t>(raster & (kMaxRasterStates - 1)) << kRasterShift) |
+            (static_cast<uint64_t>(texture & (kMaxTextures - 1)) << kTextureShift) |
+            (static_cast<uint64_t>(geometry & (kMaxGeometries - 1)) << kGeometryShift);
+
+        if (blended)
+        {
+            return kBlendedBit | (static_cast<uint64_t>(kMaxDepth - quantized_depth) << kStateBits) | state;
+        }
+
+        return (state << kDepthBits) | quantized_depth;
+    }
+
+    static constexpr bool blended(uint64_t key)
+    {
+        return (key & kBlendedBit) != 0;
+    }
+
+    // Draws next to each other in sorted order whose keys share the state can be merged into one instanced draw; for
+    // blended draws this keeps their order, as instances are drawn in order. The state is the key with its depth
+    // cleared, so the accessors below read the same fields from it as from the key.
+    static constexpr uint64_t state(uint64_t key)
+    {
+        return blended(key) ? key & (kBlendedBit | kStateMask) : key & (kStateMask << kDepthBits);
+    }
+
+    // The state fields of a key or state, shifted down to bit 0.
+    static constexpr uint64_t state_fields(uint64_t key)
+    {
+        return blended(key) ? key & kStateMask : (key >> kDepthBits) & kStateMask;
+    }
+
+    static constexpr uint32_t pipeline(uint64_t key)
+    {
+        return static_cast<uint32_t>(state_fields(key) >> kPipelineShift) & (kMaxPipelines - 1);
+    }
+
+    static constexpr uint32_t raster(uint64_t key)
+    {
+        return static_cast<uint32_t>(state_fields(key) >> kRasterShift) & (kMaxRasterStates - 1);
+    }
+
+    static constexpr uint32_t texture(uint64_t key)
+    {
+        return static_cast<uint32_t>(state_fields(key) >> kTextureShift) & (kMaxTextures - 1);
+    }
+
+    static constexpr uint32_t geometry(uint64_t key)
+    {
+        return static_cast<uint32_t>(state_fields(key) >> kGeometryShift) & (kMaxGeometries - 1);
+    }
+};
+} // namespace steeplejack
@@ -0,0 +1,646 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include "gltf_loader.h"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+using namespace steeplejack;
+
+namespace
+{
+const GltfLoader::Bounds kEmptyBounds = {
+    .min = glm::vec3(std::numeric_limits<float>::max()),
+    .max = glm::vec3(std::numeric_limits<float>::lowest()),
+};
+
+Material::AlphaMode alpha_mode(Gltf::AlphaMode mode)
+{
+    switch (mode)
+    {
+    case Gltf::AlphaMode::kMask:
+        return Material::AlphaMode::kMask;
+    case Gltf::AlphaMode::kBlend:
+        return Material::AlphaMode::kBlend;
+    default:
+        return Material::AlphaMode::kOpaque;
+    }
+}
+
+VkSamplerAddressMode address_mode(uint32_t wrap)
+{
+    switch (wrap)
+    {
+    case Gltf::kWrapClampToEdge:
+        return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    case Gltf::kWrapMirroredRepeat:
+        return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+    default:
+        return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    }
+}
+
+// Unset filters keep the trilinear default. SamplerState has one address mode for every axis, taken from wrapS; a
+// minification filter without mipmaps samples level 0 only.
+SamplerState sampler_state(const Gltf& gltf, const Gltf::Texture& texture)
+{
+    SamplerState result;
+    if (!texture.sampler)
+    {
+        return result;
+    }
+
+    const auto& sampler = gltf.samplers[*texture.sampler];
+    if (sampler.mag_filter == Gltf::kFilterNearest)
+    {
+        result.filter = VK_FILTER_NEAREST;
+    }
+
+    if (sampler.min_filter == Gltf::kFilterNearestMipmapNearest ||
+        sampler.min_filter == Gltf::kFilterLinearMipmapNearest)
+    {
+        result.mipmap_mode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    }
+    else if (sampler.min_filter == Gltf::kFilterNearest || sampler.min_filter == Gltf::kFilterLinear)
+    {
+        result.max_lod = 0.0F;
+    }
+
+    result.address_mode = address_mode(sampler.wrap_s);
+    return result;
+}
+
+// Runs job for every index below count on up to max_workers threads and rethrows the first exception it throws.
+template <typename TJob> void parallel_for(size_t count, size_t max_workers, TJob job)
+{
+    const size_t threads = std::max(std::thread::hardware_concurrency(), 1U);
+    const size_t worker_count = std::min({count, threads, max_workers});
+
+    std::atomic<size_t> next = 0;
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < worker_count; i++)
+        {
+            workers.emplace_back(
+                [&]
+                {
+                    for (size_t index = next++; index < count; index = next++)
+                    {
+                        try
+                        {
+                            job(index);
+                        }
+                        catch (...)
+                        {
+                            const std::scoped_lock lock(mutex);
+                            if (!error)
+                            {
+                                error = std::current_exception();
+                            }
+                        }
+                    }
+                });
+        }
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+} // namespace
+
+GltfLoader::GltfLoader(const AssetReader& assets, TextureFactory& texture_factory) :
+    m_assets(assets), m_texture_factory(texture_factory)
+{
+}
+
+GltfLoader::Bounds GltfLoader::load(const std::string& path,
+                                    Model& model,
+                                    Node& parent,
+                                    GraphicsBuffers& graphics_buffers,
+                                    UploadBatch& upload_batch)
+{
+    spdlog::info("Loading glTF: {}", path);
+
+    const auto file = m_assets.read(path);
+    const auto gltf = Gltf::parse(file.view());
+    const auto directory = std::filesystem::path(path).parent_path();
+
+    const auto buffer_assets = read_buffers(gltf, directory);
+    std::vector<std::span<const std::byte>> buffers;
+    for (const auto& buffer : buffer_assets)
+    {
+        buffers.push_back(buffer.view());
+    }
+
+    auto ranges = plan_ranges(gltf, create_materials(gltf, load_textures(gltf, directory), model));
+    if (ranges.empty())
+    {
+        throw std::runtime_error("Failed to load glTF: " + path + " has no triangle meshes");
+    }
+
+    std::vector<Vertex> vertexes(ranges.back().first_vertex + ranges.back().vertex_count);
+    std::vector<Vertex::index_t> indexes(ranges.back().first_index + ranges.back().index_count);
+
+    parallel_for(ranges.size(), kMaxWorkers, [&](size_t i) { decode(gltf, buffers, ranges[i], vertexes, indexes); });
+    const auto full_detail_indexes = indexes.size();
+    append_lods(ranges, indexes);
+
+    graphics_buffers.load_vertexes(upload_batch, vertexes);
+    graphics_buffers.load_indexes(upload_batch, indexes);
+
+    spdlog::info("Loaded glTF: {} primitives, {} vertexes, {} indexes and {} more for levels of detail",
+                 ranges.size(),
+                 vertexes.size(),
+                 full_detail_indexes,
+                 indexes.size() - full_detail_indexes);
+
+    const auto meshes = group_meshes(gltf, ranges);
+
+    Bounds bounds = kEmptyBounds;
+    std::vector<bool> visited(gltf.nodes.size());
+    for (auto root : gltf.root_nodes)
+    {
+        add_node(gltf, root, meshes, parent, glm::mat4(1.0F), visited, bounds);
+    }
+
+    return bounds;
+}
+
+// Buffers without a uri are the binary chunk of a .glb, which stays a view into the file the caller holds.
+std::vector<Asset> GltfLoader::read_buffers(const Gltf& gltf, const std::filesystem::path& directory) const
+{
+    std::vector<Asset> result;
+    for (const auto& buffer : gltf.buffers)
+    {
+        if (buffer.uri.starts_with("data:"))
+        {
+            throw std::runtime_error("Failed to load glTF: embedded buffers are not supported");
+        }
+
+        const auto& asset = result.emplace_back(
+            buffer.uri.empty() ? Asset(gltf.binary_chunk)
+                               : m_assets.read((directory / buffer.uri).lexically_normal().generic_string()));
+        if (asset.size() < buffer.byte_length)
+        {
+            throw std::runtime_error("Failed to load glTF: buffer " + buffer.uri + " is truncated");
+        }
+    }
+
+    return result;
+}
+
+// Returns the base color texture of every material. Each image is loaded once, named after its path so that models
+// sharing a file share the texture, and samples as the glTF sampler of the first texture using it says. The images
+// with the same sampler are loaded together so that small ones of the same format and size are packed into texture
+// arrays; the others are streamed.
+std::vector<Texture*> GltfLoader::load_textures(const Gltf& gltf, const std::filesystem::path& directory) const
+{
+    static constexpr size_t kNotLoaded = SIZE_MAX;
+
+    std::vector<size_t> image_textures(gltf.images.size(), kNotLoaded);
+    std::vector<std::pair<std::string, std::string>> names;
+    std::vector<SamplerState> samplers;
+    std::vector<size_t> material_textures;
+
+    for (const auto& material : gltf.materials)
+    {
+        const auto* texture = material.base_color_texture ? &gltf.textures[*material.base_color_texture] : nullptr;
+        const auto source = texture != nullptr ? texture->source : std::nullopt;
+        if (!source)
+        {
+            material_textures.push_back(kNotLoaded);
+            continue;
+        }
+
+        const auto& image = gltf.images[*source];
+        if (image.uri.empty() || image.uri.starts_with("data:"))
+        {
+            spdlog::warn("Skipping glTF image {}: embedded images are not supported", *source);
+            material_textures.push_back(kNotLoaded);
+            continue;
+        }
+
+        if (image_textures[*source] == kNotLoaded)
+        {
+            const auto image_path = (directory / image.uri).lexically_normal();
+            image_textures[*source] = names.size();
+            names.emplace_back(image_path.generic_string(),
+                               image_path.lexically_relative("assets/textures").generic_string());
+            samplers.push_back(sampler_state(gltf, *texture));
+        }
+
+        material_textures.push_back(image_textures[*source]);
+    }
+
+    std::vector<Texture*> textures(names.size());
+    std::vector<bool> loaded(names.size());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (loaded[i])
+        {
+            continue;
+        }
+
+        std::vector<size_t> group;
+        std::vector<std::pair<std::string, std::string>> group_names;
+        for (size_t j = i; j < names.size(); j++)
+        {
+            if (!loaded[j] && samplers[j] == samplers[i])
+            {
+                loaded[j] = true;
+                group.push_back(j);
+                group_names.push_back(names[j]);
+            }
+        }
+
+        const auto group_textures = m_texture_factory.load_textures(group_names, samplers[i]);
+        for (size_t j = 0; j < group.size(); j++)
+        {
+            textures[group[j]] = group_textures[j];
+        }
+    }
+
+    std::vector<Texture*> result;
+    for (const auto index : material_textures)
+    {
+        result.push_back(index != kNotLoaded ? textures[index] : nullptr);
+    }
+
+    return result;
+}
+
+std::vector<const Material*>
+GltfLoader::create_materials(const Gltf& gltf, const std::vector<Texture*>& textures, Model& model)
+{
+    std::vector<const Material*> result;
+    for (size_t i = 0; i < gltf.materials.size(); i++)
+    {
+        const auto& material = gltf.materials[i];
+        result.push_back(&model.add_material(
+            std::make_unique<Material>(alpha_mode(material.alpha_mode),
+                                       textures[i],
+                                       glm::make_vec4(material.base_color_factor.data()),
+                                       material.alpha_cutoff,
+                                       material.double_sided)));
+    }
+
+    return result;
+}
+
+// Primitives without a material are drawn with the scene's own pipeline, which matches glTF's default material.
+std::vector<GltfLoader::Range> GltfLoader::plan_ranges(const Gltf& gltf, const std::vector<const Material*>& materials)
+{
+    std::vector<Range> result;
+    uint64_t vertex_count = 0;
+    uint64_t index_count = 0;
+
+    for (uint32_t m = 0; m < gltf.meshes.size(); m++)
+    {
+        const auto& mesh = gltf.meshes[m];
+        for (uint32_t p = 0; p < mesh.primitives.size(); p++)
+        {
+            const auto& primitive = mesh.primitives[p];
+            if (primitive.mode != Gltf::kModeTriangles || !primitive.position)
+            {
+                spdlog::warn(
+                    "Skipping glTF primitive {} of mesh {}: only triangles with positions are supported", p, m);
+                continue;
+            }
+
+            const auto primitive_vertexes = gltf.accessors[*primitive.position].count;
+            const auto primitive_indexes =
+                primitive.indices ? gltf.accessors[*primitive.indices].count : primitive_vertexes;
+
+            result.push_back({
+                .mesh = m,
+                .primitive = p,
+                .first_vertex = static_cast<uint32_t>(vertex_count),
+                .vertex_count = static_cast<uint32_t>(primitive_vertexes),
+                .first_index = static_cast<uint32_t>(index_count),
+                .index_count = static_cast<uint32_t>(primitive_indexes),
+                .material = primitive.material ? materials[*primitive.material] : nullptr,
+                .bounds = kEmptyBounds,
+                .radius = 0.0F,
+                .lods = {},
+                .lod_primitives = {},
+            });
+
+            vertex_count += primitive_vertexes;
+            index_count += primitive_indexes;
+            constexpr uint64_t kMaxCount = std::numeric_limits<uint32_t>::max();
+            if (vertex_count > kMaxCount || index_count > kMaxCount)
+            {
+                throw std::runtime_error("Failed to load glTF: too many vertexes for 32-bit indexes");
+            }
+        }
+    }
+
+    return result;
+}
+
+// Writes the vertexes and indexes of range into its slices of the shared arrays; ranges never overlap, so ranges can
+// be decoded concurrently. Indexes are rebased onto the range's first vertex. The coarser levels are kept in range
+// until append_lods places them.
+void GltfLoader::decode(const Gltf& gltf,
+                        std::span<const std::span<const std::byte>> buffers,
+                        Range& range,
+                        std::span<Vertex> vertexes,
+                        std::span<Vertex::index_t> indexes)
+{
+    const auto& primitive = gltf.meshes[range.mesh].primitives[range.primitive];
+
+    const auto positions = gltf.view(*primitive.position, buffers);
+    if (positions.components != 3 || positions.component_type != Gltf::ComponentType::kFloat)
+    {
+        throw std::runtime_error("Failed to load glTF: positions must be float VEC3");
+    }
+
+    std::optional<Gltf::AccessorView> texcoords;
+    if (primitive.texcoord)
+    {
+        texcoords = gltf.view(*primitive.texcoord, buffers);
+        if (texcoords->components != 2 || texcoords->count < positions.count)
+        {
+            throw std::runtime_error("Failed to load glTF: texture coordinates must be VEC2, one per vertex");
+        }
+    }
+
+    std::optional<Gltf::AccessorView> colors;
+    if (primitive.color)
+    {
+        colors = gltf.view(*primitive.color, buffers);
+        if (colors->components < 3 || colors->components > 4 || colors->count < positions.count)
+        {
+            throw std::runtime_error("Failed to load glTF: colors must be VEC3 or VEC4, one per vertex");
+        }
+    }
+
+    std::vector<MeshSimplifier::Position> lod_positions(range.vertex_count);
+    std::vector<uint32_t> lod_indexes(range.index_count);
+
+    auto out_vertexes = vertexes.subspan(range.first_vertex, range.vertex_count);
+    for (uint32_t i = 0; i < range.vertex_count; i++)
+    {
+        auto& vertex = out_vertexes[i];
+
+        vertex.pos = {positions.read_float(i, 0), positions.read_float(i, 1), positions.read_float(i, 2)};
+        vertex.uv = texcoords ? glm::vec2(texcoords->read_float(i, 0), texcoords->read_float(i, 1)) : glm::vec2(0.0F);
+        vertex.color = glm::vec4(1.0F);
+        if (colors)
+        {
+            vertex.color = glm::vec4(colors->read_float(i, 0),
+                                     colors->read_float(i, 1),
+                                     colors->read_float(i, 2),
+                                     colors->components == 4 ? colors->read_float(i, 3) : 1.0F);
+        }
+
+        range.bounds.min = glm::min(range.bounds.min, vertex.pos);
+        range.bounds.max = glm::max(range.bounds.max, vertex.pos);
+        range.radius = std::max(range.radius, glm::length(vertex.pos));
+        lod_positions[i] = {vertex.pos.x, vertex.pos.y, vertex.pos.z};
+    }
+
+    if (primitive.indices)
+    {
+        const auto source = gltf.view(*primitive.indices, buffers);
+        if (source.components != 1)
+        {
+            throw std::runtime_error("Failed to load glTF: indices must be SCALAR");
+        }
+
+        for (uint32_t i = 0; i < range.index_count; i++)
+        {
+            lod_indexes[i] = source.read_index(i);
+            if (lod_indexes[i] >= range.vertex_count)
+            {
+                throw std::runtime_error("Failed to load glTF: index out of range");
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < range.index_count; i++)
+        {
+            lod_indexes[i] = i;
+        }
+    }
+
+    auto out_indexes = indexes.subspan(range.first_index, range.index_count);
+    for (uint32_t i = 0; i < range.index_count; i++)
+    {
+        out_indexes[i] = range.first_vertex + lod_indexes[i];
+    }
+
+    range.lods = MeshSimplifier::build_lods(lod_positions, lod_indexes);
+    for (auto& lod : range.lods)
+    {
+        for (auto& index : lod.indexes)
+        {
+            index += range.first_vertex;
+        }
+    }
+}
+
+// Appends the coarser levels of every range after the full detail indexes, in range order.
+void GltfLoader::append_lods(std::vector<Range>& ranges, std::vector<Vertex::index_t>& indexes)
+{
+    for (auto& range : ranges)
+    {
+        for (auto& lod : range.lods)
+        {
+            if (indexes.size() + lod.indexes.size() > std::numeric_limits<uint32_t>::max())
+            {
+                throw std::runtime_error("Failed to load glTF: too many indexes for levels of detail");
+            }
+
+            range.lod_primitives.emplace_back(static_cast<uint32_t>(indexes.size()),
+                                              static_cast<uint32_t>(lod.indexes.size()));
+            indexes.insert(indexes.end(), lod.indexes.begin(), lod.indexes.end());
+            lod.indexes = {};
+        }
+    }
+}
+
+std::vector<std::vector<GltfLoader::MeshGroup>> GltfLoader::group_meshes(const Gltf& gltf,
+                                                                         const std::vector<Range>& ranges)
+{
+    std::vector<std::vector<MeshGroup>> result(gltf.meshes.size());
+    std::vector<std::vector<std::vector<const Range*>>> group_ranges(gltf.meshes.size());
+
+    for (const auto& range : ranges)
+    {
+        auto& groups = result[range.mesh];
+        auto group = std::ranges::find(groups, range.material, &MeshGroup::material);
+        if (group == groups.end())
+        {
+            groups.push_back({
+                .material = range.material,
+                .primitives = {},
+                .lods = {},
+                .lod_errors = {},
+                .bounds = kEmptyBounds,
+                .radius = 0.0F,
+            });
+            group_ranges[range.mesh].emplace_back();
+            group = std::prev(groups.end());
+        }
+
+        group_ranges[range.mesh][group - groups.begin()].push_back(&range);
+        group->primitives.emplace_back(range.first_index, range.index_count);
+        group->bounds.min = glm::min(group->bounds.min, range.bounds.min);
+        group->bounds.max = glm::max(group->bounds.max, range.bounds.max);
+        group->radius = std::max(group->radius, range.radius);
+    }
+
+    for (size_t mesh = 0; mesh < result.size(); mesh++)
+    {
+        for (size_t i = 0; i < result[mesh].size(); i++)
+        {
+            add_group_lods(result[mesh][i], group_ranges[mesh][i]);
+        }
+    }
+
+    return result;
+}
+
+void GltfLoader::add_group_lods(MeshGroup& group, const std::vector<const Range*>& ranges)
+{
+    size_t levels = 0;
+    for (const auto* range : ranges)
+    {
+        levels = std::max(levels, range->lod_primitives.size());
+    }
+
+    for (size_t level = 0; level < levels; level++)
+    {
+        auto& primitives = group.lods.emplace_back();
+        float error = 0.0F;
+        for (const auto* range : ranges)
+        {
+            if (range->lod_primitives.empty())
+            {
+                primitives.emplace_back(range->first_index, range->index_count);
+                continue;
+            }
+
+            const auto range_level = std::min(level, range->lod_primitives.size() - 1);
+            primitives.push_back(range->lod_primitives[range_level]);
+            error = std::max(error, range->lods[range_level].error);
+        }
+
+        group.lod_errors.push_back(error);
+    }
+}
+
+// The node takes the first group of its mesh; any further groups hang below it untransformed. Every Mesh made from
+// one glTF mesh has the same primitives, so nodes sharing a mesh are drawn instanced.
+void GltfLoader::add_node(const Gltf& gltf,
+                          uint32_t index,
+                          const std::vector<std::vector<MeshGroup>>& meshes,
+                          Node& parent,
+                          const glm::mat4& parent_matrix,
+                          std::vector<bool>& visited,
+                          Bounds& bounds)
+{
+    if (visited[index])
+    {
+        throw std::runtime_error("Failed to load glTF: node " + std::to_string(index) + " has more than one parent");
+    }
+    visited[index] = true;
+
+    const auto& gltf_node = gltf.nodes[index];
+    const auto* groups = gltf_node.mesh ? &meshes[*gltf_node.mesh] : nullptr;
+    const bool has_mesh = groups != nullptr && !groups->empty();
+
+    auto& node = parent.add_child(has_mesh ? create_mesh(groups->front()) : nullptr);
+    set_transform(gltf_node, node);
+
+    const auto matrix = parent_matrix * node.local_matrix();
+
+    if (has_mesh)
+    {
+        for (size_t i = 0; i < groups->size(); i++)
+        {
+            if (i > 0)
+            {
+                node.add_child(create_mesh((*groups)[i]));
+            }
+
+            extend(bounds, (*groups)[i].bounds, matrix);
+        }
+    }
+
+    for (auto child : gltf_node.children)
+    {
+        add_node(gltf, child, meshes, node, matrix, visited, bounds);
+    }
+}
+
+std::unique_ptr<Mesh> GltfLoader::create_mesh(const MeshGroup& group)
+{
+    auto mesh = std::make_unique<Mesh>(group.primitives, group.material);
+    mesh->radius() = group.radius;
+    for (size_t level = 0; level < group.lods.size(); level++)
+    {
+        mesh->add_lod(group.lods[level], group.lod_errors[level]);
+    }
+
+    return mesh;
+}
+
+void GltfLoader::set_transform(const Gltf::Node& gltf_node, Node& node)
+{
+    if (gltf_node.matrix)
+    {
+        glm::vec3 skew;
+        glm::vec4 perspective;
+        glm::decompose(glm::make_mat4(gltf_node.matrix->data()),
+                       node.scale(),
+                       node.rotation(),
+                       node.translation(),
+                       skew,
+                       perspective);
+        return;
+    }
+
+    const auto& [x, y, z, w] = gltf_node.rotation;
+    node.translation() = glm::make_vec3(gltf_node.translation.data());
+    node.rotation() = glm::quat(w, x, y, z);
+    node.scale() = glm::make_vec3(gltf_node.scale.data());
+}
+
+void GltfLoader::extend(Bounds& bounds, const Bounds& other, const glm::mat4& matrix)
+{
+    for (uint32_t corner = 0; corner < 8; corner++)
+    {
+        const glm::vec3 point = {
+            (corner & 1U) != 0 ? other.max.x : other.min.x,
+            (corner & 2U) != 0 ? other.max.y : other.min.y,
+            (corner & 4U) != 0 ? other.max.z : other.min.z,
+        };
+
+        const auto transformed = glm::vec3(matrix * glm::vec4(point, 1.0F));
+        bounds.min = glm::min(bounds.min, transformed);
+        bounds.max = glm::max(bounds.max, transformed);
+    }
+}
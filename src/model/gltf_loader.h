@@ -0,0 +1,119 @@
+#pragma once
+
+#include "material.h"
+#include "mesh.h"
+#include "model.h"
+#include "node.h"
+#include "util/asset_reader.h"
+#include "util/gltf.h"
+#include "util/mesh_simplifier.h"
+#include "util/no_copy_or_move.h"
+#include "vulkan/graphics_buffers.h"
+#include "vulkan/texture.h"
+#include "vulkan/texture_factory.h"
+#include "vulkan/upload_batch.h"
+#include "vulkan/vertex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace steeplejack
+{
+// Builds a node hierarchy from a glTF 2.0 asset, either a .gltf document with its buffers or a .glb. Triangle
+// primitives become Primitive ranges of one vertex and one index buffer, each glTF material becomes a Material, and
+// the base color textures of the materials are loaded through the texture factory, packed into arrays when small and
+// streamed in otherwise. Accessors are decoded on several threads straight from the buffers as the asset reader
+// returns them, which for a packed model means straight from the mapped pack. Coarser levels of detail are generated
+// for every primitive as it is decoded; they reuse its vertexes and only add indexes.
+class GltfLoader : NoCopyOrMove
+{
+  public:
+    struct Bounds
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+  private:
+    static constexpr size_t kMaxWorkers = 8;
+
+    // Where one glTF primitive lands in the vertex and index buffers, and what decoding found out about it.
+    struct Range
+    {
+        uint32_t mesh;
+        uint32_t primitive;
+        uint32_t first_vertex;
+        uint32_t vertex_count;
+        uint32_t first_index;
+        uint32_t index_count;
+        const Material* material;
+        Bounds bounds;
+        float radius;
+        // Coarser levels, with indexes already rebased, and where load put them in the index buffer.
+        std::vector<MeshSimplifier::Level> lods;
+        std::vector<Primitive> lod_primitives;
+    };
+
+    // Primitives of one glTF mesh that share a material, which are drawn as one Mesh. Level n of the group draws level
+    // n of each primitive, or its coarsest level when it has fewer, and its error is the largest of theirs.
+    struct MeshGroup
+    {
+        const Material* material;
+        std::vector<Primitive> primitives;
+        std::vector<std::vector<Primitive>> lods;
+        std::vector<float> lod_errors;
+        Bounds bounds;
+        float radius;
+    };
+
+    const AssetReader& m_assets;
+    TextureFactory& m_texture_factory;
+
+    std::vector<Asset> read_buffers(const Gltf& gltf, const std::filesystem::path& directory) const;
+    std::vector<Texture*> load_textures(const Gltf& gltf, const std::filesystem::path& directory) const;
+
+    static std::vector<const Material*>
+    create_materials(const Gltf& gltf, const std::vector<Texture*>& textures, Model& model);
+    static std::vector<Range> plan_ranges(const Gltf& gltf, const std::vector<const Material*>& materials);
+
+    static void decode(const Gltf& gltf,
+                       std::span<const std::span<const std::byte>> buffers,
+                       Range& range,
+                       std::span<Vertex> vertexes,
+                       std::span<Vertex::index_t> indexes);
+
+    static void append_lods(std::vector<Range>& ranges, std::vector<Vertex::index_t>& indexes);
+    static std::vector<std::vector<MeshGroup>> group_meshes(const Gltf& gltf, const std::vector<Range>& ranges);
+    static void add_group_lods(MeshGroup& group, const std::vector<const Range*>& ranges);
+
+    static void add_node(const Gltf& gltf,
+                         uint32_t index,
+                         const std::vector<std::vector<MeshGroup>>& meshes,
+                         Node& parent,
+                         const glm::mat4& parent_matrix,
+                         std::vector<bool>& visited,
+                         Bounds& bounds);
+
+    static std::unique_ptr<Mesh> create_mesh(const MeshGroup& group);
+    static void set_transform(const Gltf::Node& gltf_node, Node& node);
+    static void extend(Bounds& bounds, const Bounds& other, const glm::mat4& matrix);
+
+  public:
+    GltfLoader(const AssetReader& assets, TextureFactory& texture_factory);
+
+    // Adds the nodes of the default scene of path under parent, a node of model, and the materials they are drawn with
+    // to model, and replaces the contents of graphics_buffers, which are recorded into upload_batch. Returns the bounds
+    // of the meshes in the space of parent.
+    Bounds load(const std::string& path,
+                Model& model,
+                Node& parent,
+                GraphicsBuffers& graphics_buffers,
+                UploadBatch& upload_batch);
+};
+} // namespace steeplejack
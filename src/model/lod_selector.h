@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+namespace steeplejack
+{
+// Chooses a level of detail from the geometric error of each level projected onto the screen. Errors are measured in
+// fractions of the viewport height, so the choice does not depend on the window size.
+class LodSelector
+{
+  public:
+    // Roughly one pixel at 1080p.
+    static constexpr float kDefaultMaxScreenError = 1.0F / 1080.0F;
+    // A coarser level is only taken once it is this much below the threshold, so objects sitting at the boundary do
+    // not flip between levels every frame.
+    static constexpr float kDefaultHysteresis = 0.25F;
+
+  private:
+    float m_error_scale;
+    float m_max_screen_error;
+    float m_hysteresis;
+
+  public:
+    LodSelector(float fov_degrees,
+                float max_screen_error = kDefaultMaxScreenError,
+                float hysteresis = kDefaultHysteresis) :
+        m_error_scale(1.0F / (2.0F * std::tan(fov_degrees * std::numbers::pi_v<float> / 360.0F))),
+        m_max_screen_error(max_screen_error),
+        m_hysteresis(hysteresis)
+    {
+    }
+
+    float screen_error(float error, float distance) const
+    {
+        return error * m_error_scale / distance;
+    }
+
+    // Projected size in units of the maximum screen error, which with the default is a pixel at 1080p.
+    float screen_pixels(float size, float distance) const
+    {
+        return screen_error(size, distance) / m_max_screen_error;
+    }
+
+    // errors holds the geometric error of each level, finest first and increasing. Returns the coarsest level whose
+    // projected error is acceptable.
+    uint32_t select(const std::vector<float>& errors, float distance, uint32_t current) const
+    {
+        uint32_t selected = 0;
+        for (uint32_t level = 1; level < errors.size(); level++)
+        {
+            const float threshold = level > current ? m_max_screen_error * (1.0F - m_hysteresis) : m_max_screen_error;
+            if (screen_error(errors[level], distance) > threshold)
+            {
+                break;
+            }
+
+            selected = level;
+        }
+
+        return selected;
+    }
+};
+} // namespace steeplejack
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "mesh_shader.h"
+#include "util/no_copy_or_move.h"
+#include "vulkan/pipeline_state.h"
+#include "vulkan/raster_state.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace steeplejack
+{
+class Texture;
+
+// How a mesh is drawn: a pipeline variant of the scene's shaders, picked by the alpha mode and sidedness, and the
+// parameters the shaders read per draw. Meshes share materials, and materials that make the same pipeline state share
+// the pipeline, so the render queue binds each pipeline once per frame. With dynamic raster state, sidedness and depth
+// writes no longer pick the pipeline: the render queue sets them per draw from raster_state.
+class Material : NoCopyOrMove
+{
+  public:
+    // As glTF's alphaMode: written over what is behind, discarded below the alpha cutoff, or blended with what is
+    // behind. Blended materials are drawn after the others, back to front, and do not write depth.
+    enum class AlphaMode
+    {
+        kOpaque,
+        kMask,
+        kBlend,
+    };
+
+  private:
+    AlphaMode m_alpha_mode;
+    Texture* m_texture;
+    glm::vec4 m_base_color;
+    float m_alpha_cutoff;
+    bool m_double_sided;
+
+    // PipelineManager handle; 0 until request_pipeline, when the scene's own pipeline would be used.
+    uint32_t m_pipeline = 0;
+
+  public:
+    Material(AlphaMode alpha_mode,
+             Texture* texture = nullptr,
+             const glm::vec4& base_color = glm::vec4(1.0F),
+             float alpha_cutoff = 0.5F,
+             bool double_sided = false) :
+        m_alpha_mode(alpha_mode),
+        m_texture(texture),
+        m_base_color(base_color),
+        m_alpha_cutoff(alpha_cutoff),
+        m_double_sided(double_sided)
+    {
+    }
+
+    AlphaMode alpha_mode() const
+    {
+        return m_alpha_mode;
+    }
+
+    bool blended() const
+    {
+        return m_alpha_mode == AlphaMode::kBlend;
+    }
+
+    Texture* texture() const
+    {
+        return m_texture;
+    }
+
+    // Multiplies the vertex color.
+    const glm::vec4& base_color() const
+    {
+        return m_base_color;
+    }
+
+    float alpha_cutoff() const
+    {
+        return m_alpha_cutoff;
+    }
+
+    bool double_sided() const
+    {
+        return m_double_sided;
+    }
+
+    uint32_t pipeline() const
+    {
+        return m_pipeline;
+    }
+
+    // Baked into the pipeline state, or set by the render queue when the pipelines leave it dynamic.
+    RasterState raster_state() const
+    {
+        RasterState result;
+        if (m_double_sided)
+        {
+            result.cull_mode = VK_CULL_MODE_NONE;
+        }
+
+        if (blended())
+        {
+            result.depth_write = false;
+        }
+
+        return result;
+    }
+
+    // The variant of base, the scene's pipeline state, that draws this material.
+    PipelineState pipeline_state(PipelineState base) const
+    {
+        base.specialization.set(MeshShader::kTextured, m_texture != nullptr)
+            .set(MeshShader::kAlphaTest, m_alpha_mode == AlphaMode::kMask);
+        base.raster = raster_state();
+        base.blend = blended();
+
+        return base;
+    }
+
+    // TPipelines is a PipelineManager, or anything else handing out handles from request.
+    template <typename TPipelines> void request_pipeline(TPipelines& pipelines, const PipelineState& base)
+    {
+        m_pipeline = pipelines.request(pipeline_state(base));
+    }
+
+    // Forgets the handle of a pipeline manager that has been destroyed, until request_pipeline is called again.
+    void reset_pipeline()
+    {
+        m_pipeline = 0;
+    }
+};
+
+// The materials of a model, which request their pipelines as they are added and again after reset_pipelines.
+class Materials : NoCopyOrMove
+{
+  private:
+    std::vector<std::unique_ptr<Material>> m_materials;
+    size_t m_requested = 0;
+
+  public:
+    Material& add(std::unique_ptr<Material> material)
+    {
+        return *m_materials.emplace_back(std::move(material));
+    }
+
+    // True when a material added since the previous request_pipelines, or any after reset_pipelines, has no
+    // pipeline yet.
+    bool pipelines_pending() const
+    {
+        return m_requested < m_materials.size();
+    }
+
+    // Requests the pipelines of the materials that have none, as variants of base.
+    template <typename TPipelines> void request_pipelines(TPipelines& pipelines, const PipelineState& base)
+    {
+        for (; m_requested < m_materials.size(); m_requested++)
+        {
+            m_materials[m_requested]->request_pipeline(pipelines, base);
+        }
+    }
+
+    // Called when the pipeline manager is replaced: every material draws with the scene's own pipeline until
+    // request_pipelines asks the new manager for its pipeline.
+    void reset_pipelines()
+    {
+        for (const auto& material : m_materials)
+        {
+            material->reset_pipeline();
+        }
+
+        m_requested = 0;
+    }
+};
+} // namespace steeplejack
@@ -1,70 +1,121 @@
 #pragma once
 
+#include "lod_selector.h"
+#include "material.h"
 #include "primitive.h"
 #include "util/no_copy_or_move.h"
-#include "vulkan/buffer/uniform_buffer.h"
-#include "vulkan/device.h"
-#include "vulkan/graphics_pipeline.h"
 #include "vulkan/texture.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <limits>
 #include <memory>
 #include <vector>
 
 namespace steeplejack
 {
+// A mesh carries one or more levels of detail, finest first. Only the selected level is drawn, with the mesh's
+// material, or with the scene's own pipeline and no texture when it has none.
 class Mesh : NoCopyOrMove
 {
   private:
-    struct UniformBlock
+    glm::mat4 m_model;
+    std::vector<std::vector<Primitive>> m_lods;
+    std::vector<float> m_lod_errors;
+    uint32_t m_lod = 0;
+    float m_radius = 0.0F;
+    const Material* m_material;
+
+  public:
+    Mesh(const std::vector<Primitive>& primitives, const Material* material = nullptr) :
+        m_model(1.0F), m_lods({primitives}), m_lod_errors({0.0F}), m_material(material)
     {
-        glm::mat4 model;
-    };
+    }
 
-    UniformBlock m_uniform_block;
-    UniformBuffer m_uniform_buffers;
-    std::vector<Primitive> m_primitives;
-    Texture* m_texture;
+    // Adds the next coarser level. error is its largest deviation from the full detail mesh in model units and must
+    // not be smaller than the error of the previous level.
+    void add_lod(const std::vector<Primitive>& primitives, float error)
+    {
+        m_lods.push_back(primitives);
+        m_lod_errors.push_back(error);
+    }
 
-  public:
-    Mesh(const Device& device, const std::vector<Primitive>& primitives, Texture* texture = nullptr) :
-        m_uniform_block{}, m_uniform_buffers(device, sizeof(UniformBlock)), m_primitives(primitives), m_texture(texture)
+    size_t lod_count() const
+    {
+        return m_lods.size();
+    }
+
+    uint32_t lod() const
+    {
+        return m_lod;
+    }
+
+    // Radius of a sphere around the model origin that bounds the mesh, in model units.
+    float radius() const
+    {
+        return m_radius;
+    }
+    float& radius()
     {
+        return m_radius;
     }
 
     const glm::mat4& model() const
     {
-        return m_uniform_block.model;
+        return m_model;
     }
     glm::mat4& model()
     {
-        return m_uniform_block.model;
+        return m_model;
+    }
+
+    const std::vector<Primitive>& primitives() const
+    {
+        return m_lods[m_lod];
     }
 
-    void set_texture(Texture* texture)
+    const Material* material() const
     {
-        m_texture = texture;
+        return m_material;
     }
 
-    void flush(uint32_t frame_index)
+    Texture* texture() const
     {
-        m_uniform_buffers[frame_index].copy_from(m_uniform_block);
+        return m_material != nullptr ? m_material->texture() : nullptr;
     }
 
-    void render(VkCommandBuffer command_buffer, uint32_t frame_index, GraphicsPipeline& pipeline)
+    // Picks the level to draw from the distance between eye and the bounding sphere, and tells the texture how large
+    // the mesh appears on screen. Must be called after the model matrix is up to date.
+    void select_lod(const LodSelector& selector, const glm::vec3& eye)
     {
-        pipeline.descriptor_set_layout().write_uniform_buffer(m_uniform_buffers[frame_index].descriptor(), 1);
+        const float scale = std::sqrt(std::max({glm::dot(m_model[0], m_model[0]),
+                                                glm::dot(m_model[1], m_model[1]),
+                                                glm::dot(m_model[2], m_model[2])}));
+        const float distance = glm::length(eye - glm::vec3(m_model[3])) - m_radius * scale;
 
-        if (m_texture)
+        // Without a bounding sphere the size on screen is unknown and the texture is asked for at full resolution.
+        if (auto* texture = this->texture(); texture != nullptr)
         {
-            pipeline.descriptor_set_layout().write_combined_image_sampler(m_texture->descriptor(), 2);
+            texture->request_screen_size(m_radius > 0.0F && distance > 0.0F
+                                               ? selector.screen_pixels(2.0F * m_radius * scale, distance)
+                                               : std::numeric_limits<float>::infinity());
         }
 
-        pipeline.push_descriptor_set(command_buffer);
+        if (m_lods.size() < 2)
+        {
+            return;
+        }
 
-        for (auto& primitive : m_primitives)
+        m_lod = distance > 0.0F ? selector.select(m_lod_errors, distance / scale, m_lod) : 0;
+    }
+
+    void draw(VkCommandBuffer command_buffer, uint32_t instance_count, uint32_t first_instance) const
+    {
+        for (const auto& primitive : primitives())
         {
-            primitive.render(command_buffer);
+            primitive.render(command_buffer, instance_count, first_instance);
         }
     }
 };
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace steeplejack
+{
+// shader.mesh.vert and shader.mesh.frag, which every scene draws with, and the ids of the specialization constants
+// that pick their features. Materials set them per pipeline variant; see Material::pipeline_state.
+struct MeshShader
+{
+    static constexpr const char* kVertex = "mesh.vert";
+    static constexpr const char* kFragment = "mesh.frag";
+
+    // bool, default true: samples the draw's texture, when it has one, and multiplies the vertex color by it.
+    static constexpr uint32_t kTextured = 0;
+    // bool, default false: discards fragments whose alpha is below the alpha cutoff of the draw's material.
+    static constexpr uint32_t kAlphaTest = 1;
+};
+} // namespace steeplejack
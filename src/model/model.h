@@ -1,8 +1,15 @@
 #pragma once
 
+#include "material.h"
 #include "node.h"
 #include "util/no_copy_or_move.h"
+#include "vulkan/pipeline_manager.h"
+#include "vulkan/pipeline_state.h"
 
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 namespace steeplejack
@@ -11,6 +18,7 @@ class Model : NoCopyOrMove
 {
   private:
     Node m_root_node;
+    Materials m_materials;
 
   public:
     const Node& root_node() const
@@ -22,14 +30,45 @@ class Model : NoCopyOrMove
         return m_root_node;
     }
 
-    void flush(uint32_t frame_index)
+    // The model owns the materials its meshes are drawn with.
+    Material& add_material(std::unique_ptr<Material> material)
     {
-        m_root_node.flush(frame_index);
+        return m_materials.add(std::move(material));
     }
 
-    void render(VkCommandBuffer command_buffer, uint32_t frame_index, GraphicsPipeline& pipeline)
+    // True when a material has no pipeline yet: one added since the previous request_pipelines, or any after
+    // reset_pipelines.
+    bool pipelines_pending() const
     {
-        m_root_node.render(command_buffer, frame_index, pipeline);
+        return m_materials.pipelines_pending();
+    }
+
+    // Requests the pipelines of the materials that have none, as variants of base.
+    void request_pipelines(PipelineManager& pipelines, const PipelineState& base)
+    {
+        m_materials.request_pipelines(pipelines, base);
+    }
+
+    // Drops the handles of a pipeline manager that has been replaced, so that the next request_pipelines asks the
+    // new one.
+    void reset_pipelines()
+    {
+        m_materials.reset_pipelines();
+    }
+
+    void flush()
+    {
+        m_root_node.flush();
+    }
+
+    void select_lods(const LodSelector& selector, const glm::vec3& eye)
+    {
+        m_root_node.select_lods(selector, eye);
+    }
+
+    void collect(RenderQueue& render_queue) const
+    {
+        m_root_node.collect(render_queue);
     }
 };
 } // namespace steeplejack
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "mesh.h"
+#include "render_queue.h"
 #include "util/no_copy_or_move.h"
 #include "vulkan/graphics_pipeline.h"
 
@@ -94,30 +95,42 @@ class Node : NoCopyOrMove
         return m_parent ? m_parent->global_matrix() * local_matrix() : local_matrix();
     }
 
-    void flush(uint32_t frame_index)
+    void flush()
     {
         if (m_mesh)
         {
             m_mesh->model() = global_matrix();
-            m_mesh->flush(frame_index);
         }
 
         for (auto& child : m_children)
         {
-            child->flush(frame_index);
+            child->flush();
         }
     }
 
-    void render(VkCommandBuffer command_buffer, uint32_t frame_index, GraphicsPipeline& pipeline)
+    void select_lods(const LodSelector& selector, const glm::vec3& eye)
     {
         if (m_mesh)
         {
-            m_mesh->render(command_buffer, frame_index, pipeline);
+            m_mesh->select_lod(selector, eye);
         }
 
         for (auto& child : m_children)
         {
-            child->render(command_buffer, frame_index, pipeline);
+            child->select_lods(selector, eye);
+        }
+    }
+
+    void collect(RenderQueue& render_queue) const
+    {
+        if (m_mesh)
+        {
+            render_queue.add(*m_mesh);
+        }
+
+        for (const auto& child : m_children)
+        {
+            child->collect(render_queue);
         }
     }
 };
@@ -23,9 +23,11 @@ class Primitive
         return m_index_count;
     }
 
-    void render(VkCommandBuffer command_buffer) const
+    bool operator==(const Primitive& other) const = default;
+
+    void render(VkCommandBuffer command_buffer, uint32_t instance_count = 1, uint32_t first_instance = 0) const
     {
-        vkCmdDrawIndexed(command_buffer, m_index_count, 1, m_index_offset, 0, 0);
+        vkCmdDrawIndexed(command_buffer, m_index_count, instance_count, m_index_offset, 0, first_instance);
     }
 };
 } // namespace steeplejack
\ No newline at end of file
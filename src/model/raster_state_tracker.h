@@ -0,0 +1,33 @@
+#pragma once
+
+#include "draw_key.h"
+
+#include <cstdint>
+
+namespace steeplejack
+{
+// Decides, run by run while RenderQueue records a frame, when dynamic raster state must be set: when a run's raster id
+// differs from the one set last, or always once ids overflowed, since draws sharing the last id may differ. Baked
+// raster state comes with the pipeline and is never set.
+class RasterStateTracker
+{
+    bool m_dynamic;
+    uint32_t m_raster = DrawKey::kMaxRasterStates;
+
+  public:
+    explicit RasterStateTracker(bool dynamic) : m_dynamic(dynamic) {}
+
+    // Whether the run with key must set its raster state before drawing; the tracker assumes it then does.
+    bool set(uint64_t key, bool ids_overflowed)
+    {
+        const auto raster = DrawKey::raster(key);
+        if (!m_dynamic || (raster == m_raster && !ids_overflowed))
+        {
+            return false;
+        }
+
+        m_raster = raster;
+        return true;
+    }
+};
+} // namespace steeplejack
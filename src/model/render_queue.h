@@ -0,0 +1,258 @@
+#pragma once
+
+#include "draw_key.h"
+#include "mesh.h"
+#include "raster_state_tracker.h"
+#include "util/hash.h"
+#include "util/memory.h"
+#include "util/no_copy_or_move.h"
+#include "util/radix_sort.h"
+#include "vulkan/bindless_textures.h"
+#include "vulkan/buffer/storage_buffer.h"
+#include "vulkan/device.h"
+#include "vulkan/graphics_pipeline.h"
+#include "vulkan/pipeline_manager.h"
+#include "vulkan/raster_state.h"
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// Sits between the scene graph and command recording. Meshes are emitted as draw packets carrying a 64-bit sort key,
+// radix-sorted each frame, and recorded in key order: runs of packets with the same state become one instanced draw.
+// Descriptors are pushed once per frame; what changes between draws travels in push constants, and the parameters of
+// each mesh's material travel with its instance data. Draws take the pipeline of their material: pipeline id 0 is the
+// scene's own pipeline, bound before render is called and used by meshes without a material; other ids are
+// PipelineManager handles, and draws whose pipeline is still being compiled are skipped. With dynamic raster state,
+// materials that differ only in sidedness or depth writes share a pipeline, and the raster state of each run of draws
+// is set when it differs from the previous run's.
+class RenderQueue : NoCopyOrMove
+{
+    static_assert(PipelineManager::kMaxPipelines < DrawKey::kMaxPipelines);
+
+  public:
+    // Matches the push_constant block of the shaders.
+    struct DrawConstants
+    {
+        uint32_t instance_offset;
+        uint32_t texture_index;
+    };
+
+  private:
+    static constexpr size_t kInitialInstanceCapacity = 256;
+
+    struct DrawPacket
+    {
+        uint64_t key;
+        const Mesh* mesh;
+    };
+
+    // Matches the Instance struct of the shaders under std430.
+    struct InstanceData
+    {
+        glm::mat4 model;
+        glm::vec4 base_color;
+        uint32_t texture_layer;
+        float alpha_cutoff;
+        uint32_t padding[2];
+    };
+
+    struct PrimitivesHash
+    {
+        size_t operator()(const std::vector<Primitive>& primitives) const
+        {
+            size_t hash = primitives.size();
+            for (const auto& primitive : primitives)
+            {
+                hash_combine(hash, (static_cast<uint64_t>(primitive.index_offset()) << 32U) | primitive.index_count());
+            }
+
+            return hash;
+        }
+    };
+
+    StorageBuffer m_instance_buffers;
+
+    glm::mat4 m_view{1.0F};
+    float m_depth_range = 1.0F;
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<DrawPacket> m_scratch;
+    std::vector<InstanceData> m_instances;
+
+    // Set when an id map ran out of ids this frame, so that draws sharing the last id no longer share their state.
+    bool m_ids_overflowed = false;
+
+    // Keyed by bindless slot rather than texture, so that layers of one texture array share an id and draw together.
+    std::unordered_map<RasterState, uint32_t, RasterStateHash> m_raster_ids;
+    std::unordered_map<uint32_t, uint32_t> m_texture_ids;
+    std::unordered_map<std::vector<Primitive>, uint32_t, PrimitivesHash> m_geometry_ids;
+
+    static uint32_t texture_index(const Mesh& mesh)
+    {
+        return mesh.texture() != nullptr ? mesh.texture()->bindless_index() : BindlessTextures::kNoTexture;
+    }
+
+    static RasterState raster_state(const Mesh& mesh)
+    {
+        return mesh.material() != nullptr ? mesh.material()->raster_state() : RasterState{};
+    }
+
+    // The last id of a field is kept for keys that arrive once the others are taken; draws given it are told apart by
+    // same_state when the queue is recorded.
+    template <typename TMap, typename TKey> uint32_t id_for(TMap& ids, const TKey& key, uint32_t max_ids)
+    {
+        if (const auto found = ids.find(key); found != ids.end())
+        {
+            return found->second;
+        }
+
+        if (ids.size() >= max_ids - 1)
+        {
+            m_ids_overflowed = true;
+            return max_ids - 1;
+        }
+
+        return ids.emplace(key, static_cast<uint32_t>(ids.size())).first->second;
+    }
+
+    // Whether two draws whose keys share the state really do, for when ids overflowed.
+    static bool same_state(const Mesh& a, const Mesh& b)
+    {
+        return texture_index(a) == texture_index(b) && raster_state(a) == raster_state(b) &&
+            a.primitives() == b.primitives();
+    }
+
+    // Ids are kept across frames so keys are stable, but they only need to be unique within a frame: forget them
+    // once half are taken, so that only a frame with more distinct states than a field holds runs out.
+    template <typename TMap> static void recycle_ids(TMap& ids, uint32_t max_ids)
+    {
+        if (ids.size() >= max_ids / 2)
+        {
+            ids.clear();
+        }
+    }
+
+  public:
+    RenderQueue(const Device& device) : m_instance_buffers(device, sizeof(InstanceData) * kInitialInstanceCapacity) {}
+
+    // view transforms meshes into view space; depth_range is the distance that maps to the far end of the depth key.
+    void begin(const glm::mat4& view, float depth_range)
+    {
+        m_view = view;
+        m_depth_range = depth_range;
+        m_packets.clear();
+        m_ids_overflowed = false;
+
+        recycle_ids(m_raster_ids, DrawKey::kMaxRasterStates);
+        recycle_ids(m_texture_ids, DrawKey::kMaxTextures);
+        recycle_ids(m_geometry_ids, DrawKey::kMaxGeometries);
+    }
+
+    void add(const Mesh& mesh)
+    {
+        const auto view_position = m_view * mesh.model()[3];
+        const float depth = -view_position.z / m_depth_range;
+
+        const auto* material = mesh.material();
+        const auto pipeline_id = material != nullptr ? material->pipeline() : 0;
+        const bool blended = material != nullptr && material->blended();
+        const auto raster_id = id_for(m_raster_ids, raster_state(mesh), DrawKey::kMaxRasterStates);
+        const auto texture_id = id_for(m_texture_ids, texture_index(mesh), DrawKey::kMaxTextures);
+        const auto geometry_id = id_for(m_geometry_ids, mesh.primitives(), DrawKey::kMaxGeometries);
+
+        m_packets.push_back(
+            {.key = DrawKey::encode(pipeline_id, raster_id, texture_id, geometry_id, depth, blended), .mesh = &mesh});
+    }
+
+    size_t packet_count() const
+    {
+        return m_packets.size();
+    }
+
+    void render(VkCommandBuffer command_buffer,
+                uint32_t frame_index,
+                GraphicsPipeline& pipeline,
+                const PipelineManager& pipelines)
+    {
+        if (m_packets.empty())
+        {
+            return;
+        }
+
+        radix_sort(m_packets, m_scratch, [](const DrawPacket& packet) { return packet.key; });
+
+        m_instances.clear();
+        for (const auto& packet : m_packets)
+        {
+            const auto* material = packet.mesh->material();
+            const auto* texture = packet.mesh->texture();
+            m_instances.push_back({
+                .model = packet.mesh->model(),
+                .base_color = material != nullptr ? material->base_color() : glm::vec4(1.0F),
+                .texture_layer = texture != nullptr ? texture->layer() : 0,
+                .alpha_cutoff = material != nullptr ? material->alpha_cutoff() : 0.0F,
+                .padding = {},
+            });
+        }
+
+        auto& instance_buffer = m_instance_buffers.reserve(frame_index, total_bytes(m_instances));
+        instance_buffer.copy_from(m_instances);
+
+        pipeline.descriptor_set_layout().write_storage_buffer(instance_buffer.descriptor(), 1);
+        pipeline.push_descriptor_set(command_buffer);
+
+        // Pipelines share the layout, so the descriptors and push constants stay valid across binds. They also share
+        // whether their raster state is dynamic, so raster state set once stays valid across binds too.
+        uint32_t bound_pipeline = 0;
+        RasterStateTracker raster_states(pipeline.dynamic_raster_state());
+
+        size_t first = 0;
+        while (first < m_packets.size())
+        {
+            const auto state = DrawKey::state(m_packets[first].key);
+
+            size_t last = first + 1;
+            while (last < m_packets.size() && DrawKey::state(m_packets[last].key) == state &&
+                   (!m_ids_overflowed || same_state(*m_packets[first].mesh, *m_packets[last].mesh)))
+            {
+                last++;
+            }
+
+            const auto pipeline_id = DrawKey::pipeline(m_packets[first].key);
+            if (pipeline_id != bound_pipeline)
+            {
+                VkPipeline next = pipeline_id == 0 ? static_cast<VkPipeline>(pipeline) : pipelines.get(pipeline_id);
+                if (next == VK_NULL_HANDLE)
+                {
+                    first = last;
+                    continue;
+                }
+
+                vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, next);
+                bound_pipeline = pipeline_id;
+            }
+
+            const auto& mesh = *m_packets[first].mesh;
+            if (raster_states.set(m_packets[first].key, m_ids_overflowed))
+            {
+                raster_state(mesh).set(command_buffer);
+            }
+
+            const DrawConstants constants = {
+                .instance_offset = static_cast<uint32_t>(first),
+                .texture_index = texture_index(mesh),
+            };
+
+            pipeline.push_constants(command_buffer, constants);
+            mesh.draw(command_buffer, static_cast<uint32_t>(last - first), 0);
+
+            first = last;
+        }
+    }
+};
+} // namespace steeplejack
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "camera.h"
+#include "lod_selector.h"
 #include "model.h"
+#include "render_queue.h"
 #include "util/no_copy_or_move.h"
 #include "vulkan/device.h"
 
@@ -14,9 +16,10 @@ class Scene : public NoCopyOrMove
   private:
     Camera m_camera;
     Model m_model;
+    RenderQueue m_render_queue;
 
   public:
-    Scene(const Device& device) : m_camera(device), m_model() {}
+    Scene(const Device& device) : m_camera(device), m_model(), m_render_queue(device) {}
 
     const Camera& camera() const
     {
@@ -39,13 +42,22 @@ class Scene : public NoCopyOrMove
     void flush(uint32_t frame_index)
     {
         m_camera.flush(frame_index);
-        m_model.flush(frame_index);
+        m_model.flush();
+
+        const Camera& camera = m_camera;
+        m_model.select_lods(LodSelector(camera.fov()), camera.position());
     }
 
-    void render(VkCommandBuffer command_buffer, uint32_t frame_index, GraphicsPipeline& pipeline)
+    void render(VkCommandBuffer command_buffer,
+                uint32_t frame_index,
+                GraphicsPipeline& pipeline,
+                const PipelineManager& pipelines)
     {
         m_camera.bind(frame_index, pipeline);
-        m_model.render(command_buffer, frame_index, pipeline);
+
+        m_render_queue.begin(m_camera.view(), m_camera.clip_far());
+        m_model.collect(m_render_queue);
+        m_render_queue.render(command_buffer, frame_index, pipeline, pipelines);
     }
 };
 
@@ -79,21 +79,28 @@ CubesOne::face_t CubesOne::create_face(uint32_t face)
     return result;
 }
 
-void CubesOne::load(const Device& device, TextureFactory& texture_factory, GraphicsBuffers& graphics_buffers)
+void CubesOne::load(const Device& device,
+                   const AssetReader& assets,
+                   TextureFactory& texture_factory,
+                   GraphicsBuffers& graphics_buffers,
+                   UploadBatch& upload_batch)
 {
     texture_factory.clear();
-    texture_factory.load_texture("george", "george.png");
+    texture_factory.load_texture_async("george", "george.png");
 
-    graphics_buffers.load_vertexes(m_vertexes);
-    graphics_buffers.load_indexes(m_indexes);
+    graphics_buffers.load_vertexes(upload_batch, m_vertexes);
+    graphics_buffers.load_indexes(upload_batch, m_indexes);
 
     std::vector<Primitive> const primitives = {{0, static_cast<uint32_t>(m_indexes.size())}};
 
     std::vector<Primitive> const empty = {};
 
+    auto& material = m_scene.model().add_material(
+        std::make_unique<Material>(Material::AlphaMode::kOpaque, texture_factory["george"]));
+
     auto& root_node = m_scene.model().root_node();
     auto& child1 = root_node.add_child();
-    child1.add_child(std::make_unique<Mesh>(device, primitives, texture_factory["george"]));
+    child1.add_child(std::make_unique<Mesh>(primitives, &material));
 
     auto& camera = m_scene.camera();
     camera.target() = glm::vec3(0.0F, 0.0F, 0.0F);
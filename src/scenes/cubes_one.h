@@ -1,5 +1,6 @@
 #pragma once
 
+#include "model/mesh_shader.h"
 #include "render_scene.h"
 #include "util/no_copy_or_move.h"
 #include "vulkan/device.h"
@@ -39,13 +40,16 @@ class CubesOne final : public RenderScene
 
   public:
     CubesOne(const Device& device) :
-        RenderScene(device, "cubes_one.vert", "cubes_one.frag"),
+        RenderScene(device, MeshShader::kVertex, MeshShader::kFragment),
         m_indexes(create_indexes()),
         m_vertexes(create_vertexes())
     {
     }
 
-    virtual void
-    load(const Device& device, TextureFactory& texture_factory, GraphicsBuffers& graphics_buffers) override;
+    virtual void load(const Device& device,
+                      const AssetReader& assets,
+                      TextureFactory& texture_factory,
+                      GraphicsBuffers& graphics_buffers,
+                      UploadBatch& upload_batch) override;
 };
 } // namespace steeplejack
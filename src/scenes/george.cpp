@@ -44,22 +44,29 @@ const std::vector<steeplejack::Vertex::index_t> kIndexes = {
     0,
 };
 
-void George::load(const Device& device, TextureFactory& texture_factory, GraphicsBuffers& graphics_buffers)
+void George::load(const Device& device,
+                 const AssetReader& assets,
+                 TextureFactory& texture_factory,
+                 GraphicsBuffers& graphics_buffers,
+                 UploadBatch& upload_batch)
 {
     texture_factory.clear();
-    texture_factory.load_texture("george", "george.png");
+    texture_factory.load_texture_async("george", "george.png");
 
-    graphics_buffers.load_vertexes(kVertexes);
-    graphics_buffers.load_indexes(kIndexes);
+    graphics_buffers.load_vertexes(upload_batch, kVertexes);
+    graphics_buffers.load_indexes(upload_batch, kIndexes);
 
     std::vector<Primitive> const primitives = {{0, static_cast<uint32_t>(kIndexes.size())}};
 
+    auto& material = m_scene.model().add_material(
+        std::make_unique<Material>(Material::AlphaMode::kOpaque, texture_factory["george"]));
+
     auto& root_node = m_scene.model().root_node();
-    auto mesh1 = std::make_unique<Mesh>(device, primitives, texture_factory["george"]);
+    auto mesh1 = std::make_unique<Mesh>(primitives, &material);
     auto& child1 = root_node.add_child(std::move(mesh1));
     child1.translation() = glm::vec3(0.0F, 0.0F, 0.0F);
 
-    auto mesh2 = std::make_unique<Mesh>(device, primitives, texture_factory["george"]);
+    auto mesh2 = std::make_unique<Mesh>(primitives, &material);
     auto& child2 = root_node.add_child(std::move(mesh2));
     child2.translation() = glm::vec3(0.0F, -1.0F, -1.0F);
 
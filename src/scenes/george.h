@@ -1,5 +1,6 @@
 #pragma once
 
+#include "model/mesh_shader.h"
 #include "render_scene.h"
 #include "util/no_copy_or_move.h"
 #include "vulkan/device.h"
@@ -17,9 +18,12 @@ class George : public RenderScene
     void update(uint32_t frame_index, float aspect_ratio, float time) override;
 
   public:
-    George(const Device& device) : RenderScene(device, "george.vert", "george.frag") {}
+    George(const Device& device) : RenderScene(device, MeshShader::kVertex, MeshShader::kFragment) {}
 
-    virtual void
-    load(const Device& device, TextureFactory& texture_factory, GraphicsBuffers& graphics_buffers) override;
+    virtual void load(const Device& device,
+                      const AssetReader& assets,
+                      TextureFactory& texture_factory,
+                      GraphicsBuffers& graphics_buffers,
+                      UploadBatch& upload_batch) override;
 };
 } // namespace steeplejack
@@ -0,0 +1,43 @@
+#include "gltf_scene.h"
+
+#include "model/gltf_loader.h"
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+using namespace steeplejack;
+
+void GltfScene::load(const Device& /*device*/,
+                     const AssetReader& assets,
+                     TextureFactory& texture_factory,
+                     GraphicsBuffers& graphics_buffers,
+                     UploadBatch& upload_batch)
+{
+    texture_factory.clear();
+
+    auto& model_node = m_scene.model().root_node().add_child();
+    model_node.rotation() = glm::angleAxis(glm::radians(90.0F), glm::vec3(1.0F, 0.0F, 0.0F));
+
+    const auto bounds = GltfLoader(assets, texture_factory)
+                            .load(m_path, m_scene.model(), model_node, graphics_buffers, upload_batch);
+    m_center = glm::vec3(model_node.local_matrix() * glm::vec4((bounds.min + bounds.max) * 0.5F, 1.0F));
+    m_radius = std::max(glm::length(bounds.max - bounds.min) * 0.5F, 0.01F);
+
+    auto& camera = m_scene.camera();
+    camera.target() = m_center;
+    camera.clip_near() = m_radius * 0.01F;
+    camera.clip_far() = m_radius * 10.0F;
+    camera.fov() = 45.0F;
+}
+
+void GltfScene::update(uint32_t frame_index, float aspect_ratio, float time)
+{
+    const auto orbit = glm::angleAxis(time * glm::radians(20.0F), glm::vec3(0.0F, 0.0F, 1.0F));
+
+    auto& camera = m_scene.camera();
+    camera.position() = m_center + orbit * (glm::vec3(2.0F, 0.0F, 1.0F) * m_radius * 1.2F);
+    camera.aspect_ratio() = aspect_ratio;
+
+    m_scene.flush(frame_index);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "model/mesh_shader.h"
+#include "render_scene.h"
+#include "util/asset_reader.h"
+#include "vulkan/device.h"
+#include "vulkan/graphics_buffers.h"
+#include "vulkan/texture_factory.h"
+#include "vulkan/upload_batch.h"
+
+#include <glm/glm.hpp>
+#include <string>
+#include <utility>
+
+namespace steeplejack
+{
+// Shows a glTF model, turned from glTF's y-up into our z-up, with the camera circling its bounds. Each glTF material
+// becomes a Material, so masked ones such as foliage are cut out and blended ones drawn over the rest.
+class GltfScene final : public RenderScene
+{
+  private:
+    const std::string m_path;
+
+    glm::vec3 m_center{0.0F};
+    float m_radius = 1.0F;
+
+  protected:
+    void update(uint32_t frame_index, float aspect_ratio, float time) override;
+
+  public:
+    GltfScene(const Device& device, std::string path) :
+        RenderScene(device, MeshShader::kVertex, MeshShader::kFragment), m_path(std::move(path))
+    {
+    }
+
+    void load(const Device& device,
+              const AssetReader& assets,
+              TextureFactory& texture_factory,
+              GraphicsBuffers& graphics_buffers,
+              UploadBatch& upload_batch) override;
+};
+} // namespace steeplejack
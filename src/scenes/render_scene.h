@@ -1,14 +1,19 @@
 #pragma once
 
 #include "model/scene.h"
+#include "util/asset_reader.h"
 #include "util/no_copy_or_move.h"
+#include "util/specialization_constants.h"
 #include "vulkan/device.h"
 #include "vulkan/graphics_buffers.h"
 #include "vulkan/graphics_pipeline.h"
+#include "vulkan/pipeline_manager.h"
 #include "vulkan/texture_factory.h"
+#include "vulkan/upload_batch.h"
 
 #include <chrono>
 #include <string>
+#include <utility>
 
 namespace steeplejack
 {
@@ -17,6 +22,7 @@ class RenderScene : NoCopyOrMove
   private:
     const std::string m_vertex_shader;
     const std::string m_fragment_shader;
+    const SpecializationConstants m_specialization;
 
   protected:
     Scene m_scene;
@@ -31,8 +37,14 @@ class RenderScene : NoCopyOrMove
     virtual void update(uint32_t frame_index, float aspect_ratio, float time) = 0;
 
   public:
-    RenderScene(const Device& device, const std::string& vertex_shader, const std::string& fragment_shader) :
-        m_vertex_shader(vertex_shader), m_fragment_shader(fragment_shader), m_scene(device)
+    RenderScene(const Device& device,
+                const std::string& vertex_shader,
+                const std::string& fragment_shader,
+                SpecializationConstants specialization = {}) :
+        m_vertex_shader(vertex_shader),
+        m_fragment_shader(fragment_shader),
+        m_specialization(std::move(specialization)),
+        m_scene(device)
     {
     }
 
@@ -46,8 +58,19 @@ class RenderScene : NoCopyOrMove
     {
         return m_fragment_shader;
     }
+    // Specialization constants of both shaders, which pick the variant of the shaders the scene is drawn with.
+    // Materials set theirs on top.
+    const SpecializationConstants& specialization() const
+    {
+        return m_specialization;
+    }
 
-    virtual void load(const Device& device, TextureFactory& texture_factory, GraphicsBuffers& graphics_buffers) = 0;
+    // Records the scene's geometry into upload_batch, which the caller submits once the whole scene has been loaded.
+    virtual void load(const Device& device,
+                      const AssetReader& assets,
+                      TextureFactory& texture_factory,
+                      GraphicsBuffers& graphics_buffers,
+                      UploadBatch& upload_batch) = 0;
 
     void update(uint32_t frame_index, float aspect_ratio)
     {
@@ -55,9 +78,25 @@ class RenderScene : NoCopyOrMove
         update(frame_index, aspect_ratio, time);
     }
 
-    void render(VkCommandBuffer command_buffer, uint32_t frame_index, GraphicsPipeline& pipeline)
+    // Materials added since the previous frame request their pipelines first; they are skipped until compiled.
+    void render(VkCommandBuffer command_buffer,
+                uint32_t frame_index,
+                GraphicsPipeline& pipeline,
+                PipelineManager& pipelines)
+    {
+        auto& model = m_scene.model();
+        if (model.pipelines_pending())
+        {
+            model.request_pipelines(pipelines, pipelines.state(m_vertex_shader, m_fragment_shader, m_specialization));
+        }
+
+        m_scene.render(command_buffer, frame_index, pipeline, pipelines);
+    }
+
+    // Called when the pipeline manager has been replaced, so that materials request their pipelines from the new one.
+    void reset_pipelines()
     {
-        m_scene.render(command_buffer, frame_index, pipeline);
+        m_scene.model().reset_pipelines();
     }
 };
 } // namespace steeplejack
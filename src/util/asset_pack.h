@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace steeplejack
+{
+// Archive of many assets in one file, meant to be memory mapped. A 32 byte header is followed by the blobs, each
+// starting on a kBlobAlignment boundary so it can be handed to a staging buffer or the GPU as it lies in the map, and
+// then by the index. Each index entry is a fixed 32 byte record followed by the entry's name, padded to 8 bytes. Names
+// are paths relative to the working directory, such as assets/textures/george.png. Entries may be LZ4 compressed, in
+// which case size is the size after decompression.
+struct AssetPack
+{
+    enum class Compression : uint32_t
+    {
+        kNone = 0,
+        kLz4 = 1,
+    };
+
+    struct Entry
+    {
+        std::string name;
+        uint64_t offset;
+        uint64_t stored_size;
+        uint64_t size;
+        Compression compression;
+    };
+
+    // What write needs for one entry: bytes are stored as given, already compressed when compression says so.
+    struct Input
+    {
+        std::string name;
+        std::span<const std::byte> bytes;
+        uint64_t size;
+        Compression compression;
+    };
+
+    std::vector<Entry> entries;
+
+    static constexpr std::array<uint8_t, 8> kIdentifier = {'S', 'J', 'P', 'A', 'C', 'K', 0x0D, 0x0A};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 32;
+    static constexpr size_t kIndexEntrySize = 32;
+    static constexpr size_t kBlobAlignment = 64;
+
+    // Fields are little endian, as are all the hosts we build for.
+    template <typename T> static T read(std::span<const std::byte> data, size_t offset)
+    {
+        T value;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T> static void store(std::vector<std::byte>& data, size_t offset, T value)
+    {
+        std::memcpy(data.data() + offset, &value, sizeof(T));
+    }
+
+    static size_t align(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    static AssetPack parse(std::span<const std::byte> data)
+    {
+        if (data.size() < kHeaderSize || std::memcmp(data.data(), kIdentifier.data(), kIdentifier.size()) != 0)
+        {
+            throw std::runtime_error("Failed to parse asset pack: not an asset pack");
+        }
+        if (read<uint32_t>(data, 8) != kVersion)
+        {
+            throw std::runtime_error("Failed to parse asset pack: unsupported version");
+        }
+
+        const auto entry_count = read<uint32_t>(data, 12);
+        auto offset = read<uint64_t>(data, 16);
+
+        AssetPack result;
+        result.entries.reserve(entry_count);
+
+        for (uint32_t i = 0; i < entry_count; i++)
+        {
+            if (offset > data.size() || data.size() - offset < kIndexEntrySize)
+            {
+                throw std::runtime_error("Failed to parse asset pack: truncated index");
+            }
+
+            const auto name_size = read<uint32_t>(data, offset + 28);
+            if (data.size() - offset - kIndexEntrySize < name_size)
+            {
+                throw std::runtime_error("Failed to parse asset pack: truncated index");
+            }
+
+            Entry entry = {
+                .name = std::string(reinterpret_cast<const char*>(data.data() + offset + kIndexEntrySize), name_size),
+                .offset = read<uint64_t>(data, offset),
+                .stored_size = read<uint64_t>(data, offset + 8),
+                .size = read<uint64_t>(data, offset + 16),
+                .compression = static_cast<Compression>(read<uint32_t>(data, offset + 24)),
+            };
+
+            if (entry.offset > data.size() || entry.stored_size > data.size() - entry.offset)
+            {
+                throw std::runtime_error("Failed to parse asset pack: " + entry.name + " is out of range");
+            }
+            if (entry.compression != Compression::kNone && entry.compression != Compression::kLz4)
+            {
+                throw std::runtime_error("Failed to parse asset pack: " + entry.name + " has unknown compression");
+            }
+
+            result.entries.push_back(std::move(entry));
+            offset = align(offset + kIndexEntrySize + name_size, 8);
+        }
+
+        std::ranges::sort(result.entries, {}, &Entry::name);
+
+        return result;
+    }
+
+    static std::vector<std::byte> write(const std::vector<Input>& inputs)
+    {
+        std::vector<std::byte> data(kHeaderSize);
+        std::memcpy(data.data(), kIdentifier.data(), kIdentifier.size());
+        store<uint32_t>(data, 8, kVersion);
+        store<uint32_t>(data, 12, static_cast<uint32_t>(inputs.size()));
+
+        std::vector<uint64_t> offsets;
+        for (const auto& input : inputs)
+        {
+            data.resize(align(data.size(), kBlobAlignment));
+            offsets.push_back(data.size());
+            data.insert(data.end(), input.bytes.begin(), input.bytes.end());
+        }
+
+        data.resize(align(data.size(), 8));
+        store<uint64_t>(data, 16, data.size());
+
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            const auto& input = inputs[i];
+            const auto entry = data.size();
+
+            data.resize(align(entry + kIndexEntrySize + input.name.size(), 8));
+            store<uint64_t>(data, entry, offsets[i]);
+            store<uint64_t>(data, entry + 8, input.bytes.size());
+            store<uint64_t>(data, entry + 16, input.size);
+            store<uint32_t>(data, entry + 24, static_cast<uint32_t>(input.compression));
+            store<uint32_t>(data, entry + 28, static_cast<uint32_t>(input.name.size()));
+            std::memcpy(data.data() + entry + kIndexEntrySize, input.name.data(), input.name.size());
+        }
+
+        return data;
+    }
+
+    const Entry* find(std::string_view name) const
+    {
+        auto it = std::ranges::lower_bound(entries, name, {}, &Entry::name);
+        return it != entries.end() && it->name == name ? &*it : nullptr;
+    }
+};
+} // namespace steeplejack
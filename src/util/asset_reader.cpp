@@ -0,0 +1,66 @@
+#include "asset_reader.h"
+
+#include "spdlog/spdlog.h"
+
+#include <limits>
+#include <lz4.h>
+#include <stdexcept>
+
+using namespace steeplejack;
+
+AssetReader::AssetReader(const std::filesystem::path& pack_path) :
+    m_pack_file(open_pack(pack_path)),
+    m_pack(m_pack_file != nullptr ? AssetPack::parse(m_pack_file->bytes()) : AssetPack{})
+{
+    if (m_pack_file != nullptr)
+    {
+        spdlog::info("Opened asset pack {} with {} entries", pack_path.string(), m_pack.entries.size());
+    }
+}
+
+std::unique_ptr<MappedFile> AssetReader::open_pack(const std::filesystem::path& path)
+{
+    if (!std::filesystem::exists(path))
+    {
+        return nullptr;
+    }
+
+    return std::make_unique<MappedFile>(path);
+}
+
+bool AssetReader::exists(const std::string& name) const
+{
+    return m_pack.find(name) != nullptr || std::filesystem::exists(name);
+}
+
+Asset AssetReader::read(const std::string& name) const
+{
+    const auto* entry = m_pack.find(name);
+    if (entry == nullptr)
+    {
+        return Asset(std::make_unique<MappedFile>(name));
+    }
+
+    const auto stored = m_pack_file->bytes().subspan(entry->offset, entry->stored_size);
+    if (entry->compression == AssetPack::Compression::kNone)
+    {
+        return Asset(stored);
+    }
+
+    if (entry->stored_size > std::numeric_limits<int>::max() || entry->size > std::numeric_limits<int>::max())
+    {
+        throw std::runtime_error("Failed to read asset " + name + ": too large to decompress");
+    }
+
+    std::vector<std::byte> bytes(entry->size);
+    const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(stored.data()),
+                                         reinterpret_cast<char*>(bytes.data()),
+                                         static_cast<int>(stored.size()),
+                                         static_cast<int>(bytes.size()));
+    if (size < 0 || static_cast<uint64_t>(size) != entry->size)
+    {
+        throw std::runtime_error("Failed to read asset " + name + ": corrupt compressed data");
+    }
+
+    return Asset(std::move(bytes));
+}
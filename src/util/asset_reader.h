@@ -0,0 +1,82 @@
+#pragma once
+
+#include "asset_pack.h"
+#include "mapped_file.h"
+#include "no_copy_or_move.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace steeplejack
+{
+// Bytes of one asset: either a view into a mapped asset pack, which must outlive it, a buffer of its own, or a map of
+// its own loose file.
+class Asset
+{
+  private:
+    std::vector<std::byte> m_storage;
+    std::unique_ptr<MappedFile> m_file;
+    std::span<const std::byte> m_view;
+
+  public:
+    Asset() = default;
+
+    explicit Asset(std::span<const std::byte> view) : m_view(view) {}
+
+    explicit Asset(std::vector<std::byte> storage) : m_storage(std::move(storage)), m_view(m_storage) {}
+
+    explicit Asset(std::unique_ptr<MappedFile> file) : m_file(std::move(file)), m_view(m_file->bytes()) {}
+
+    // Moving a vector or a map keeps its bytes in place, so the view stays valid; a copy would not.
+    Asset(const Asset&) = delete;
+    Asset& operator=(const Asset&) = delete;
+    Asset(Asset&&) noexcept = default;
+    Asset& operator=(Asset&&) noexcept = default;
+
+    std::span<const std::byte> view() const
+    {
+        return m_view;
+    }
+
+    size_t size() const
+    {
+        return m_view.size();
+    }
+
+    // Narrows the view to size bytes from offset, keeping any storage.
+    Asset slice(size_t offset, size_t size) &&
+    {
+        Asset result = std::move(*this);
+        result.m_view = result.m_view.subspan(offset, size);
+        return result;
+    }
+};
+
+// Reads assets by their path relative to the working directory. Assets are taken from the memory mapped asset pack
+// when there is one and it holds them, and from loose files otherwise. Uncompressed entries are returned as views into
+// the map without being copied, and loose files are mapped too, so only the pages a caller touches are read. Safe to
+// use from several threads at once.
+class AssetReader : NoCopyOrMove
+{
+  public:
+    static constexpr const char* kDefaultPack = "assets.pack";
+
+  private:
+    const std::unique_ptr<MappedFile> m_pack_file;
+    const AssetPack m_pack;
+
+    static std::unique_ptr<MappedFile> open_pack(const std::filesystem::path& path);
+
+  public:
+    AssetReader(const std::filesystem::path& pack_path = kDefaultPack);
+
+    bool exists(const std::string& name) const;
+
+    Asset read(const std::string& name) const;
+};
+} // namespace steeplejack
@@ -0,0 +1,117 @@
+#include "directory_watcher.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef __linux__
+#include <array>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace steeplejack;
+
+#ifdef __linux__
+
+DirectoryWatcher::DirectoryWatcher(std::filesystem::path directory) : m_directory(std::move(directory))
+{
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify == -1)
+    {
+        throw std::runtime_error("Failed to watch directory: " + m_directory.generic_string());
+    }
+
+    // Editors either write a file in place or write another and rename it over the original.
+    if (inotify_add_watch(m_inotify, m_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+    {
+        close(m_inotify);
+        throw std::runtime_error("Failed to watch directory: " + m_directory.generic_string());
+    }
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    close(m_inotify);
+}
+
+std::vector<std::string> DirectoryWatcher::poll()
+{
+    std::vector<std::string> result;
+
+    alignas(inotify_event) std::array<char, 4096> buffer;
+    while (true)
+    {
+        const auto size = read(m_inotify, buffer.data(), buffer.size());
+        if (size <= 0)
+        {
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < size;)
+        {
+            inotify_event event;
+            std::memcpy(&event, buffer.data() + offset, sizeof(event));
+
+            if (event.len > 0)
+            {
+                std::string name(buffer.data() + offset + sizeof(event));
+                if (std::ranges::find(result, name) == result.end())
+                {
+                    result.push_back(std::move(name));
+                }
+            }
+
+            offset += static_cast<ssize_t>(sizeof(event) + event.len);
+        }
+    }
+
+    return result;
+}
+
+#else
+
+DirectoryWatcher::DirectoryWatcher(std::filesystem::path directory) :
+    m_directory(std::move(directory)), m_write_times(read_write_times())
+{
+}
+
+DirectoryWatcher::~DirectoryWatcher() = default;
+
+std::unordered_map<std::string, std::filesystem::file_time_type> DirectoryWatcher::read_write_times() const
+{
+    std::unordered_map<std::string, std::filesystem::file_time_type> result;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(m_directory, error))
+    {
+        if (entry.is_regular_file(error))
+        {
+            result.emplace(entry.path().filename().string(), entry.last_write_time(error));
+        }
+    }
+
+    return result;
+}
+
+std::vector<std::string> DirectoryWatcher::poll()
+{
+    auto write_times = read_write_times();
+
+    std::vector<std::string> result;
+    for (const auto& [name, time] : write_times)
+    {
+        const auto previous = m_write_times.find(name);
+        if (previous == m_write_times.end() || previous->second != time)
+        {
+            result.push_back(name);
+        }
+    }
+
+    m_write_times = std::move(write_times);
+
+    return result;
+}
+
+#endif
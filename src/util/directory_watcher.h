@@ -0,0 +1,37 @@
+#pragma once
+
+#include "no_copy_or_move.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifndef __linux__
+#include <unordered_map>
+#endif
+
+namespace steeplejack
+{
+// Reports the files of one directory that have been written, or moved into it, since the previous poll. Uses inotify
+// on Linux and compares modification times elsewhere.
+class DirectoryWatcher : NoCopyOrMove
+{
+  private:
+    const std::filesystem::path m_directory;
+#ifdef __linux__
+    int m_inotify = -1;
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_write_times;
+
+    std::unordered_map<std::string, std::filesystem::file_time_type> read_write_times() const;
+#endif
+
+  public:
+    DirectoryWatcher(std::filesystem::path directory);
+    ~DirectoryWatcher();
+
+    // Names, relative to the directory, of the files changed since the previous call, each at most once. Never
+    // blocks.
+    std::vector<std::string> poll();
+};
+} // namespace steeplejack
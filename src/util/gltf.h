@@ -0,0 +1,597 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace steeplejack
+{
+// The parts of a glTF 2.0 asset that the loader uses, parsed from a .gltf document or a .glb container. Nothing is
+// copied out of the buffers: accessors are read in place from whatever holds the buffer data, and the binary chunk of
+// a .glb is a view into the data it was parsed from.
+struct Gltf
+{
+    enum class ComponentType : uint32_t
+    {
+        kByte = 5120,
+        kUnsignedByte = 5121,
+        kShort = 5122,
+        kUnsignedShort = 5123,
+        kUnsignedInt = 5125,
+        kFloat = 5126,
+    };
+
+    struct Buffer
+    {
+        // Empty for the binary chunk of a .glb.
+        std::string uri;
+        uint64_t byte_length;
+    };
+
+    struct BufferView
+    {
+        uint32_t buffer;
+        uint64_t byte_offset;
+        uint64_t byte_length;
+        // 0 when elements are tightly packed.
+        uint32_t byte_stride;
+    };
+
+    struct Accessor
+    {
+        std::optional<uint32_t> buffer_view;
+        uint64_t byte_offset;
+        ComponentType component_type;
+        bool normalized;
+        uint64_t count;
+        uint32_t components;
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    struct Primitive
+    {
+        std::optional<uint32_t> position;
+        std::optional<uint32_t> texcoord;
+        std::optional<uint32_t> color;
+        std::optional<uint32_t> indices;
+        std::optional<uint32_t> material;
+        uint32_t mode;
+    };
+
+    struct Mesh
+    {
+        std::string name;
+        std::vector<Primitive> primitives;
+    };
+
+    // Either matrix or translation, rotation (x, y, z, w) and scale apply.
+    struct Node
+    {
+        std::string name;
+        std::optional<uint32_t> mesh;
+        std::vector<uint32_t> children;
+        std::array<float, 3> translation;
+        std::array<float, 4> rotation;
+        std::array<float, 3> scale;
+        std::optional<std::array<float, 16>> matrix;
+    };
+
+    enum class AlphaMode
+    {
+        kOpaque,
+        kMask,
+        kBlend,
+    };
+
+    struct Material
+    {
+        std::array<float, 4> base_color_factor;
+        std::optional<uint32_t> base_color_texture;
+        AlphaMode alpha_mode;
+        // Only used when alpha_mode is kMask.
+        float alpha_cutoff;
+        bool double_sided;
+    };
+
+    struct Texture
+    {
+        std::optional<uint32_t> source;
+        std::optional<uint32_t> sampler;
+    };
+
+    // Filters and wraps hold the OpenGL enums glTF uses; filters are unset when the asset leaves them to the renderer.
+    struct Sampler
+    {
+        std::optional<uint32_t> mag_filter;
+        std::optional<uint32_t> min_filter;
+        uint32_t wrap_s;
+        uint32_t wrap_t;
+    };
+
+    // Empty uri when the image is embedded in a buffer view.
+    struct Image
+    {
+        std::string uri;
+    };
+
+    // Reads the elements of an accessor in place, converting components to float or index as they are read.
+    struct AccessorView
+    {
+        const std::byte* data;
+        size_t stride;
+        ComponentType component_type;
+        bool normalized;
+        uint64_t count;
+        uint32_t components;
+
+        float read_float(uint64_t element, uint32_t component) const
+        {
+            const auto* value = data + element * stride + component * component_size(component_type);
+            switch (component_type)
+            {
+            case ComponentType::kFloat:
+                return load<float>(value);
+            case ComponentType::kUnsignedByte:
+                return normalized ? load<uint8_t>(value) / 255.0F : load<uint8_t>(value);
+            case ComponentType::kUnsignedShort:
+                return normalized ? load<uint16_t>(value) / 65535.0F : load<uint16_t>(value);
+            case ComponentType::kByte:
+                return normalized ? std::max(load<int8_t>(value) / 127.0F, -1.0F) : load<int8_t>(value);
+            case ComponentType::kShort:
+                return normalized ? std::max(load<int16_t>(value) / 32767.0F, -1.0F) : load<int16_t>(value);
+            case ComponentType::kUnsignedInt:
+                return static_cast<float>(load<uint32_t>(value));
+            }
+
+            return 0.0F;
+        }
+
+        uint32_t read_index(uint64_t element) const
+        {
+            const auto* value = data + element * stride;
+            switch (component_type)
+            {
+            case ComponentType::kUnsignedByte:
+                return load<uint8_t>(value);
+            case ComponentType::kUnsignedShort:
+                return load<uint16_t>(value);
+            case ComponentType::kUnsignedInt:
+                return load<uint32_t>(value);
+            default:
+                throw std::runtime_error("Failed to read glTF indices: unsupported component type");
+            }
+        }
+    };
+
+    static constexpr uint32_t kGlbMagic = 0x46546C67;
+    static constexpr uint32_t kGlbVersion = 2;
+    static constexpr uint32_t kChunkJson = 0x4E4F534A;
+    static constexpr uint32_t kChunkBin = 0x004E4942;
+    static constexpr size_t kGlbHeaderSize = 12;
+    static constexpr size_t kChunkHeaderSize = 8;
+
+    static constexpr uint32_t kModeTriangles = 4;
+
+    static constexpr uint32_t kFilterNearest = 9728;
+    static constexpr uint32_t kFilterLinear = 9729;
+    static constexpr uint32_t kFilterNearestMipmapNearest = 9984;
+    static constexpr uint32_t kFilterLinearMipmapNearest = 9985;
+    static constexpr uint32_t kFilterNearestMipmapLinear = 9986;
+    static constexpr uint32_t kFilterLinearMipmapLinear = 9987;
+
+    static constexpr uint32_t kWrapClampToEdge = 33071;
+    static constexpr uint32_t kWrapMirroredRepeat = 33648;
+    static constexpr uint32_t kWrapRepeat = 10497;
+
+    std::vector<Buffer> buffers;
+    std::vector<BufferView> buffer_views;
+    std::vector<Accessor> accessors;
+    std::vector<Mesh> meshes;
+    std::vector<Node> nodes;
+    std::vector<Material> materials;
+    std::vector<Texture> textures;
+    std::vector<Sampler> samplers;
+    std::vector<Image> images;
+
+    // Root nodes of the default scene, or of every node that is nobody's child when there is no scene.
+    std::vector<uint32_t> root_nodes;
+
+    std::span<const std::byte> binary_chunk;
+
+    template <typename T> static T load(const std::byte* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    static size_t component_size(ComponentType type)
+    {
+        switch (type)
+        {
+        case ComponentType::kByte:
+        case ComponentType::kUnsignedByte:
+            return 1;
+        case ComponentType::kShort:
+        case ComponentType::kUnsignedShort:
+            return 2;
+        case ComponentType::kUnsignedInt:
+        case ComponentType::kFloat:
+            return 4;
+        }
+
+        throw std::runtime_error("Failed to parse glTF: unknown component type");
+    }
+
+    static uint32_t component_count(const std::string& type)
+    {
+        static const std::array<std::pair<const char*, uint32_t>, 7> kTypes = {{
+            {"SCALAR", 1},
+            {"VEC2", 2},
+            {"VEC3", 3},
+            {"VEC4", 4},
+            {"MAT2", 4},
+            {"MAT3", 9},
+            {"MAT4", 16},
+        }};
+
+        for (const auto& [name, count] : kTypes)
+        {
+            if (type == name)
+            {
+                return count;
+            }
+        }
+
+        throw std::runtime_error("Failed to parse glTF: unknown accessor type " + type);
+    }
+
+    static AlphaMode alpha_mode(const std::string& mode)
+    {
+        static const std::array<std::pair<const char*, AlphaMode>, 3> kModes = {{
+            {"OPAQUE", AlphaMode::kOpaque},
+            {"MASK", AlphaMode::kMask},
+            {"BLEND", AlphaMode::kBlend},
+        }};
+
+        for (const auto& [name, value] : kModes)
+        {
+            if (mode == name)
+            {
+                return value;
+            }
+        }
+
+        throw std::runtime_error("Failed to parse glTF: unknown alpha mode " + mode);
+    }
+
+    // buffer_data holds the contents of each buffer, in order.
+    AccessorView view(uint32_t accessor_index, std::span<const std::span<const std::byte>> buffer_data) const
+    {
+        const auto& accessor = accessors.at(accessor_index);
+        if (!accessor.buffer_view)
+        {
+            throw std::runtime_error("Failed to read glTF accessor: sparse and empty accessors are not supported");
+        }
+
+        const auto& buffer_view = buffer_views.at(*accessor.buffer_view);
+        const auto buffer = buffer_data[buffer_view.buffer];
+
+        const size_t element_size = component_size(accessor.component_type) * accessor.components;
+        const size_t stride = buffer_view.byte_stride != 0 ? buffer_view.byte_stride : element_size;
+        const uint64_t extent = accessor.count == 0 ? 0 : (accessor.count - 1) * stride + element_size;
+
+        if (buffer_view.byte_offset > buffer.size() ||
+            buffer_view.byte_length > buffer.size() - buffer_view.byte_offset ||
+            accessor.byte_offset > buffer_view.byte_length || extent > buffer_view.byte_length - accessor.byte_offset)
+        {
+            throw std::runtime_error("Failed to read glTF accessor: out of range");
+        }
+
+        return {
+            .data = buffer.data() + buffer_view.byte_offset + accessor.byte_offset,
+            .stride = stride,
+            .component_type = accessor.component_type,
+            .normalized = accessor.normalized,
+            .count = accessor.count,
+            .components = accessor.components,
+        };
+    }
+
+    static std::optional<uint32_t> optional_index(const nlohmann::json& object, const char* key)
+    {
+        if (!object.contains(key))
+        {
+            return std::nullopt;
+        }
+
+        return object.at(key).get<uint32_t>();
+    }
+
+    template <size_t N>
+    static std::array<float, N>
+    float_array(const nlohmann::json& object, const char* key, std::array<float, N> fallback)
+    {
+        if (!object.contains(key))
+        {
+            return fallback;
+        }
+
+        const auto values = object.at(key).get<std::vector<float>>();
+        if (values.size() != N)
+        {
+            throw std::runtime_error(std::string("Failed to parse glTF: wrong number of values in ") + key);
+        }
+
+        std::ranges::copy(values, fallback.begin());
+        return fallback;
+    }
+
+    // Accepts a .glb container or a .gltf JSON document.
+    static Gltf parse(std::span<const std::byte> data)
+    {
+        std::span<const std::byte> json_chunk = data;
+        std::span<const std::byte> binary_chunk;
+
+        if (data.size() >= 4 && load<uint32_t>(data.data()) == kGlbMagic)
+        {
+            if (data.size() < kGlbHeaderSize + kChunkHeaderSize || load<uint32_t>(data.data() + 4) != kGlbVersion)
+            {
+                throw std::runtime_error("Failed to parse glTF: unsupported GLB container");
+            }
+
+            const auto length = std::min<size_t>(load<uint32_t>(data.data() + 8), data.size());
+            std::vector<std::span<const std::byte>> chunks;
+            std::vector<uint32_t> chunk_types;
+
+            size_t offset = kGlbHeaderSize;
+            while (length - offset >= kChunkHeaderSize)
+            {
+                const auto chunk_length = load<uint32_t>(data.data() + offset);
+                const auto chunk_type = load<uint32_t>(data.data() + offset + 4);
+                if (chunk_length > length - offset - kChunkHeaderSize)
+                {
+                    throw std::runtime_error("Failed to parse glTF: truncated GLB chunk");
+                }
+
+                chunks.push_back(data.subspan(offset + kChunkHeaderSize, chunk_length));
+                chunk_types.push_back(chunk_type);
+                offset += kChunkHeaderSize + ((chunk_length + 3) & ~size_t{3});
+                if (offset > length)
+                {
+                    break;
+                }
+            }
+
+            if (chunks.empty() || chunk_types[0] != kChunkJson)
+            {
+                throw std::runtime_error("Failed to parse glTF: GLB does not start with a JSON chunk");
+            }
+
+            json_chunk = chunks[0];
+            if (chunks.size() > 1 && chunk_types[1] == kChunkBin)
+            {
+                binary_chunk = chunks[1];
+            }
+        }
+
+        try
+        {
+            const auto* text = reinterpret_cast<const char*>(json_chunk.data());
+            return from_json(nlohmann::json::parse(text, text + json_chunk.size()), binary_chunk);
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            throw std::runtime_error(std::string("Failed to parse glTF: ") + e.what());
+        }
+    }
+
+    static Gltf from_json(const nlohmann::json& json, std::span<const std::byte> binary_chunk)
+    {
+        Gltf result;
+        result.binary_chunk = binary_chunk;
+
+        const auto array = [&](const char* key) { return json.value(key, nlohmann::json::array()); };
+
+        for (const auto& buffer : array("buffers"))
+        {
+            result.buffers.push_back({
+                .uri = buffer.value("uri", std::string()),
+                .byte_length = buffer.at("byteLength").get<uint64_t>(),
+            });
+        }
+
+        for (const auto& buffer_view : array("bufferViews"))
+        {
+            result.buffer_views.push_back({
+                .buffer = buffer_view.at("buffer").get<uint32_t>(),
+                .byte_offset = buffer_view.value("byteOffset", uint64_t{0}),
+                .byte_length = buffer_view.at("byteLength").get<uint64_t>(),
+                .byte_stride = buffer_view.value("byteStride", uint32_t{0}),
+            });
+        }
+
+        for (const auto& accessor : array("accessors"))
+        {
+            if (accessor.contains("sparse"))
+            {
+                throw std::runtime_error("Failed to parse glTF: sparse accessors are not supported");
+            }
+
+            result.accessors.push_back({
+                .buffer_view = optional_index(accessor, "bufferView"),
+                .byte_offset = accessor.value("byteOffset", uint64_t{0}),
+                .component_type = static_cast<ComponentType>(accessor.at("componentType").get<uint32_t>()),
+                .normalized = accessor.value("normalized", false),
+                .count = accessor.at("count").get<uint64_t>(),
+                .components = component_count(accessor.at("type").get<std::string>()),
+                .min = accessor.value("min", std::vector<float>()),
+                .max = accessor.value("max", std::vector<float>()),
+            });
+        }
+
+        for (const auto& mesh : array("meshes"))
+        {
+            auto& result_mesh =
+                result.meshes.emplace_back(Mesh{.name = mesh.value("name", std::string()), .primitives = {}});
+            for (const auto& primitive : mesh.at("primitives"))
+            {
+                const auto& attributes = primitive.at("attributes");
+                result_mesh.primitives.push_back({
+                    .position = optional_index(attributes, "POSITION"),
+                    .texcoord = optional_index(attributes, "TEXCOORD_0"),
+                    .color = optional_index(attributes, "COLOR_0"),
+                    .indices = optional_index(primitive, "indices"),
+                    .material = optional_index(primitive, "material"),
+                    .mode = primitive.value("mode", kModeTriangles),
+                });
+            }
+        }
+
+        for (const auto& node : array("nodes"))
+        {
+            result.nodes.push_back({
+                .name = node.value("name", std::string()),
+                .mesh = optional_index(node, "mesh"),
+                .children = node.value("children", std::vector<uint32_t>()),
+                .translation = float_array<3>(node, "translation", {0.0F, 0.0F, 0.0F}),
+                .rotation = float_array<4>(node, "rotation", {0.0F, 0.0F, 0.0F, 1.0F}),
+                .scale = float_array<3>(node, "scale", {1.0F, 1.0F, 1.0F}),
+                .matrix = node.contains("matrix") ? std::optional(float_array<16>(node, "matrix", {})) : std::nullopt,
+            });
+        }
+
+        for (const auto& material : array("materials"))
+        {
+            const auto pbr = material.value("pbrMetallicRoughness", nlohmann::json::object());
+            const auto base_color_texture = pbr.value("baseColorTexture", nlohmann::json::object());
+            result.materials.push_back({
+                .base_color_factor = float_array<4>(pbr, "baseColorFactor", {1.0F, 1.0F, 1.0F, 1.0F}),
+                .base_color_texture = optional_index(base_color_texture, "index"),
+                .alpha_mode = alpha_mode(material.value("alphaMode", std::string("OPAQUE"))),
+                .alpha_cutoff = material.value("alphaCutoff", 0.5F),
+                .double_sided = material.value("doubleSided", false),
+            });
+        }
+
+        for (const auto& texture : array("textures"))
+        {
+            result.textures.push_back({
+                .source = optional_index(texture, "source"),
+                .sampler = optional_index(texture, "sampler"),
+            });
+        }
+
+        for (const auto& sampler : array("samplers"))
+        {
+            result.samplers.push_back({
+                .mag_filter = optional_index(sampler, "magFilter"),
+                .min_filter = optional_index(sampler, "minFilter"),
+                .wrap_s = sampler.value("wrapS", kWrapRepeat),
+                .wrap_t = sampler.value("wrapT", kWrapRepeat),
+            });
+        }
+
+        for (const auto& image : array("images"))
+        {
+            result.images.push_back({.uri = image.value("uri", std::string())});
+        }
+
+        const auto scenes = array("scenes");
+        if (!scenes.empty())
+        {
+            const auto scene = json.value("scene", uint32_t{0});
+            result.root_nodes = scenes.at(scene).value("nodes", std::vector<uint32_t>());
+        }
+        else
+        {
+            std::vector<bool> is_child(result.nodes.size());
+            for (const auto& node : result.nodes)
+            {
+                for (auto child : node.children)
+                {
+                    // Out of range children are reported by validate.
+                    if (child < is_child.size())
+                    {
+                        is_child[child] = true;
+                    }
+                }
+            }
+
+            for (uint32_t i = 0; i < result.nodes.size(); i++)
+            {
+                if (!is_child[i])
+                {
+                    result.root_nodes.push_back(i);
+                }
+            }
+        }
+
+        result.validate();
+        return result;
+    }
+
+    // Checks every index that refers to another array, so that users can index without checking.
+    void validate() const
+    {
+        const auto check = [](std::optional<uint32_t> index, size_t size, const char* what)
+        {
+            if (index && *index >= size)
+            {
+                throw std::runtime_error(std::string("Failed to parse glTF: ") + what + " index out of range");
+            }
+        };
+
+        for (const auto& buffer_view : buffer_views)
+        {
+            check(buffer_view.buffer, buffers.size(), "buffer");
+        }
+        for (const auto& accessor : accessors)
+        {
+            check(accessor.buffer_view, buffer_views.size(), "buffer view");
+            component_size(accessor.component_type); // throws for unknown types
+        }
+        for (const auto& mesh : meshes)
+        {
+            for (const auto& primitive : mesh.primitives)
+            {
+                check(primitive.position, accessors.size(), "accessor");
+                check(primitive.texcoord, accessors.size(), "accessor");
+                check(primitive.color, accessors.size(), "accessor");
+                check(primitive.indices, accessors.size(), "accessor");
+                check(primitive.material, materials.size(), "material");
+            }
+        }
+        for (const auto& node : nodes)
+        {
+            check(node.mesh, meshes.size(), "mesh");
+            for (auto child : node.children)
+            {
+                check(child, nodes.size(), "node");
+            }
+        }
+        for (auto root : root_nodes)
+        {
+            check(root, nodes.size(), "node");
+        }
+        for (const auto& material : materials)
+        {
+            check(material.base_color_texture, textures.size(), "texture");
+        }
+        for (const auto& texture : textures)
+        {
+            check(texture.source, images.size(), "image");
+            check(texture.sampler, samplers.size(), "sampler");
+        }
+    }
+};
+} // namespace steeplejack
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace steeplejack
+{
+// Mixes value into hash, as boost::hash_combine does, for hashing a key field by field.
+inline void hash_combine(size_t& hash, uint64_t value)
+{
+    hash ^= std::hash<uint64_t>{}(value) + 0x9e3779b97f4a7c15ULL + (hash << 6U) + (hash >> 2U);
+}
+} // namespace steeplejack
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace steeplejack
+{
+// Parser for the KTX2 texture container. Only 2D, single layer, non-supercompressed files are accepted: the level
+// data can then be copied to the GPU exactly as it is stored. Offsets are relative to the start of the file.
+struct Ktx2
+{
+    struct Level
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    uint32_t vk_format;
+    uint32_t width;
+    uint32_t height;
+    std::vector<Level> levels;
+
+    static constexpr std::array<uint8_t, 12> kIdentifier =
+        {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+    static constexpr size_t kHeaderSize = 80;
+    static constexpr size_t kLevelIndexEntrySize = 24;
+
+    // Enough for the texel blocks of every format we write, and a multiple of 4 as the format requires.
+    static constexpr size_t kLevelAlignment = 16;
+
+    // Fields are little endian, as are all the hosts we build for.
+    template <typename T> static T read(std::span<const std::byte> data, size_t offset)
+    {
+        T value;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T> static void store(std::vector<std::byte>& data, size_t offset, T value)
+    {
+        std::memcpy(data.data() + offset, &value, sizeof(T));
+    }
+
+    static Ktx2 parse(std::span<const std::byte> data)
+    {
+        if (data.size() < kHeaderSize ||
+            std::memcmp(data.data(), kIdentifier.data(), kIdentifier.size()) != 0)
+        {
+            throw std::runtime_error("Failed to parse KTX2: not a KTX2 file");
+        }
+
+        Ktx2 result = {
+            .vk_format = read<uint32_t>(data, 12),
+            .width = read<uint32_t>(data, 20),
+            .height = read<uint32_t>(data, 24),
+            .levels = {},
+        };
+
+        const auto depth = read<uint32_t>(data, 28);
+        const auto layer_count = read<uint32_t>(data, 32);
+        const auto face_count = read<uint32_t>(data, 36);
+        const auto level_count = std::max(read<uint32_t>(data, 40), 1U);
+        const auto supercompression_scheme = read<uint32_t>(data, 44);
+
+        if (result.vk_format == 0)
+        {
+            throw std::runtime_error("Failed to parse KTX2: undefined format");
+        }
+        if (result.width == 0 || result.height == 0 || depth > 1 || layer_count > 1 || face_count != 1)
+        {
+            throw std::runtime_error("Failed to parse KTX2: only single layer 2D textures are supported");
+        }
+        if (supercompression_scheme != 0)
+        {
+            throw std::runtime_error("Failed to parse KTX2: supercompression is not supported");
+        }
+        if (level_count > 32 || data.size() < kHeaderSize + level_count * kLevelIndexEntrySize)
+        {
+            throw std::runtime_error("Failed to parse KTX2: truncated level index");
+        }
+
+        for (uint32_t level = 0; level < level_count; level++)
+        {
+            const size_t entry = kHeaderSize + level * kLevelIndexEntrySize;
+            const auto offset = read<uint64_t>(data, entry);
+            const auto size = read<uint64_t>(data, entry + 8);
+
+            if (offset > data.size() || size > data.size() - offset)
+            {
+                throw std::runtime_error("Failed to parse KTX2: level data out of range");
+            }
+
+            result.levels.push_back({
+                .offset = offset,
+                .size = size,
+                .width = std::max(result.width >> level, 1U),
+                .height = std::max(result.height >> level, 1U),
+            });
+        }
+
+        return result;
+    }
+
+    // Writes a 2D texture from its levels, finest first, in a form parse accepts. The data format descriptor is stored
+    // as given; the level data follows it coarsest first, as the format requires.
+    static std::vector<std::byte> write(uint32_t vk_format,
+                                        uint32_t type_size,
+                                        uint32_t width,
+                                        uint32_t height,
+                                        const std::vector<std::span<const std::byte>>& levels,
+                                        std::span<const std::byte> data_format_descriptor)
+    {
+        const auto level_count = static_cast<uint32_t>(levels.size());
+        const size_t dfd_offset = kHeaderSize + level_count * kLevelIndexEntrySize;
+
+        std::vector<std::byte> data(dfd_offset);
+        std::memcpy(data.data(), kIdentifier.data(), kIdentifier.size());
+        store<uint32_t>(data, 12, vk_format);
+        store<uint32_t>(data, 16, type_size);
+        store<uint32_t>(data, 20, width);
+        store<uint32_t>(data, 24, height);
+        store<uint32_t>(data, 36, 1);
+        store<uint32_t>(data, 40, level_count);
+        store<uint32_t>(data, 48, static_cast<uint32_t>(dfd_offset));
+        store<uint32_t>(data, 52, static_cast<uint32_t>(data_format_descriptor.size()));
+        data.insert(data.end(), data_format_descriptor.begin(), data_format_descriptor.end());
+
+        for (uint32_t level = level_count; level-- > 0;)
+        {
+            data.resize((data.size() + kLevelAlignment - 1) / kLevelAlignment * kLevelAlignment);
+
+            const size_t entry = kHeaderSize + level * kLevelIndexEntrySize;
+            store<uint64_t>(data, entry, data.size());
+            store<uint64_t>(data, entry + 8, levels[level].size());
+            store<uint64_t>(data, entry + 16, levels[level].size());
+            data.insert(data.end(), levels[level].begin(), levels[level].end());
+        }
+
+        return data;
+    }
+};
+} // namespace steeplejack
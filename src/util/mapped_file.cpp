@@ -0,0 +1,112 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace steeplejack;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    m_file = CreateFileW(path.c_str(),
+                         GENERIC_READ,
+                         FILE_SHARE_READ,
+                         nullptr,
+                         OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                         nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open file " + path.string());
+    }
+
+    LARGE_INTEGER size = {};
+    GetFileSizeEx(m_file, &size);
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped; they are simply empty.
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr)
+    {
+        CloseHandle(m_file);
+        throw std::runtime_error("Failed to map file " + path.string());
+    }
+
+    m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr)
+    {
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw std::runtime_error("Failed to map file " + path.string());
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file < 0)
+    {
+        throw std::runtime_error("Failed to open file " + path.string());
+    }
+
+    struct stat status = {};
+    fstat(m_file, &status);
+    m_size = static_cast<size_t>(status.st_size);
+
+    // Empty files cannot be mapped; they are simply empty.
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        close(m_file);
+        throw std::runtime_error("Failed to map file " + path.string());
+    }
+
+    m_data = static_cast<const std::byte*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+    close(m_file);
+}
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "no_copy_or_move.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace steeplejack
+{
+// Read-only memory map of a whole file. Pages are read in by the OS as they are touched, and the bytes can be used in
+// place for as long as the map lives.
+class MappedFile : NoCopyOrMove
+{
+  private:
+    const std::byte* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+
+  public:
+    MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    std::span<const std::byte> bytes() const
+    {
+        return {m_data, m_size};
+    }
+};
+} // namespace steeplejack
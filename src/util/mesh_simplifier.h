@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace steeplejack
+{
+// Builds coarser levels of detail of an indexed triangle mesh by vertex clustering: every vertex is snapped to the
+// first vertex found in its cell of a uniform grid, and triangles that collapse are dropped. Levels keep using the
+// mesh's vertexes, so only their indexes are new, and each level uses a grid half as fine as the one before.
+class MeshSimplifier
+{
+  public:
+    using Position = std::array<float, 3>;
+
+    struct Level
+    {
+        std::vector<uint32_t> indexes;
+        // Largest distance a vertex was moved, in the units of the positions.
+        float error;
+    };
+
+    // Cells along the longest side of the bounds for the finest grid tried.
+    static constexpr uint32_t kInitialCells = 64;
+    static constexpr size_t kMaxLevels = 4;
+    // A level is only kept when it has at most this fraction of the triangles of the previous one.
+    static constexpr float kMaxTriangleRatio = 0.75F;
+
+    // Levels coarser than the mesh given by indexes, coarsest last, with errors that never decrease. Empty when the
+    // mesh is too simple to reduce.
+    static std::vector<Level>
+    build_lods(std::span<const Position> positions, std::span<const uint32_t> indexes, size_t max_levels = kMaxLevels)
+    {
+        std::vector<Level> result;
+        if (indexes.size() < 3 || max_levels == 0)
+        {
+            return result;
+        }
+
+        Position min = positions[indexes[0]];
+        Position max = min;
+        for (const auto index : indexes)
+        {
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                min[axis] = std::min(min[axis], positions[index][axis]);
+                max[axis] = std::max(max[axis], positions[index][axis]);
+            }
+        }
+
+        const float extent = std::max({max[0] - min[0], max[1] - min[1], max[2] - min[2]});
+        if (!(extent > 0.0F))
+        {
+            return result;
+        }
+
+        size_t triangles = indexes.size() / 3;
+        for (uint32_t cells = kInitialCells; cells >= 2 && result.size() < max_levels; cells /= 2)
+        {
+            auto level = cluster(positions, indexes, min, extent / static_cast<float>(cells));
+            const size_t level_triangles = level.indexes.size() / 3;
+            if (level_triangles == 0)
+            {
+                break;
+            }
+
+            if (static_cast<float>(level_triangles) > static_cast<float>(triangles) * kMaxTriangleRatio)
+            {
+                continue;
+            }
+
+            if (!result.empty())
+            {
+                level.error = std::max(level.error, result.back().error);
+            }
+
+            triangles = level_triangles;
+            result.push_back(std::move(level));
+        }
+
+        return result;
+    }
+
+    // Snaps the vertexes used by indexes to a grid of cell_size starting at origin. Triangles keep their winding; those
+    // left with less than three distinct corners, or repeating another triangle, are dropped.
+    static Level cluster(std::span<const Position> positions,
+                         std::span<const uint32_t> indexes,
+                         const Position& origin,
+                         float cell_size)
+    {
+        std::unordered_map<uint64_t, uint32_t> cells;
+        std::unordered_map<uint32_t, uint32_t> snapped;
+        Level result = {.indexes = {}, .error = 0.0F};
+
+        const auto snap = [&](uint32_t index)
+        {
+            if (const auto found = snapped.find(index); found != snapped.end())
+            {
+                return found->second;
+            }
+
+            uint64_t key = 0;
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                const auto cell = static_cast<uint64_t>((positions[index][axis] - origin[axis]) / cell_size);
+                key |= std::min(cell, kMaxCell) << (axis * kCellBits);
+            }
+
+            const auto representative = cells.try_emplace(key, index).first->second;
+            float distance = 0.0F;
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                const float delta = positions[index][axis] - positions[representative][axis];
+                distance += delta * delta;
+            }
+            result.error = std::max(result.error, std::sqrt(distance));
+
+            snapped.emplace(index, representative);
+            return representative;
+        };
+
+        std::set<std::array<uint32_t, 3>> seen;
+        for (size_t i = 0; i + 2 < indexes.size(); i += 3)
+        {
+            std::array<uint32_t, 3> triangle = {snap(indexes[i]), snap(indexes[i + 1]), snap(indexes[i + 2])};
+            if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0])
+            {
+                continue;
+            }
+
+            // Rotated to start at the smallest index, which keeps the winding, to find repeats.
+            std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+            if (seen.insert(triangle).second)
+            {
+                result.indexes.insert(result.indexes.end(), triangle.begin(), triangle.end());
+            }
+        }
+
+        return result;
+    }
+
+  private:
+    static constexpr uint32_t kCellBits = 21;
+    static constexpr uint64_t kMaxCell = (uint64_t{1} << kCellBits) - 1;
+};
+} // namespace steeplejack
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace steeplejack
+{
+// The header Vulkan puts at the start of pipeline cache data (VkPipelineCacheHeaderVersionOne), and the identity of
+// the device the data must have been saved by. Drivers are meant to ignore data from another device, but not all do,
+// so saved data is checked before it is handed back to the driver.
+struct PipelineCacheHeader
+{
+    static constexpr size_t kSize = 32;
+    static constexpr uint32_t kVersionOne = 1;
+    static constexpr size_t kUuidSize = 16;
+
+    uint32_t vendor_id;
+    uint32_t device_id;
+    std::array<uint8_t, kUuidSize> uuid;
+
+    // Fields are in the host's byte order.
+    template <typename T> static T read(std::span<const std::byte> data, size_t offset)
+    {
+        T value;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        return value;
+    }
+
+    // True when data starts with a version one header written for this device. The header's own size may grow in
+    // later versions, so it need only be at least kSize and fit within data.
+    bool matches(std::span<const std::byte> data) const
+    {
+        if (data.size() < kSize)
+        {
+            return false;
+        }
+
+        const auto header_size = read<uint32_t>(data, 0);
+        if (header_size < kSize || header_size > data.size())
+        {
+            return false;
+        }
+
+        return read<uint32_t>(data, 4) == kVersionOne && read<uint32_t>(data, 8) == vendor_id &&
+            read<uint32_t>(data, 12) == device_id && std::memcmp(data.data() + 16, uuid.data(), kUuidSize) == 0;
+    }
+};
+} // namespace steeplejack
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace steeplejack
+{
+// Stable LSD radix sort on a 64-bit key, one byte per pass. Passes in which every key has the same digit are skipped,
+// so sparsely used key fields cost nothing. scratch is resized as needed and can be reused between calls.
+template <typename T, typename KeyFn> void radix_sort(std::vector<T>& items, std::vector<T>& scratch, KeyFn key)
+{
+    constexpr size_t kDigitBits = 8;
+    constexpr size_t kBuckets = size_t{1} << kDigitBits;
+    constexpr size_t kPasses = sizeof(uint64_t) * 8 / kDigitBits;
+
+    if (items.size() < 2)
+    {
+        return;
+    }
+
+    std::array<std::array<size_t, kBuckets>, kPasses> histograms{};
+    for (const auto& item : items)
+    {
+        const uint64_t item_key = key(item);
+        for (size_t pass = 0; pass < kPasses; pass++)
+        {
+            histograms[pass][(item_key >> (pass * kDigitBits)) & (kBuckets - 1)]++;
+        }
+    }
+
+    scratch.resize(items.size());
+
+    for (size_t pass = 0; pass < kPasses; pass++)
+    {
+        const size_t shift = pass * kDigitBits;
+        auto& histogram = histograms[pass];
+
+        if (histogram[(key(items.front()) >> shift) & (kBuckets - 1)] == items.size())
+        {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (auto& count : histogram)
+        {
+            const size_t bucket_count = count;
+            count = offset;
+            offset += bucket_count;
+        }
+
+        for (const auto& item : items)
+        {
+            scratch[histogram[(key(item) >> shift) & (kBuckets - 1)]++] = item;
+        }
+
+        items.swap(scratch);
+    }
+}
+} // namespace steeplejack
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace steeplejack
+{
+// Halves an 8-bit RGBA image in place with a 2x2 box filter. Odd edges repeat their last texel; a side of 1 stays 1.
+inline void downsample_rgba(std::vector<std::byte>& rgba, uint32_t& width, uint32_t& height)
+{
+    const uint32_t half_width = std::max(width / 2, 1U);
+    const uint32_t half_height = std::max(height / 2, 1U);
+
+    std::vector<std::byte> half(static_cast<size_t>(half_width) * half_height * 4U);
+    for (uint32_t y = 0; y < half_height; y++)
+    {
+        const uint32_t y0 = std::min(y * 2, height - 1);
+        const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+
+        for (uint32_t x = 0; x < half_width; x++)
+        {
+            const uint32_t x0 = std::min(x * 2, width - 1);
+            const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+
+            for (uint32_t channel = 0; channel < 4; channel++)
+            {
+                const auto texel = [&](uint32_t tx, uint32_t ty)
+                { return std::to_integer<uint32_t>(rgba[(static_cast<size_t>(ty) * width + tx) * 4U + channel]); };
+
+                const uint32_t sum = texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1);
+                half[(static_cast<size_t>(y) * half_width + x) * 4U + channel] = static_cast<std::byte>((sum + 2) / 4);
+            }
+        }
+    }
+
+    rgba = std::move(half);
+    width = half_width;
+    height = half_height;
+}
+} // namespace steeplejack
@@ -0,0 +1,167 @@
+#include "shader_compiler.h"
+
+#include "shader_source.h"
+#include "spdlog/spdlog.h"
+
+#include <format>
+#include <fstream>
+#include <functional>
+#include <glslang/Public/ResourceLimits.h>
+#include <glslang/Public/ShaderLang.h>
+#include <glslang/SPIRV/GlslangToSpv.h>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+using namespace steeplejack;
+
+namespace
+{
+constexpr int kGlslVersion = 450;
+
+std::filesystem::path existing_directory(std::filesystem::path path)
+{
+    std::error_code error;
+    return std::filesystem::is_directory(path, error) ? std::move(path) : std::filesystem::path();
+}
+} // namespace
+
+ShaderCompiler::ShaderCompiler(const AssetReader& assets,
+                               std::filesystem::path source_directory,
+                               std::filesystem::path cache_directory) :
+    m_assets(assets),
+    m_source_directory(existing_directory(std::move(source_directory))),
+    m_cache_directory(std::move(cache_directory))
+{
+    glslang::InitializeProcess();
+
+    if (!m_source_directory.empty())
+    {
+        spdlog::info("Compiling shaders from {}", m_source_directory.generic_string());
+    }
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+    glslang::FinalizeProcess();
+}
+
+SpirvCode ShaderCompiler::load(const std::string& name) const
+{
+    if (!m_source_directory.empty())
+    {
+        const auto path = m_source_directory / ShaderSource::file_name(name);
+        if (std::filesystem::exists(path))
+        {
+            return load_source(name, path);
+        }
+    }
+
+    return SpirvCode(m_assets.read("shaders/" + name + ".spv"));
+}
+
+SpirvCode ShaderCompiler::load_source(const std::string& name, const std::filesystem::path& path) const
+{
+    const auto source = read_text(path);
+
+    // The name goes into the key too, as it decides the stage.
+    const auto key = ShaderSource::hash(name + '\n' + source, kCompilerVersion);
+    const auto cache_path = m_cache_directory / std::format("{:016x}.spv", key);
+
+    std::error_code error;
+    if (std::filesystem::exists(cache_path, error))
+    {
+        return SpirvCode(std::make_unique<MappedFile>(cache_path));
+    }
+
+    auto spirv = compile(name, source);
+
+    try
+    {
+        std::filesystem::create_directories(m_cache_directory);
+        write_spirv(cache_path, spirv);
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::warn("Shader {} not cached: {}", name, e.what());
+    }
+
+    return SpirvCode(std::move(spirv));
+}
+
+std::vector<uint32_t> ShaderCompiler::compile(const std::string& name, const std::string& source) const
+{
+    spdlog::info("Compiling shader {}", name);
+
+    const auto stage = ShaderSource::stage(name);
+    if (!stage)
+    {
+        throw std::runtime_error("Failed to compile shader " + name + ": unknown stage");
+    }
+
+    const auto language = *stage == ShaderSource::Stage::kVertex ? EShLangVertex : EShLangFragment;
+    const auto messages = static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules);
+
+    std::scoped_lock lock(m_compile_mutex);
+
+    const char* text = source.c_str();
+    const char* file_name = name.c_str();
+
+    glslang::TShader shader(language);
+    shader.setStringsWithLengthsAndNames(&text, nullptr, &file_name, 1);
+    shader.setEnvInput(glslang::EShSourceGlsl, language, glslang::EShClientVulkan, 100);
+    shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_3);
+    shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_6);
+
+    if (!shader.parse(GetDefaultResources(), kGlslVersion, false, messages))
+    {
+        throw std::runtime_error("Failed to compile shader " + name + ":\n" + shader.getInfoLog());
+    }
+
+    glslang::TProgram program;
+    program.addShader(&shader);
+    if (!program.link(messages))
+    {
+        throw std::runtime_error("Failed to link shader " + name + ":\n" + program.getInfoLog());
+    }
+
+    std::vector<uint32_t> spirv;
+    glslang::GlslangToSpv(*program.getIntermediate(language), spirv);
+
+    return spirv;
+}
+
+std::string ShaderCompiler::read_text(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open file: " + path.generic_string());
+    }
+
+    std::ostringstream text;
+    text << file.rdbuf();
+
+    return text.str();
+}
+
+// Written aside and moved into place, so that a compile on another thread never reads half a file.
+void ShaderCompiler::write_spirv(const std::filesystem::path& path, const std::vector<uint32_t>& spirv)
+{
+    auto temporary = path;
+    temporary += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(spirv.data()),
+                   static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write file: " + temporary.generic_string());
+        }
+    }
+
+    std::filesystem::rename(temporary, path);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "asset_reader.h"
+#include "no_copy_or_move.h"
+#include "spirv_code.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace steeplejack
+{
+// Turns shader names such as mesh.frag into SPIR-V. When the GLSL source shader.mesh.frag is in the source directory
+// it is compiled with glslang, and the result is cached under a hash of the source so that an unchanged shader is not
+// compiled again, in this run or the next. Otherwise the SPIR-V compiled by the build, shaders/mesh.frag.spv, is read
+// from the assets. Cached and packed SPIR-V is memory mapped rather than read. Safe to use from several threads at
+// once.
+class ShaderCompiler : NoCopyOrMove
+{
+  public:
+    static constexpr const char* kDefaultCache = ".shader_cache";
+
+  private:
+    // Part of every cache key: bump it when the compile options change.
+    static constexpr uint64_t kCompilerVersion = 1;
+
+    const AssetReader& m_assets;
+    const std::filesystem::path m_source_directory;
+    const std::filesystem::path m_cache_directory;
+
+    // glslang is only compiled with from one thread at a time; it keeps global state.
+    mutable std::mutex m_compile_mutex;
+
+    SpirvCode load_source(const std::string& name, const std::filesystem::path& path) const;
+    std::vector<uint32_t> compile(const std::string& name, const std::string& source) const;
+
+    static std::string read_text(const std::filesystem::path& path);
+    static void write_spirv(const std::filesystem::path& path, const std::vector<uint32_t>& spirv);
+
+  public:
+    // With an empty source_directory, or one that does not exist, only the built SPIR-V is used.
+    ShaderCompiler(const AssetReader& assets,
+                   std::filesystem::path source_directory = {},
+                   std::filesystem::path cache_directory = kDefaultCache);
+    ~ShaderCompiler();
+
+    // Directory the sources are compiled from, or empty when there is none.
+    const std::filesystem::path& source_directory() const
+    {
+        return m_source_directory;
+    }
+
+    SpirvCode load(const std::string& name) const;
+};
+} // namespace steeplejack
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace steeplejack
+{
+// Names of GLSL shader sources. The source shader.<name>, such as shader.mesh.frag, compiles to the shader <name>,
+// whose stage is given by its extension; the build turns it into <name>.spv.
+struct ShaderSource
+{
+    enum class Stage
+    {
+        kVertex,
+        kFragment,
+    };
+
+    static constexpr std::string_view kPrefix = "shader.";
+
+    static std::string file_name(std::string_view name)
+    {
+        return std::string(kPrefix) + std::string(name);
+    }
+
+    // The shader compiled from file_name, or nothing when it is not a shader source.
+    static std::optional<std::string> shader_name(std::string_view file_name)
+    {
+        if (!file_name.starts_with(kPrefix))
+        {
+            return std::nullopt;
+        }
+
+        auto name = file_name.substr(kPrefix.size());
+        if (!stage(name))
+        {
+            return std::nullopt;
+        }
+
+        return std::string(name);
+    }
+
+    static std::optional<Stage> stage(std::string_view name)
+    {
+        if (name.ends_with(".vert"))
+        {
+            return Stage::kVertex;
+        }
+        if (name.ends_with(".frag"))
+        {
+            return Stage::kFragment;
+        }
+
+        return std::nullopt;
+    }
+
+    // 64-bit FNV-1a, which names compiled sources in the shader cache.
+    static uint64_t hash(std::string_view text, uint64_t seed)
+    {
+        uint64_t result = 0xcbf29ce484222325ULL ^ seed;
+        for (auto character : text)
+        {
+            result = (result ^ static_cast<uint8_t>(character)) * 0x100000001b3ULL;
+        }
+
+        return result;
+    }
+};
+} // namespace steeplejack
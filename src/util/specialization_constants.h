@@ -0,0 +1,69 @@
+#pragma once
+
+#include "hash.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace steeplejack
+{
+// Values of a pipeline's specialization constants by their constant_id. GLSL's bool, int, uint and float constants
+// are all 32 bits, so each value is one word; bools are 0 or 1, as VkBool32 is. A constant that is not set keeps the
+// default written in the shader.
+class SpecializationConstants
+{
+  private:
+    std::map<uint32_t, uint32_t> m_values;
+
+  public:
+    SpecializationConstants& set(uint32_t id, bool value)
+    {
+        m_values[id] = value ? 1U : 0U;
+        return *this;
+    }
+
+    SpecializationConstants& set(uint32_t id, uint32_t value)
+    {
+        m_values[id] = value;
+        return *this;
+    }
+
+    SpecializationConstants& set(uint32_t id, int32_t value)
+    {
+        m_values[id] = std::bit_cast<uint32_t>(value);
+        return *this;
+    }
+
+    SpecializationConstants& set(uint32_t id, float value)
+    {
+        m_values[id] = std::bit_cast<uint32_t>(value);
+        return *this;
+    }
+
+    // Words by constant id, in increasing id order.
+    const std::map<uint32_t, uint32_t>& values() const
+    {
+        return m_values;
+    }
+
+    bool empty() const
+    {
+        return m_values.empty();
+    }
+
+    size_t hash() const
+    {
+        size_t result = 0;
+        for (const auto& [id, value] : m_values)
+        {
+            hash_combine(result, (static_cast<uint64_t>(id) << 32U) | value);
+        }
+
+        return result;
+    }
+
+    bool operator==(const SpecializationConstants& other) const = default;
+};
+} // namespace steeplejack
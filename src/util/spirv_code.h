@@ -0,0 +1,97 @@
+#pragma once
+
+#include "asset_reader.h"
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace steeplejack
+{
+// The words of a SPIR-V module, used in place wherever they already are: a memory mapped file, which is page aligned,
+// or an asset that happens to be 4 byte aligned. Only an unaligned asset is copied. Movable, as Asset is, but not
+// copyable.
+class SpirvCode
+{
+  private:
+    std::unique_ptr<MappedFile> m_file;
+    Asset m_asset;
+    std::vector<uint32_t> m_storage;
+    std::span<const uint32_t> m_words;
+
+    static std::span<const uint32_t> as_words(std::span<const std::byte> bytes)
+    {
+        if (bytes.size() % sizeof(uint32_t) != 0)
+        {
+            throw std::runtime_error("Failed to read SPIR-V: size is not a multiple of 4");
+        }
+
+        return {reinterpret_cast<const uint32_t*>(bytes.data()), bytes.size() / sizeof(uint32_t)};
+    }
+
+    static bool aligned(std::span<const std::byte> bytes)
+    {
+        return reinterpret_cast<uintptr_t>(bytes.data()) % alignof(uint32_t) == 0;
+    }
+
+  public:
+    SpirvCode() = default;
+
+    explicit SpirvCode(std::vector<uint32_t> words) : m_storage(std::move(words)), m_words(m_storage) {}
+
+    explicit SpirvCode(std::unique_ptr<MappedFile> file) : m_file(std::move(file)), m_words(as_words(m_file->bytes()))
+    {
+    }
+
+    explicit SpirvCode(Asset asset)
+    {
+        if (aligned(asset.view()))
+        {
+            m_words = as_words(asset.view());
+            m_asset = std::move(asset);
+            return;
+        }
+
+        m_storage.resize(as_words(asset.view()).size());
+        std::memcpy(m_storage.data(), asset.view().data(), asset.size());
+        m_words = m_storage;
+    }
+
+    // Moving a vector or an Asset keeps the memory it points at, so the words stay valid; a copy would not.
+    SpirvCode(const SpirvCode&) = delete;
+    SpirvCode& operator=(const SpirvCode&) = delete;
+    SpirvCode(SpirvCode&&) noexcept = default;
+    SpirvCode& operator=(SpirvCode&&) noexcept = default;
+
+    std::span<const uint32_t> words() const
+    {
+        return m_words;
+    }
+
+    size_t size_bytes() const
+    {
+        return m_words.size_bytes();
+    }
+
+    // 64-bit FNV-1a of the words, which tells versions of a shader apart.
+    uint64_t hash() const
+    {
+        uint64_t result = 0xcbf29ce484222325ULL;
+        for (auto word : m_words)
+        {
+            for (uint32_t shift = 0; shift < 32; shift += 8)
+            {
+                result = (result ^ ((word >> shift) & 0xffU)) * 0x100000001b3ULL;
+            }
+        }
+
+        return result;
+    }
+};
+} // namespace steeplejack
@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace steeplejack
+{
+// The interface of a SPIR-V shader as the pipeline layout and vertex input state see it: the descriptors it binds,
+// the size of its push constant block and the locations of its inputs. Only the declarations are read, so a resource
+// that is declared but never used is still reported.
+struct SpirvReflection
+{
+    enum class Stage
+    {
+        kVertex,
+        kFragment,
+        kOther,
+    };
+
+    enum class DescriptorType
+    {
+        kUniformBuffer,
+        kStorageBuffer,
+        kCombinedImageSampler,
+        kSampledImage,
+        kStorageImage,
+        kSampler,
+    };
+
+    struct Binding
+    {
+        uint32_t set;
+        uint32_t binding;
+        DescriptorType type;
+        // Array length, or 0 for a runtime sized array.
+        uint32_t count;
+
+        bool operator==(const Binding& other) const = default;
+    };
+
+    static constexpr uint32_t kMagic = 0x07230203;
+    static constexpr size_t kHeaderWords = 5;
+
+    Stage stage = Stage::kOther;
+    // Sorted by set and then binding.
+    std::vector<Binding> bindings;
+    uint32_t push_constant_size = 0;
+    // Locations of the stage inputs other than built-ins, sorted.
+    std::vector<uint32_t> input_locations;
+
+    static SpirvReflection parse(std::span<const uint32_t> code)
+    {
+        if (code.size() < kHeaderWords || code[0] != kMagic)
+        {
+            throw std::runtime_error("Failed to reflect SPIR-V: not a SPIR-V module");
+        }
+
+        Module module;
+        for (size_t offset = kHeaderWords; offset < code.size();)
+        {
+            const auto word_count = code[offset] >> 16U;
+            if (word_count == 0 || offset + word_count > code.size())
+            {
+                throw std::runtime_error("Failed to reflect SPIR-V: truncated instruction");
+            }
+
+            module.add(code[offset] & 0xffffU, code.subspan(offset + 1, word_count - 1));
+            offset += word_count;
+        }
+
+        return module.reflect();
+    }
+
+  private:
+    // Opcodes, decorations, storage classes and execution models used, from the SPIR-V specification.
+    enum Op : uint32_t
+    {
+        kOpEntryPoint = 15,
+        kOpTypeInt = 21,
+        kOpTypeFloat = 22,
+        kOpTypeVector = 23,
+        kOpTypeMatrix = 24,
+        kOpTypeImage = 25,
+        kOpTypeSampler = 26,
+        kOpTypeSampledImage = 27,
+        kOpTypeArray = 28,
+        kOpTypeRuntimeArray = 29,
+        kOpTypeStruct = 30,
+        kOpTypePointer = 32,
+        kOpConstant = 43,
+        kOpSpecConstantTrue = 48,
+        kOpSpecConstantFalse = 49,
+        kOpSpecConstant = 50,
+        kOpSpecConstantComposite = 51,
+        kOpSpecConstantOp = 52,
+        kOpVariable = 59,
+        kOpDecorate = 71,
+        kOpMemberDecorate = 72,
+    };
+
+    enum Decoration : uint32_t
+    {
+        kBlock = 2,
+        kBufferBlock = 3,
+        kArrayStride = 6,
+        kMatrixStride = 7,
+        kBuiltIn = 11,
+        kLocation = 30,
+        kBinding = 33,
+        kDescriptorSet = 34,
+        kOffset = 35,
+    };
+
+    enum StorageClass : uint32_t
+    {
+        kUniformConstant = 0,
+        kInput = 1,
+        kUniform = 2,
+        kPushConstant = 9,
+        kStorageBuffer = 12,
+    };
+
+    enum ExecutionModel : uint32_t
+    {
+        kVertexModel = 0,
+        kFragmentModel = 4,
+    };
+
+    class Module
+    {
+      private:
+        uint32_t m_execution_model = ~0U;
+        // Type declarations by result id, as their opcode followed by their operands without the result id.
+        std::unordered_map<uint32_t, std::vector<uint32_t>> m_types;
+        std::unordered_map<uint32_t, uint32_t> m_constants;
+        std::unordered_set<uint32_t> m_spec_constants;
+        std::unordered_map<uint32_t, std::map<uint32_t, uint32_t>> m_decorations;
+        std::map<std::pair<uint32_t, uint32_t>, std::map<uint32_t, uint32_t>> m_member_decorations;
+        // Variables as their result id, pointer type id and storage class.
+        std::vector<std::array<uint32_t, 3>> m_variables;
+
+        std::optional<uint32_t> decoration(uint32_t id, uint32_t decoration) const
+        {
+            const auto decorations = m_decorations.find(id);
+            if (decorations == m_decorations.end() || !decorations->second.contains(decoration))
+            {
+                return std::nullopt;
+            }
+
+            return decorations->second.at(decoration);
+        }
+
+        std::optional<uint32_t> member_decoration(uint32_t id, uint32_t member, uint32_t decoration) const
+        {
+            const auto decorations = m_member_decorations.find({id, member});
+            if (decorations == m_member_decorations.end() || !decorations->second.contains(decoration))
+            {
+                return std::nullopt;
+            }
+
+            return decorations->second.at(decoration);
+        }
+
+        // Array lengths must be plain constants: a specialization constant is only known once a pipeline is created,
+        // after the layout has been built from the reflection.
+        uint32_t array_length(uint32_t id) const
+        {
+            if (const auto constant = m_constants.find(id); constant != m_constants.end())
+            {
+                return constant->second;
+            }
+
+            if (m_spec_constants.contains(id))
+            {
+                throw std::runtime_error("Failed to reflect SPIR-V: array length " + std::to_string(id) +
+                                         " is a specialization constant");
+            }
+
+            throw std::runtime_error("Failed to reflect SPIR-V: array length " + std::to_string(id) +
+                                     " is not a constant");
+        }
+
+        const std::vector<uint32_t>& type(uint32_t id) const
+        {
+            const auto type = m_types.find(id);
+            if (type == m_types.end() || type->second.empty())
+            {
+                throw std::runtime_error("Failed to reflect SPIR-V: undeclared type " + std::to_string(id));
+            }
+
+            return type->second;
+        }
+
+        // Size in bytes of a type laid out with explicit offsets and strides, as push constant blocks are.
+        uint32_t size_of(uint32_t id, uint32_t matrix_stride = 0) const
+        {
+            const auto& type = this->type(id);
+            switch (type[0])
+            {
+            case kOpTypeInt:
+            case kOpTypeFloat:
+                return type[1] / 8;
+            case kOpTypeVector:
+                return type[2] * size_of(type[1]);
+            case kOpTypeMatrix:
+                return type[2] * (matrix_stride != 0 ? matrix_stride : size_of(type[1]));
+            case kOpTypeArray:
+                return array_length(type[2]) * decoration(id, kArrayStride).value_or(size_of(type[1]));
+            case kOpTypeStruct:
+            {
+                uint32_t size = 0;
+                for (uint32_t member = 0; member + 1 < type.size(); member++)
+                {
+                    const auto offset = member_decoration(id, member, kOffset).value_or(0);
+                    const auto stride = member_decoration(id, member, kMatrixStride).value_or(0);
+                    size = std::max(size, offset + size_of(type[member + 1], stride));
+                }
+                return size;
+            }
+            default:
+                return 0;
+            }
+        }
+
+        Binding binding(uint32_t variable, uint32_t storage_class, uint32_t type_id) const
+        {
+            Binding result = {
+                .set = decoration(variable, kDescriptorSet).value_or(0),
+                .binding = decoration(variable, kBinding).value_or(0),
+                .type = DescriptorType::kUniformBuffer,
+                .count = 1,
+            };
+
+            auto type = &this->type(type_id);
+            if ((*type)[0] == kOpTypeArray)
+            {
+                result.count = array_length((*type)[2]);
+                type_id = (*type)[1];
+                type = &this->type(type_id);
+            }
+            else if ((*type)[0] == kOpTypeRuntimeArray)
+            {
+                result.count = 0;
+                type_id = (*type)[1];
+                type = &this->type(type_id);
+            }
+
+            if (storage_class == kStorageBuffer ||
+                (storage_class == kUniform && decoration(type_id, kBufferBlock).has_value()))
+            {
+                result.type = DescriptorType::kStorageBuffer;
+            }
+            else if (storage_class == kUniform)
+            {
+                result.type = DescriptorType::kUniformBuffer;
+            }
+            else if ((*type)[0] == kOpTypeSampledImage)
+            {
+                result.type = DescriptorType::kCombinedImageSampler;
+            }
+            else if ((*type)[0] == kOpTypeSampler)
+            {
+                result.type = DescriptorType::kSampler;
+            }
+            else if ((*type)[0] == kOpTypeImage)
+            {
+                // The Sampled operand is 2 for images read and written without a sampler.
+                result.type = (*type)[6] == 2 ? DescriptorType::kStorageImage : DescriptorType::kSampledImage;
+            }
+            else
+            {
+                throw std::runtime_error("Failed to reflect SPIR-V: unsupported descriptor type");
+            }
+
+            return result;
+        }
+
+      public:
+        void add(uint32_t opcode, std::span<const uint32_t> operands)
+        {
+            switch (opcode)
+            {
+            case kOpEntryPoint:
+                m_execution_model = operands[0];
+                break;
+            case kOpTypeInt:
+            case kOpTypeFloat:
+            case kOpTypeVector:
+            case kOpTypeMatrix:
+            case kOpTypeImage:
+            case kOpTypeSampler:
+            case kOpTypeSampledImage:
+            case kOpTypeArray:
+            case kOpTypeRuntimeArray:
+            case kOpTypeStruct:
+            case kOpTypePointer:
+            {
+                auto& type = m_types[operands[0]];
+                type.push_back(opcode);
+                type.insert(type.end(), operands.begin() + 1, operands.end());
+                break;
+            }
+            case kOpConstant:
+                m_constants[operands[1]] = operands[2];
+                break;
+            case kOpSpecConstantTrue:
+            case kOpSpecConstantFalse:
+            case kOpSpecConstant:
+            case kOpSpecConstantComposite:
+            case kOpSpecConstantOp:
+                m_spec_constants.insert(operands[1]);
+                break;
+            case kOpVariable:
+                m_variables.push_back({operands[1], operands[0], operands[2]});
+                break;
+            case kOpDecorate:
+                m_decorations[operands[0]][operands[1]] = operands.size() > 2 ? operands[2] : 0;
+                break;
+            case kOpMemberDecorate:
+                m_member_decorations[{operands[0], operands[1]}][operands[2]] = operands.size() > 3 ? operands[3] : 0;
+                break;
+            default:
+                break;
+            }
+        }
+
+        SpirvReflection reflect() const
+        {
+            SpirvReflection result;
+            switch (m_execution_model)
+            {
+            case kVertexModel:
+                result.stage = Stage::kVertex;
+                break;
+            case kFragmentModel:
+                result.stage = Stage::kFragment;
+                break;
+            default:
+                result.stage = Stage::kOther;
+                break;
+            }
+
+            for (const auto& [variable, pointer, storage_class] : m_variables)
+            {
+                const auto type_id = type(pointer)[2];
+                switch (storage_class)
+                {
+                case kUniformConstant:
+                case kUniform:
+                case kStorageBuffer:
+                    result.bindings.push_back(binding(variable, storage_class, type_id));
+                    break;
+                case kPushConstant:
+                    result.push_constant_size = std::max(result.push_constant_size, size_of(type_id));
+                    break;
+                case kInput:
+                    if (!decoration(variable, kBuiltIn).has_value())
+                    {
+                        const auto location = decoration(variable, kLocation);
+                        if (!location.has_value())
+                        {
+                            throw std::runtime_error("Failed to reflect SPIR-V: input without a location");
+                        }
+                        result.input_locations.push_back(*location);
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            std::ranges::sort(result.bindings,
+                              [](const Binding& a, const Binding& b)
+                              { return std::pair(a.set, a.binding) < std::pair(b.set, b.binding); });
+            std::ranges::sort(result.input_locations);
+
+            return result;
+        }
+    };
+};
+} // namespace steeplejack
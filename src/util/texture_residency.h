@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace steeplejack
+{
+// Decides which mip levels of streamed textures are resident. Every frame each texture in view is requested at the
+// level its on-screen size needs; update then raises textures to what they need and, while the total goes over the
+// budget, drops the finest levels of the least recently used textures first. Levels are numbered as in the full mip
+// chain, 0 being the finest, and a texture resident at level n holds level n and every coarser one.
+template <typename TKey> class TextureResidency
+{
+  public:
+    struct Change
+    {
+        TKey key;
+        uint32_t level;
+    };
+
+  private:
+    struct Entry
+    {
+        std::vector<uint64_t> level_bytes;
+        uint32_t resident;
+        uint32_t requested;
+        uint64_t last_used;
+        uint32_t target;
+    };
+
+    uint64_t m_budget;
+    uint64_t m_frame = 1;
+    std::unordered_map<TKey, Entry> m_entries;
+
+    static uint64_t bytes_from(const Entry& entry, uint32_t level)
+    {
+        uint64_t bytes = 0;
+        for (auto it = entry.level_bytes.begin() + level; it != entry.level_bytes.end(); ++it)
+        {
+            bytes += *it;
+        }
+
+        return bytes;
+    }
+
+    static uint32_t coarsest(const Entry& entry)
+    {
+        return static_cast<uint32_t>(entry.level_bytes.size()) - 1;
+    }
+
+  public:
+    explicit TextureResidency(uint64_t budget) : m_budget(budget) {}
+
+    // Finest level worth keeping for a texture size texels across at level 0 that covers screen_size pixels.
+    static uint32_t required_level(uint32_t size, float screen_size, uint32_t mip_levels)
+    {
+        if (!(screen_size > 0.0F))
+        {
+            return mip_levels - 1;
+        }
+
+        const float ratio = static_cast<float>(size) / screen_size;
+        if (ratio <= 1.0F)
+        {
+            return 0;
+        }
+
+        return std::min(static_cast<uint32_t>(std::log2(ratio)), mip_levels - 1);
+    }
+
+    uint64_t budget() const
+    {
+        return m_budget;
+    }
+
+    void set_budget(uint64_t budget)
+    {
+        m_budget = budget;
+    }
+
+    uint64_t resident_bytes() const
+    {
+        uint64_t bytes = 0;
+        for (const auto& [key, entry] : m_entries)
+        {
+            bytes += bytes_from(entry, entry.resident);
+        }
+
+        return bytes;
+    }
+
+    // level_bytes holds the size of every level of the full chain, finest first.
+    void add(const TKey& key, std::vector<uint64_t> level_bytes, uint32_t resident)
+    {
+        const auto levels = static_cast<uint32_t>(level_bytes.size());
+        m_entries[key] = {
+            .level_bytes = std::move(level_bytes),
+            .resident = resident,
+            .requested = levels - 1,
+            .last_used = 0,
+            .target = resident,
+        };
+    }
+
+    void remove(const TKey& key)
+    {
+        m_entries.erase(key);
+    }
+
+    bool contains(const TKey& key) const
+    {
+        return m_entries.contains(key);
+    }
+
+    uint32_t resident_level(const TKey& key) const
+    {
+        return m_entries.at(key).resident;
+    }
+
+    // May be called several times a frame for the same texture; the finest request wins.
+    void request(const TKey& key, uint32_t level)
+    {
+        auto& entry = m_entries.at(key);
+        level = std::min(level, coarsest(entry));
+
+        if (entry.last_used != m_frame)
+        {
+            entry.last_used = m_frame;
+            entry.requested = level;
+        }
+        else
+        {
+            entry.requested = std::min(entry.requested, level);
+        }
+    }
+
+    // Ends the frame and returns the textures whose resident level changed. Textures keep finer levels than they need
+    // for as long as the budget allows, so that they are not streamed again when they come back into view.
+    std::vector<Change> update()
+    {
+        std::vector<Entry*> order;
+        uint64_t total = 0;
+        for (auto& [key, entry] : m_entries)
+        {
+            entry.target = entry.last_used == m_frame ? std::min(entry.resident, entry.requested) : entry.resident;
+            total += bytes_from(entry, entry.target);
+            order.push_back(&entry);
+        }
+
+        if (total > m_budget)
+        {
+            std::ranges::stable_sort(order,
+                                     [](const Entry* lhs, const Entry* rhs) { return lhs->last_used < rhs->last_used; });
+
+            // First give up levels nobody asked for this frame, least recently used first.
+            for (auto* entry : order)
+            {
+                const auto floor = entry->last_used == m_frame ? entry->requested : coarsest(*entry);
+                while (total > m_budget && entry->target < floor)
+                {
+                    total -= entry->level_bytes[entry->target];
+                    entry->target++;
+                }
+            }
+
+            // Then degrade what is in view, one level at a time so that the loss is spread across textures.
+            bool dropped = true;
+            while (total > m_budget && dropped)
+            {
+                dropped = false;
+                for (auto* entry : order)
+                {
+                    if (total <= m_budget)
+                    {
+                        break;
+                    }
+
+                    if (entry->target < coarsest(*entry))
+                    {
+                        total -= entry->level_bytes[entry->target];
+                        entry->target++;
+                        dropped = true;
+                    }
+                }
+            }
+        }
+
+        std::vector<Change> changes;
+        for (auto& [key, entry] : m_entries)
+        {
+            if (entry.target != entry.resident)
+            {
+                changes.push_back({.key = key, .level = entry.target});
+                entry.resident = entry.target;
+            }
+        }
+
+        m_frame++;
+
+        return changes;
+    }
+};
+} // namespace steeplejack
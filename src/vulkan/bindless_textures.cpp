@@ -0,0 +1,149 @@
+#include "bindless_textures.h"
+
+#include "spdlog/spdlog.h"
+
+#include <stdexcept>
+
+using namespace steeplejack;
+
+BindlessTextures::BindlessTextures(const Device& device) :
+    m_device(device),
+    m_descriptor_set_layout(create_descriptor_set_layout()),
+    m_descriptor_pool(create_descriptor_pool()),
+    m_descriptor_set(create_descriptor_set())
+{
+}
+
+BindlessTextures::~BindlessTextures()
+{
+    spdlog::info("Destroying Bindless Textures");
+    vkDestroyDescriptorPool(m_device, m_descriptor_pool, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_descriptor_set_layout, nullptr);
+}
+
+VkDescriptorSetLayout BindlessTextures::create_descriptor_set_layout()
+{
+    spdlog::info("Creating Bindless Texture Descriptor Set Layout");
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = kMaxTextures;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    binding.pImmutableSamplers = nullptr;
+
+    // Slots are written as textures come and go, including while frames that never touch those slots are in flight.
+    VkDescriptorBindingFlags binding_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {};
+    binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    binding_flags_info.bindingCount = 1;
+    binding_flags_info.pBindingFlags = &binding_flags;
+
+    VkDescriptorSetLayoutCreateInfo layout_info = {};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.pNext = &binding_flags_info;
+    layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layout_info.bindingCount = 1;
+    layout_info.pBindings = &binding;
+
+    VkDescriptorSetLayout layout = nullptr;
+    if (vkCreateDescriptorSetLayout(m_device, &layout_info, nullptr, &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create bindless texture descriptor set layout");
+    }
+
+    return layout;
+}
+
+VkDescriptorPool BindlessTextures::create_descriptor_pool()
+{
+    VkDescriptorPoolSize pool_size = {};
+    pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_size.descriptorCount = kMaxTextures;
+
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+
+    VkDescriptorPool pool = nullptr;
+    if (vkCreateDescriptorPool(m_device, &pool_info, nullptr, &pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create bindless texture descriptor pool");
+    }
+
+    return pool;
+}
+
+VkDescriptorSet BindlessTextures::create_descriptor_set()
+{
+    VkDescriptorSetAllocateInfo allocate_info = {};
+    allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocate_info.descriptorPool = m_descriptor_pool;
+    allocate_info.descriptorSetCount = 1;
+    allocate_info.pSetLayouts = &m_descriptor_set_layout;
+
+    VkDescriptorSet descriptor_set = nullptr;
+    if (vkAllocateDescriptorSets(m_device, &allocate_info, &descriptor_set) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate bindless texture descriptor set");
+    }
+
+    return descriptor_set;
+}
+
+uint32_t BindlessTextures::add(const VkDescriptorImageInfo& image_info)
+{
+    uint32_t index = 0;
+    if (!m_free_indexes.empty())
+    {
+        index = m_free_indexes.back();
+        m_free_indexes.pop_back();
+    }
+    else if (m_next_index < kMaxTextures)
+    {
+        index = m_next_index++;
+    }
+    else
+    {
+        throw std::runtime_error("Failed to add bindless texture: all slots are in use");
+    }
+
+    update(index, image_info);
+
+    return index;
+}
+
+void BindlessTextures::update(uint32_t index, const VkDescriptorImageInfo& image_info) const
+{
+    VkWriteDescriptorSet write_descriptor_set = {};
+    write_descriptor_set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write_descriptor_set.dstSet = m_descriptor_set;
+    write_descriptor_set.dstBinding = 0;
+    write_descriptor_set.dstArrayElement = index;
+    write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write_descriptor_set.descriptorCount = 1;
+    write_descriptor_set.pImageInfo = &image_info;
+
+    vkUpdateDescriptorSets(m_device, 1, &write_descriptor_set, 0, nullptr);
+}
+
+void BindlessTextures::remove(uint32_t index)
+{
+    m_retired.push_back({.frame = m_frame, .index = index});
+}
+
+// Once max_frames_in_flight more frames have been waited on, no submitted frame can still sample a retired slot.
+void BindlessTextures::release_retired()
+{
+    m_frame++;
+    while (!m_retired.empty() && m_retired.front().frame + Device::max_frames_in_flight <= m_frame)
+    {
+        m_free_indexes.push_back(m_retired.front().index);
+        m_retired.pop_front();
+    }
+}
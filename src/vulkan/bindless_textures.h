@@ -0,0 +1,74 @@
+#pragma once
+
+#include "device.h"
+#include "util/no_copy_or_move.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// One large descriptor array of combined image samplers, bound once per frame as descriptor set 1. Textures claim a
+// stable slot when they are created and shaders select the texture by slot index. A removed slot is only handed out
+// again once the frames in flight that may still sample it are done.
+class BindlessTextures : NoCopyOrMove
+{
+  public:
+    static constexpr uint32_t kMaxTextures = 4096;
+    static constexpr uint32_t kNoTexture = 0xFFFFFFFF;
+    static constexpr uint32_t kDescriptorSetIndex = 1;
+
+  private:
+    struct Retired
+    {
+        uint64_t frame;
+        uint32_t index;
+    };
+
+    const Device& m_device;
+
+    const VkDescriptorSetLayout m_descriptor_set_layout;
+    const VkDescriptorPool m_descriptor_pool;
+    const VkDescriptorSet m_descriptor_set;
+
+    uint32_t m_next_index = 0;
+    std::vector<uint32_t> m_free_indexes;
+    std::deque<Retired> m_retired;
+    uint64_t m_frame = 0;
+
+    VkDescriptorSetLayout create_descriptor_set_layout();
+    VkDescriptorPool create_descriptor_pool();
+    VkDescriptorSet create_descriptor_set();
+
+  public:
+    BindlessTextures(const Device& device);
+    ~BindlessTextures();
+
+    VkDescriptorSetLayout layout() const
+    {
+        return m_descriptor_set_layout;
+    }
+
+    uint32_t add(const VkDescriptorImageInfo& image_info);
+    void update(uint32_t index, const VkDescriptorImageInfo& image_info) const;
+    void remove(uint32_t index);
+
+    // Frees the slots removed long enough ago. Called once per frame on the render thread, after the frame's fence has
+    // been waited on.
+    void release_retired();
+
+    void bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout) const
+    {
+        vkCmdBindDescriptorSets(command_buffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                pipeline_layout,
+                                kDescriptorSetIndex,
+                                1,
+                                &m_descriptor_set,
+                                0,
+                                nullptr);
+    }
+};
+} // namespace steeplejack
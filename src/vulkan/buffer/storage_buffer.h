@@ -0,0 +1,60 @@
+#pragma once
+
+#include "buffer_host.h"
+#include "util/no_copy_or_move.h"
+#include "vulkan/device.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+namespace steeplejack
+{
+class StorageBuffer : NoCopyOrMove
+{
+  private:
+    typedef std::array<std::unique_ptr<BufferHost>, Device::max_frames_in_flight> buffers_t;
+
+    const Device& m_device;
+
+    buffers_t m_buffers;
+
+    buffers_t create_buffers(VkDeviceSize size)
+    {
+        buffers_t buffers;
+        for (auto& buffer : buffers)
+        {
+            buffer = std::make_unique<BufferHost>(m_device, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        }
+
+        return buffers;
+    }
+
+  public:
+    StorageBuffer(const Device& device, VkDeviceSize size) : m_device(device), m_buffers(create_buffers(size)) {}
+
+    // Grows the buffer for the frame so that it holds at least size bytes. The frame's fence must have been waited on,
+    // so the previous buffer is no longer in use by the GPU; its contents are discarded.
+    BufferHost& reserve(size_t index, VkDeviceSize size)
+    {
+        auto& buffer = m_buffers[index];
+        if (buffer->size() < size)
+        {
+            buffer = std::make_unique<BufferHost>(
+                m_device, std::max(size, buffer->size() * 2), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        }
+
+        return *buffer;
+    }
+
+    BufferHost& operator[](size_t index)
+    {
+        return *m_buffers[index];
+    }
+
+    const BufferHost& operator[](size_t index) const
+    {
+        return *m_buffers[index];
+    }
+};
+} // namespace steeplejack
@@ -8,7 +8,7 @@ DepthBuffer::DepthBuffer(const Device& device, const Swapchain& swapchain) :
     m_image(device,
             swapchain.extent().width,
             swapchain.extent().height,
-            VK_FORMAT_D32_SFLOAT_S8_UINT,
+            kFormat,
             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
             VK_IMAGE_TILING_OPTIMAL,
             device.msaa_samples()),
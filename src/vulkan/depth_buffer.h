@@ -18,8 +18,15 @@ class DepthBuffer : public NoCopyOrMove
     const ImageView m_image_view;
 
   public:
+    static constexpr VkFormat kFormat = VK_FORMAT_D32_SFLOAT_S8_UINT;
+
     DepthBuffer(const Device& device, const Swapchain& swapchain);
 
+    VkImage image() const
+    {
+        return m_image;
+    }
+
     VkImageView image_view() const
     {
         return m_image_view;
@@ -8,9 +8,12 @@
 
 using namespace steeplejack;
 
-DescriptorSetLayout::DescriptorSetLayout(const Device& device, std::vector<DescriptorSetLayoutInfo> layout_infos) :
+DescriptorSetLayout::DescriptorSetLayout(const Device& device,
+                                         std::vector<DescriptorSetLayoutInfo> layout_infos,
+                                         std::vector<VkPushConstantRange> push_constant_ranges) :
     m_device(device),
     m_layout_infos(std::move(std::move(layout_infos))),
+    m_push_constant_ranges(std::move(push_constant_ranges)),
     m_descriptor_set_layout(create_descriptor_set_layout()),
     m_descriptor_set_layouts({m_descriptor_set_layout}),
     m_write_descriptor_sets(create_write_descriptor_sets())
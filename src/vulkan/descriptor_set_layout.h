@@ -4,8 +4,11 @@
 #include "util/no_copy_or_move.h"
 #include "vulkan/device.h"
 
+#include <algorithm>
 #include <array>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -16,6 +19,7 @@ class DescriptorSetLayout : NoCopyOrMove
   private:
     const Device& m_device;
     const std::vector<DescriptorSetLayoutInfo> m_layout_infos;
+    const std::vector<VkPushConstantRange> m_push_constant_ranges;
     const VkDescriptorSetLayout m_descriptor_set_layout;
     const std::array<VkDescriptorSetLayout, 1> m_descriptor_set_layouts;
     std::vector<VkWriteDescriptorSet> m_write_descriptor_sets;
@@ -23,8 +27,22 @@ class DescriptorSetLayout : NoCopyOrMove
     VkDescriptorSetLayout create_descriptor_set_layout();
     std::vector<VkWriteDescriptorSet> create_write_descriptor_sets();
 
+    // Bindings come from shader reflection, so they need not be numbered from 0 without gaps.
+    VkWriteDescriptorSet& write_descriptor_set(uint32_t binding_index)
+    {
+        auto result = std::ranges::find(m_write_descriptor_sets, binding_index, &VkWriteDescriptorSet::dstBinding);
+        if (result == m_write_descriptor_sets.end())
+        {
+            throw std::runtime_error("Failed to write descriptor: no binding " + std::to_string(binding_index));
+        }
+
+        return *result;
+    }
+
   public:
-    DescriptorSetLayout(const Device& device, std::vector<DescriptorSetLayoutInfo> layout_infos);
+    DescriptorSetLayout(const Device& device,
+                        std::vector<DescriptorSetLayoutInfo> layout_infos,
+                        std::vector<VkPushConstantRange> push_constant_ranges = {});
     ~DescriptorSetLayout();
 
     operator VkDescriptorSetLayout() const
@@ -37,6 +55,11 @@ class DescriptorSetLayout : NoCopyOrMove
         return m_descriptor_set_layouts;
     }
 
+    const std::vector<VkPushConstantRange>& get_push_constant_ranges() const
+    {
+        return m_push_constant_ranges;
+    }
+
     const std::vector<VkWriteDescriptorSet>& get_write_descriptor_sets() const
     {
         return m_write_descriptor_sets;
@@ -44,18 +67,24 @@ class DescriptorSetLayout : NoCopyOrMove
 
     DescriptorSetLayout& write_combined_image_sampler(VkDescriptorImageInfo* image_info, uint32_t binding_index)
     {
-        auto& write_descriptor_set = m_write_descriptor_sets[binding_index];
-        write_descriptor_set.dstBinding = binding_index;
-        write_descriptor_set.pImageInfo = image_info;
+        auto& write = write_descriptor_set(binding_index);
+        write.pImageInfo = image_info;
 
         return *this;
     }
 
     DescriptorSetLayout& write_uniform_buffer(VkDescriptorBufferInfo* buffer_info, uint32_t binding_index)
     {
-        auto& write_descriptor_set = m_write_descriptor_sets[binding_index];
-        write_descriptor_set.dstBinding = binding_index;
-        write_descriptor_set.pBufferInfo = buffer_info;
+        auto& write = write_descriptor_set(binding_index);
+        write.pBufferInfo = buffer_info;
+
+        return *this;
+    }
+
+    DescriptorSetLayout& write_storage_buffer(VkDescriptorBufferInfo* buffer_info, uint32_t binding_index)
+    {
+        auto& write = write_descriptor_set(binding_index);
+        write.pBufferInfo = buffer_info;
 
         return *this;
     }
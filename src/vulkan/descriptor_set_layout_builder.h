@@ -3,9 +3,12 @@
 #include "descriptor_set_layout.h"
 #include "descriptor_set_layout_info.h"
 #include "device.h"
+#include "util/spirv_reflection.h"
 
 #include <algorithm>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -15,30 +18,103 @@ class DescriptorSetLayoutBuilder
 {
   private:
     std::vector<DescriptorSetLayoutInfo> m_infos;
+    std::vector<VkPushConstantRange> m_push_constant_ranges;
 
-    void add_info(VkDescriptorType descriptor_type, VkShaderStageFlags stage_flags)
+    static VkShaderStageFlags stage_flags(SpirvReflection::Stage stage)
     {
-        auto binding = static_cast<uint32_t>(m_infos.size());
-        m_infos.push_back({descriptor_type, stage_flags, binding});
+        switch (stage)
+        {
+        case SpirvReflection::Stage::kVertex:
+            return VK_SHADER_STAGE_VERTEX_BIT;
+        case SpirvReflection::Stage::kFragment:
+            return VK_SHADER_STAGE_FRAGMENT_BIT;
+        default:
+            return VK_SHADER_STAGE_ALL_GRAPHICS;
+        }
     }
 
-  public:
-    DescriptorSetLayoutBuilder& add_combined_image_sampler()
+    static VkDescriptorType descriptor_type(SpirvReflection::DescriptorType type)
     {
-        add_info(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-        return *this;
+        switch (type)
+        {
+        case SpirvReflection::DescriptorType::kUniformBuffer:
+            return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        case SpirvReflection::DescriptorType::kStorageBuffer:
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        case SpirvReflection::DescriptorType::kCombinedImageSampler:
+            return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        case SpirvReflection::DescriptorType::kSampledImage:
+            return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        case SpirvReflection::DescriptorType::kStorageImage:
+            return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        case SpirvReflection::DescriptorType::kSampler:
+            return VK_DESCRIPTOR_TYPE_SAMPLER;
+        }
+
+        throw std::runtime_error("Unknown descriptor type " + std::to_string(static_cast<int>(type)));
     }
 
-    DescriptorSetLayoutBuilder& add_uniform_buffer()
+  public:
+    // Adds what a shader declares in set 0, the pushed set, and its push constants, merging them with what the other
+    // shaders added: a binding used by several stages is visible to all of them, and all reflected push constants
+    // share one range from offset 0 as large as the largest block. Set 1 is the bindless textures' own layout.
+    DescriptorSetLayoutBuilder& add_shader(const SpirvReflection& reflection)
     {
-        add_info(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
+        const auto stage = stage_flags(reflection.stage);
+        for (const auto& binding : reflection.bindings)
+        {
+            if (binding.set != 0)
+            {
+                continue;
+            }
+
+            if (binding.count != 1)
+            {
+                throw std::runtime_error("Failed to build descriptor set layout: binding " +
+                                         std::to_string(binding.binding) + " of the pushed set is an array");
+            }
+
+            const auto type = descriptor_type(binding.type);
+            auto info = std::ranges::find(m_infos, binding.binding, &DescriptorSetLayoutInfo::binding);
+            if (info == m_infos.end())
+            {
+                m_infos.push_back({type, stage, binding.binding});
+            }
+            else if (info->descriptor_type != type)
+            {
+                throw std::runtime_error("Failed to build descriptor set layout: shaders disagree on binding " +
+                                         std::to_string(binding.binding));
+            }
+            else
+            {
+                info->stage_flags |= stage;
+            }
+        }
+
+        std::ranges::sort(m_infos, {}, &DescriptorSetLayoutInfo::binding);
+
+        if (reflection.push_constant_size > 0)
+        {
+            if (m_push_constant_ranges.empty())
+            {
+                m_push_constant_ranges.push_back({stage, 0, reflection.push_constant_size});
+            }
+            else
+            {
+                auto& range = m_push_constant_ranges.front();
+                range.stageFlags |= stage;
+                range.size = std::max(range.size, reflection.push_constant_size);
+            }
+        }
+
         return *this;
     }
 
     std::unique_ptr<DescriptorSetLayout> build(const Device& device)
     {
-        auto result = std::make_unique<DescriptorSetLayout>(device, m_infos);
+        auto result = std::make_unique<DescriptorSetLayout>(device, m_infos, m_push_constant_ranges);
         m_infos.clear();
+        m_push_constant_ranges.clear();
         return result;
     }
 };
@@ -8,8 +8,8 @@ namespace steeplejack
 {
 struct DescriptorSetLayoutInfo
 {
-    const VkDescriptorType descriptor_type;
-    const VkShaderStageFlags stage_flags;
-    const uint32_t binding;
+    VkDescriptorType descriptor_type;
+    VkShaderStageFlags stage_flags;
+    uint32_t binding;
 };
 } // namespace steeplejack
\ No newline at end of file
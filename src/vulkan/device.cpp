@@ -3,6 +3,7 @@
 
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
 #include <vma/vk_mem_alloc.h>
 
 using namespace steeplejack;
@@ -15,7 +16,8 @@ Device::Device(const Window& window, bool enable_validation_layers) :
     m_allocator(create_allocator()),
     m_graphics_queue(create_queue(vkb::QueueType::graphics)),
     m_present_queue(create_queue(vkb::QueueType::present)),
-    m_transfer_queue(create_queue(vkb::QueueType::transfer))
+    m_transfer_queue(create_queue(vkb::QueueType::transfer)),
+    m_graphics_pipeline_library(supports_graphics_pipeline_library())
 {
 }
 
@@ -58,11 +60,29 @@ vkb::Device Device::create_device()
     VkPhysicalDeviceFeatures required_features = {};
     required_features.samplerAnisotropy = VK_TRUE;
 
+    // Descriptor indexing for the bindless texture array, timeline semaphores for texture streaming.
+    VkPhysicalDeviceVulkan12Features required_features_12 = {};
+    required_features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    required_features_12.descriptorIndexing = VK_TRUE;
+    required_features_12.runtimeDescriptorArray = VK_TRUE;
+    required_features_12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    required_features_12.descriptorBindingPartiallyBound = VK_TRUE;
+    required_features_12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    required_features_12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    required_features_12.timelineSemaphore = VK_TRUE;
+
+    // Dynamic rendering in place of render pass and framebuffer objects.
+    VkPhysicalDeviceVulkan13Features required_features_13 = {};
+    required_features_13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    required_features_13.dynamicRendering = VK_TRUE;
+
     vkb::PhysicalDeviceSelector selector{m_instance};
     auto phys_ret = selector.set_surface(m_surface)
                         .set_minimum_version(1, 3)
                         .require_dedicated_transfer_queue()
                         .set_required_features(required_features)
+                        .set_required_features_12(required_features_12)
+                        .set_required_features_13(required_features_13)
                         .add_required_extension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)
                         .select();
     if (!phys_ret)
@@ -70,9 +90,26 @@ vkb::Device Device::create_device()
         throw std::runtime_error("Failed to select Vulkan Physical Device: " + phys_ret.error().message());
     }
 
+    auto physical_device = phys_ret.value();
+
+    // Block compressed textures are used when available and decoded images otherwise.
+    VkPhysicalDeviceFeatures optional_features = {};
+    optional_features.textureCompressionBC = VK_TRUE;
+    physical_device.enable_features_if_present(optional_features);
+
+    // Pipelines are built from libraries and fast-linked when available, and compiled whole otherwise.
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipeline_library_features = {};
+    pipeline_library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    pipeline_library_features.graphicsPipelineLibrary = VK_TRUE;
+    if (physical_device.enable_extensions_if_present(
+            {VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME}))
+    {
+        physical_device.enable_extension_features_if_present(pipeline_library_features);
+    }
+
     spdlog::info("Creating Vulkan Device");
 
-    vkb::DeviceBuilder const device_builder{phys_ret.value()};
+    vkb::DeviceBuilder const device_builder{physical_device};
     auto dev_ret = device_builder.build();
     if (!dev_ret)
     {
@@ -109,4 +146,23 @@ VkQueue Device::create_queue(vkb::QueueType queue_type)
     }
 
     return queue_ret.value();
+}
+
+bool Device::supports_graphics_pipeline_library() const
+{
+    const auto extensions = m_device.physical_device.get_extensions();
+    if (std::ranges::find(extensions, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) == extensions.end())
+    {
+        return false;
+    }
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipeline_library_features = {};
+    pipeline_library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &pipeline_library_features;
+    vkGetPhysicalDeviceFeatures2(m_device.physical_device, &features);
+
+    return pipeline_library_features.graphicsPipelineLibrary == VK_TRUE;
 }
\ No newline at end of file
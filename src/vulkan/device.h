@@ -23,11 +23,14 @@ class Device : NoCopyOrMove
     const VkQueue m_present_queue;
     const VkQueue m_transfer_queue;
 
+    const bool m_graphics_pipeline_library;
+
     static vkb::Instance create_instance(bool enable_validation_layers);
     VkSurfaceKHR create_surface();
     vkb::Device create_device();
     VmaAllocator create_allocator();
     VkQueue create_queue(vkb::QueueType queue_type);
+    bool supports_graphics_pipeline_library() const;
 
   public:
     Device(const Window& window, bool enable_validation_layers);
@@ -117,5 +120,11 @@ class Device : NoCopyOrMove
     {
         return m_allocator;
     }
+
+    // Whether pipelines can be built from VK_EXT_graphics_pipeline_library parts and linked.
+    bool graphics_pipeline_library() const
+    {
+        return m_graphics_pipeline_library;
+    }
 };
 } // namespace steeplejack
\ No newline at end of file
@@ -7,8 +7,8 @@ using namespace steeplejack;
 
 constexpr std::array<VkDeviceSize, 1> kVertexOffsets{0};
 
-GraphicsBuffers::GraphicsBuffers(const Device& device, const AdhocQueues& adhoc_queues) :
-    m_device(device), m_adhoc_queues(adhoc_queues), m_vertex_buffer(nullptr), m_index_buffer(nullptr)
+GraphicsBuffers::GraphicsBuffers(const Device& device) :
+    m_device(device), m_vertex_buffer(nullptr), m_index_buffer(nullptr)
 {
 }
 
@@ -1,8 +1,8 @@
 #pragma once
 
-#include "adhoc_queues.h"
 #include "buffer/buffer_gpu.h"
 #include "device.h"
+#include "upload_batch.h"
 #include "util/memory.h"
 #include "util/no_copy_or_move.h"
 #include "vertex.h"
@@ -10,6 +10,7 @@
 #include <array>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <type_traits>
 #include <vulkan/vulkan.h>
 
@@ -19,41 +20,47 @@ class GraphicsBuffers : NoCopyOrMove
 {
   private:
     const Device& m_device;
-    const AdhocQueues& m_adhoc_queues;
 
     std::unique_ptr<BufferGPU> m_vertex_buffer;
     std::unique_ptr<BufferGPU> m_index_buffer;
 
   public:
-    GraphicsBuffers(const Device& device, const AdhocQueues& adhoc_queues);
+    GraphicsBuffers(const Device& device);
 
-    template <typename TIter> void load_vertexes(TIter begin, TIter end)
+    // The buffers are recorded into upload_batch and must not be bound before it has completed.
+    template <typename TIter> void load_vertexes(UploadBatch& upload_batch, TIter begin, TIter end)
     {
         static_assert(std::is_same_v<Vertex, std::decay_t<decltype(*begin)>>, "TIter must be an iterator to Vertex");
 
-        m_vertex_buffer = std::make_unique<BufferGPU>(
-            m_device, m_adhoc_queues, total_bytes(begin, end), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
-        m_vertex_buffer->copy_from(begin, end);
+        m_vertex_buffer =
+            std::make_unique<BufferGPU>(m_device, total_bytes(begin, end), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        upload_batch.upload(*m_vertex_buffer,
+                            std::as_bytes(std::span(begin, end)),
+                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
     }
 
-    void load_vertexes(const std::ranges::contiguous_range auto& vertexes)
+    void load_vertexes(UploadBatch& upload_batch, const std::ranges::contiguous_range auto& vertexes)
     {
-        load_vertexes(std::begin(vertexes), std::end(vertexes));
+        load_vertexes(upload_batch, std::begin(vertexes), std::end(vertexes));
     }
 
-    template <typename TIter> void load_indexes(TIter begin, TIter end)
+    template <typename TIter> void load_indexes(UploadBatch& upload_batch, TIter begin, TIter end)
     {
         static_assert(std::is_same_v<Vertex::index_t, std::decay_t<decltype(*begin)>>,
                       "TIter must be an iterator to Vertex::index_t");
 
-        m_index_buffer = std::make_unique<BufferGPU>(
-            m_device, m_adhoc_queues, total_bytes(begin, end), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
-        m_index_buffer->copy_from(begin, end);
+        m_index_buffer =
+            std::make_unique<BufferGPU>(m_device, total_bytes(begin, end), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        upload_batch.upload(*m_index_buffer,
+                            std::as_bytes(std::span(begin, end)),
+                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                            VK_ACCESS_INDEX_READ_BIT);
     }
 
-    void load_indexes(const std::ranges::contiguous_range auto& indexes)
+    void load_indexes(UploadBatch& upload_batch, const std::ranges::contiguous_range auto& indexes)
     {
-        load_indexes(std::begin(indexes), std::end(indexes));
+        load_indexes(upload_batch, std::begin(indexes), std::end(indexes));
     }
 
     void bind(VkCommandBuffer command_buffer) const;
@@ -1,22 +1,30 @@
 #include "graphics_pipeline.h"
 
+#include "raster_state.h"
 #include "spdlog/spdlog.h"
 #include "vertex.h"
 
 #include <array>
+#include <iterator>
 
 using namespace steeplejack;
 
 GraphicsPipeline::GraphicsPipeline(const Device& device,
+                                   ShaderModuleCache& shader_modules,
+                                   const PipelineCache& pipeline_cache,
                                    DescriptorSetLayout& descriptor_set_layout,
-                                   const Swapchain& swapchain,
+                                   const BindlessTextures& bindless_textures,
                                    const RenderPass& render_pass,
                                    const std::string& vertex_shader,
-                                   const std::string& fragment_shader) :
+                                   const std::string& fragment_shader,
+                                   const SpecializationConstants& specialization,
+                                   bool dynamic_raster_state) :
     m_device(device),
     m_descriptor_set_layout(descriptor_set_layout),
-    m_pipeline_layout(create_pipeline_layout(descriptor_set_layout)),
-    m_pipeline(create_pipeline(swapchain, render_pass, vertex_shader, fragment_shader)),
+    m_dynamic_raster_state(dynamic_raster_state),
+    m_pipeline_layout(create_pipeline_layout(descriptor_set_layout, bindless_textures)),
+    m_pipeline(
+        create_pipeline(shader_modules, pipeline_cache, render_pass, vertex_shader, fragment_shader, specialization)),
     vkCmdPushDescriptorSetKHR(fetch_vkCmdPushDescriptorSetKHR())
 {
 }
@@ -28,17 +36,19 @@ GraphicsPipeline::~GraphicsPipeline()
     vkDestroyPipelineLayout(m_device, m_pipeline_layout, nullptr);
 }
 
-VkPipelineLayout GraphicsPipeline::create_pipeline_layout(const DescriptorSetLayout& descriptor_set_layout)
+VkPipelineLayout GraphicsPipeline::create_pipeline_layout(const DescriptorSetLayout& descriptor_set_layout,
+                                                          const BindlessTextures& bindless_textures)
 {
     spdlog::info("Creating Graphics Pipeline Layout");
 
-    auto set_layouts = descriptor_set_layout.get_layouts_for_pipeline();
+    std::array<VkDescriptorSetLayout, 2> set_layouts = {descriptor_set_layout, bindless_textures.layout()};
     VkPipelineLayoutCreateInfo pipeline_layout_info = {};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
     pipeline_layout_info.pSetLayouts = set_layouts.data();
-    pipeline_layout_info.pushConstantRangeCount = 0;
-    pipeline_layout_info.pPushConstantRanges = nullptr;
+    const auto& push_constant_ranges = descriptor_set_layout.get_push_constant_ranges();
+    pipeline_layout_info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size());
+    pipeline_layout_info.pPushConstantRanges = push_constant_ranges.data();
 
     VkPipelineLayout pipeline_layout = nullptr;
     if (vkCreatePipelineLayout(m_device, &pipeline_layout_info, nullptr, &pipeline_layout) != VK_SUCCESS)
@@ -49,21 +59,26 @@ VkPipelineLayout GraphicsPipeline::create_pipeline_layout(const DescriptorSetLay
     return pipeline_layout;
 }
 
-VkPipeline GraphicsPipeline::create_pipeline(const Swapchain& swapchain,
+VkPipeline GraphicsPipeline::create_pipeline(ShaderModuleCache& shader_modules,
+                                             const PipelineCache& pipeline_cache,
                                              const RenderPass& render_pass,
                                              const std::string& vertex_shader,
-                                             const std::string& fragment_shader)
+                                             const std::string& fragment_shader,
+                                             const SpecializationConstants& specialization)
 {
     spdlog::info("Creating Graphics Pipeline");
 
-    auto vertex_input_state = VertexInputState(0, Vertex::kAllComponents);
+    const auto vertex_shader_module = shader_modules.get(vertex_shader);
+    const auto fragment_shader_module = shader_modules.get(fragment_shader);
+    const auto specialization_info = SpecializationInfo(specialization);
+    auto shader_stages = create_shader_stages(*vertex_shader_module, *fragment_shader_module, specialization_info);
 
-    auto vertex_shader_module = ShaderModule(m_device, vertex_shader);
-    auto fragment_shader_module = ShaderModule(m_device, fragment_shader);
-    auto shader_stages = create_shader_stages(vertex_shader_module, fragment_shader_module);
+    // Only the attributes the vertex shader reads.
+    const auto vertex_components = Vertex::components(vertex_shader_module->reflection().input_locations);
+    auto vertex_input_state = VertexInputState(0, vertex_components);
 
     auto input_assembly_state = create_input_assembly_state();
-    auto viewport_state = create_viewport_state(swapchain);
+    auto viewport_state = create_viewport_state();
     auto rasterization_state = create_rasterization_state();
     auto multisampling_state = create_multisample_state();
     auto color_blend_attachment = create_color_blend_attachment_state();
@@ -74,6 +89,7 @@ VkPipeline GraphicsPipeline::create_pipeline(const Swapchain& swapchain,
 
     VkGraphicsPipelineCreateInfo pipeline_info = {};
     pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.pNext = &render_pass.pipeline_rendering_info();
     pipeline_info.stageCount = static_cast<uint32_t>(shader_stages.size());
     pipeline_info.pStages = shader_stages.data();
     pipeline_info.pVertexInputState = &vertex_input_state.pipeline;
@@ -85,12 +101,10 @@ VkPipeline GraphicsPipeline::create_pipeline(const Swapchain& swapchain,
     pipeline_info.pDynamicState = &dynamic_state;
     pipeline_info.pDepthStencilState = &depth_stencil_state;
     pipeline_info.layout = m_pipeline_layout;
-    pipeline_info.renderPass = render_pass;
-    pipeline_info.subpass = 0;
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
 
     VkPipeline pipeline = nullptr;
-    if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS)
+    if (vkCreateGraphicsPipelines(m_device, pipeline_cache, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create pipeline");
     }
@@ -98,20 +112,24 @@ VkPipeline GraphicsPipeline::create_pipeline(const Swapchain& swapchain,
     return pipeline;
 }
 
-std::vector<VkPipelineShaderStageCreateInfo> GraphicsPipeline::create_shader_stages(const ShaderModule& vertex_shader,
-                                                                                    const ShaderModule& fragment_shader)
+std::vector<VkPipelineShaderStageCreateInfo>
+GraphicsPipeline::create_shader_stages(const ShaderModule& vertex_shader,
+                                       const ShaderModule& fragment_shader,
+                                       const SpecializationInfo& specialization)
 {
     VkPipelineShaderStageCreateInfo vert_stage_info = {};
     vert_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     vert_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
     vert_stage_info.module = vertex_shader;
     vert_stage_info.pName = "main";
+    vert_stage_info.pSpecializationInfo = specialization.get();
 
     VkPipelineShaderStageCreateInfo frag_stage_info = {};
     frag_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     frag_stage_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     frag_stage_info.module = fragment_shader;
     frag_stage_info.pName = "main";
+    frag_stage_info.pSpecializationInfo = specialization.get();
 
     return {vert_stage_info, frag_stage_info};
 }
@@ -126,14 +144,13 @@ VkPipelineInputAssemblyStateCreateInfo GraphicsPipeline::create_input_assembly_s
     return result;
 }
 
-VkPipelineViewportStateCreateInfo GraphicsPipeline::create_viewport_state(const Swapchain& swapchain)
+// Only the counts: the viewport and scissor themselves are dynamic and set by Swapchain::clip.
+VkPipelineViewportStateCreateInfo GraphicsPipeline::create_viewport_state()
 {
     VkPipelineViewportStateCreateInfo result = {};
     result.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     result.viewportCount = 1;
-    result.pViewports = &swapchain.viewport();
     result.scissorCount = 1;
-    result.pScissors = &swapchain.scissor();
 
     return result;
 }
@@ -167,8 +184,8 @@ VkPipelineColorBlendAttachmentState GraphicsPipeline::create_color_blend_attachm
 {
     VkPipelineColorBlendAttachmentState result = {};
     result.blendEnable = VK_FALSE;
-    result.colorWriteMask = static_cast<VkColorComponentFlags>(
-        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT);
+    result.colorWriteMask = static_cast<VkColorComponentFlags>(
+        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT);
 
     return result;
 }
@@ -190,9 +207,16 @@ GraphicsPipeline::create_color_blend_state(const VkPipelineColorBlendAttachmentS
     return result;
 }
 
-std::vector<VkDynamicState> GraphicsPipeline::create_dynamic_states()
+// The fixed function state that RasterState covers is ignored when it is dynamic.
+std::vector<VkDynamicState> GraphicsPipeline::create_dynamic_states() const
 {
-    return {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    std::vector<VkDynamicState> result = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    if (m_dynamic_raster_state)
+    {
+        result.insert(result.end(), std::begin(RasterState::kDynamicStates), std::end(RasterState::kDynamicStates));
+    }
+
+    return result;
 }
 
 VkPipelineDynamicStateCreateInfo
@@ -225,12 +249,12 @@ VkPipelineDepthStencilStateCreateInfo GraphicsPipeline::create_depth_stencil_sta
 
 PFN_vkCmdPushDescriptorSetKHR GraphicsPipeline::fetch_vkCmdPushDescriptorSetKHR()
 {
-    auto result = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
-        vkGetDeviceProcAddr(m_device, "vkCmdPushDescriptorSetKHR"));
+    auto result = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+        vkGetDeviceProcAddr(m_device, "vkCmdPushDescriptorSetKHR"));
     if (result == nullptr)
     {
         throw std::runtime_error("Failed to load vkCmdPushDescriptorSetKHR");
     }
 
     return result;
-}
+}
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "bindless_textures.h"
 #include "descriptor_set_layout.h"
 #include "device.h"
+#include "pipeline_cache.h"
 #include "render_pass.h"
 #include "shader_module.h"
-#include "swapchain.h"
+#include "shader_module_cache.h"
+#include "specialization_info.h"
 #include "util/no_copy_or_move.h"
+#include "util/specialization_constants.h"
 
 #include <memory>
 #include <string>
@@ -14,30 +18,39 @@
 
 namespace steeplejack
 {
+// Built for dynamic rendering against a render pass, which fixes only the attachment formats and sample count:
+// viewport and scissor are dynamic, so the pipeline survives swapchain recreation. With dynamic raster state the
+// RasterState is dynamic too, and must be set before drawing.
 class GraphicsPipeline : NoCopyOrMove
 {
   private:
     const Device& m_device;
     DescriptorSetLayout& m_descriptor_set_layout;
+    const bool m_dynamic_raster_state;
 
     const VkPipelineLayout m_pipeline_layout;
     const VkPipeline m_pipeline;
+    VkPipeline m_override = VK_NULL_HANDLE;
 
     PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR;
 
-    VkPipelineLayout create_pipeline_layout(const DescriptorSetLayout& descriptor_set_layout);
+    VkPipelineLayout create_pipeline_layout(const DescriptorSetLayout& descriptor_set_layout,
+                                            const BindlessTextures& bindless_textures);
 
-    VkPipeline create_pipeline(const Swapchain& swapchain,
+    VkPipeline create_pipeline(ShaderModuleCache& shader_modules,
+                               const PipelineCache& pipeline_cache,
                                const RenderPass& render_pass,
                                const std::string& vertex_shader,
-                               const std::string& fragment_shader);
+                               const std::string& fragment_shader,
+                               const SpecializationConstants& specialization);
 
     static std::vector<VkPipelineShaderStageCreateInfo> create_shader_stages(const ShaderModule& vertex_shader,
-                                                                             const ShaderModule& fragment_shader);
+                                                                             const ShaderModule& fragment_shader,
+                                                                             const SpecializationInfo& specialization);
 
     static VkPipelineInputAssemblyStateCreateInfo create_input_assembly_state();
 
-    static VkPipelineViewportStateCreateInfo create_viewport_state(const Swapchain& swapchain);
+    static VkPipelineViewportStateCreateInfo create_viewport_state();
 
     static VkPipelineRasterizationStateCreateInfo create_rasterization_state();
 
@@ -48,7 +61,7 @@ class GraphicsPipeline : NoCopyOrMove
     static VkPipelineColorBlendStateCreateInfo
     create_color_blend_state(const VkPipelineColorBlendAttachmentState& color_blend_attachment_state);
 
-    static std::vector<VkDynamicState> create_dynamic_states();
+    std::vector<VkDynamicState> create_dynamic_states() const;
 
     static VkPipelineDynamicStateCreateInfo create_dynamic_state(const std::vector<VkDynamicState>& dynamic_states);
 
@@ -58,16 +71,32 @@ class GraphicsPipeline : NoCopyOrMove
 
   public:
     GraphicsPipeline(const Device& device,
+                     ShaderModuleCache& shader_modules,
+                     const PipelineCache& pipeline_cache,
                      DescriptorSetLayout& descriptor_set_layout,
-                     const Swapchain& swapchain,
+                     const BindlessTextures& bindless_textures,
                      const RenderPass& render_pass,
                      const std::string& vertex_shader,
-                     const std::string& fragment_shader);
+                     const std::string& fragment_shader,
+                     const SpecializationConstants& specialization = {},
+                     bool dynamic_raster_state = false);
     ~GraphicsPipeline();
 
     operator VkPipeline() const
     {
-        return m_pipeline;
+        return m_override != VK_NULL_HANDLE ? m_override : m_pipeline;
+    }
+
+    // Draws with pipeline, which must share the layout and render pass, instead of the pipeline built on creation,
+    // until it is called again; VK_NULL_HANDLE goes back to the pipeline built on creation. The caller owns pipeline.
+    void set_override(VkPipeline pipeline)
+    {
+        m_override = pipeline;
+    }
+
+    bool dynamic_raster_state() const
+    {
+        return m_dynamic_raster_state;
     }
 
     VkPipelineLayout layout() const
@@ -82,7 +111,22 @@ class GraphicsPipeline : NoCopyOrMove
 
     void bind(VkCommandBuffer command_buffer) const
     {
-        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, static_cast<VkPipeline>(*this));
+    }
+
+    // Writes data at the start of the push constant block, visible to every stage of the ranges it covers.
+    template <typename T> void push_constants(VkCommandBuffer command_buffer, const T& data) const
+    {
+        VkShaderStageFlags stage_flags = 0;
+        for (const auto& range : m_descriptor_set_layout.get_push_constant_ranges())
+        {
+            if (range.offset < sizeof(T))
+            {
+                stage_flags |= range.stageFlags;
+            }
+        }
+
+        vkCmdPushConstants(command_buffer, m_pipeline_layout, stage_flags, 0, sizeof(T), &data);
     }
 
     void push_descriptor_set(VkCommandBuffer command_buffer) const
@@ -109,8 +109,7 @@ std::vector<VkFence> GraphicsQueue::create_fences()
     return fences;
 }
 
-VkFramebuffer
-GraphicsQueue::prepare_framebuffer(uint32_t current_frame, const Swapchain& swapchain, const Framebuffers& framebuffers)
+std::optional<uint32_t> GraphicsQueue::acquire_image(uint32_t current_frame, const Swapchain& swapchain)
 {
     assert(m_swapchain == VK_NULL_HANDLE);
     assert(m_render_finished_semaphore == VK_NULL_HANDLE);
@@ -133,7 +132,7 @@ GraphicsQueue::prepare_framebuffer(uint32_t current_frame, const Swapchain& swap
     {
         m_swapchain = VK_NULL_HANDLE;
         m_render_finished_semaphore = VK_NULL_HANDLE;
-        return nullptr;
+        return std::nullopt;
     }
 
     if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
@@ -143,7 +142,7 @@ GraphicsQueue::prepare_framebuffer(uint32_t current_frame, const Swapchain& swap
 
     m_render_finished_semaphore = swapchain.render_finished(m_image_index);
 
-    return framebuffers.get(m_image_index);
+    return m_image_index;
 }
 
 VkCommandBuffer GraphicsQueue::begin_command() const
@@ -199,7 +198,7 @@ void GraphicsQueue::submit_command() const
     }
 }
 
-bool GraphicsQueue::present_framebuffer()
+bool GraphicsQueue::present_image()
 {
     assert(m_swapchain != VK_NULL_HANDLE);
     assert(m_render_finished_semaphore != VK_NULL_HANDLE);
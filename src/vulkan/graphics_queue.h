@@ -1,11 +1,11 @@
 #pragma once
 
 #include "device.h"
-#include "framebuffers.h"
 #include "swapchain.h"
 #include "util/no_copy_or_move.h"
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace steeplejack
@@ -36,11 +36,12 @@ class GraphicsQueue : NoCopyOrMove
     GraphicsQueue(const Device& device);
     ~GraphicsQueue();
 
-    VkFramebuffer
-    prepare_framebuffer(uint32_t current_frame, const Swapchain& swapchain, const Framebuffers& framebuffers);
+    // Waits for the frame's previous submission and acquires the next swapchain image, returning its index, or nothing
+    // when the swapchain is out of date.
+    std::optional<uint32_t> acquire_image(uint32_t current_frame, const Swapchain& swapchain);
 
     VkCommandBuffer begin_command() const;
     void submit_command() const;
-    bool present_framebuffer();
+    bool present_image();
 };
 } // namespace steeplejack
\ No newline at end of file
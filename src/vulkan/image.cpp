@@ -10,10 +10,18 @@ Image::Image(const Device& device,
              VkFormat format,
              VkImageUsageFlags usage,
              VkImageTiling tiling,
-             VkSampleCountFlagBits samples) :
+             VkSampleCountFlagBits samples,
+             uint32_t mip_levels,
+             uint32_t array_layers) :
     m_device(device),
-    m_image_info(
-        {.width = width, .height = height, .format = format, .usage = usage, .tiling = tiling, .samples = samples}),
+    m_image_info({.width = width,
+                  .height = height,
+                  .format = format,
+                  .usage = usage,
+                  .tiling = tiling,
+                  .samples = samples,
+                  .mip_levels = mip_levels,
+                  .array_layers = array_layers}),
     m_allocation_info(create_allocation_info())
 {
 }
@@ -33,8 +41,8 @@ Image::AllocationInfo Image::create_allocation_info()
     image_info.extent.width = m_image_info.width;
     image_info.extent.height = m_image_info.height;
     image_info.extent.depth = 1;
-    image_info.mipLevels = 1;
-    image_info.arrayLayers = 1;
+    image_info.mipLevels = m_image_info.mip_levels;
+    image_info.arrayLayers = m_image_info.array_layers;
     image_info.format = m_image_info.format;
     image_info.tiling = m_image_info.tiling;
     image_info.usage = m_image_info.usage;
@@ -3,6 +3,9 @@
 #include "device.h"
 #include "util/no_copy_or_move.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <vma/vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
@@ -19,6 +22,8 @@ class Image : public NoCopyOrMove
         const VkImageUsageFlags usage;
         const VkImageTiling tiling;
         const VkSampleCountFlagBits samples;
+        const uint32_t mip_levels;
+        const uint32_t array_layers;
     };
 
   private:
@@ -42,9 +47,17 @@ class Image : public NoCopyOrMove
           VkFormat format,
           VkImageUsageFlags usage,
           VkImageTiling tiling,
-          VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+          VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT,
+          uint32_t mip_levels = 1,
+          uint32_t array_layers = 1);
     ~Image();
 
+    // Number of levels in a full mip chain down to 1x1.
+    static uint32_t full_mip_levels(uint32_t width, uint32_t height)
+    {
+        return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+    }
+
     operator VkImage() const
     {
         return m_allocation_info.image;
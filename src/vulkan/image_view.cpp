@@ -4,8 +4,15 @@
 
 using namespace steeplejack;
 
-ImageView::ImageView(const Device& device, const Image& image, VkImageAspectFlags aspect_mask) :
-    m_device(device), m_image(image), m_aspect_mask(aspect_mask), m_image_view(create_image_view())
+ImageView::ImageView(const Device& device,
+                     const Image& image,
+                     VkImageAspectFlags aspect_mask,
+                     VkImageViewType view_type) :
+    m_device(device),
+    m_image(image),
+    m_aspect_mask(aspect_mask),
+    m_view_type(view_type),
+    m_image_view(create_image_view())
 {
 }
 
@@ -21,7 +28,7 @@ VkImageView ImageView::create_image_view()
     VkImageViewCreateInfo image_view_info = {};
     image_view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     image_view_info.image = m_image;
-    image_view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    image_view_info.viewType = m_view_type;
     image_view_info.format = m_image.image_info().format;
     image_view_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
     image_view_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
@@ -29,9 +36,9 @@ VkImageView ImageView::create_image_view()
     image_view_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
     image_view_info.subresourceRange.aspectMask = m_aspect_mask;
     image_view_info.subresourceRange.baseMipLevel = 0;
-    image_view_info.subresourceRange.levelCount = 1;
+    image_view_info.subresourceRange.levelCount = m_image.image_info().mip_levels;
     image_view_info.subresourceRange.baseArrayLayer = 0;
-    image_view_info.subresourceRange.layerCount = 1;
+    image_view_info.subresourceRange.layerCount = m_image.image_info().array_layers;
 
     VkImageView image_view = nullptr;
     if (vkCreateImageView(m_device, &image_view_info, nullptr, &image_view) != VK_SUCCESS)
@@ -14,12 +14,17 @@ class ImageView : public NoCopyOrMove
     const Device& m_device;
     const Image& m_image;
     const VkImageAspectFlags m_aspect_mask;
+    const VkImageViewType m_view_type;
     const VkImageView m_image_view;
 
     VkImageView create_image_view();
 
   public:
-    ImageView(const Device& device, const Image& image, VkImageAspectFlags aspect_mask);
+    // The view covers every level and layer of image.
+    ImageView(const Device& device,
+              const Image& image,
+              VkImageAspectFlags aspect_mask,
+              VkImageViewType view_type = VK_IMAGE_VIEW_TYPE_2D);
     ~ImageView();
 
     operator VkImageView() const
@@ -20,6 +20,11 @@ class Multisampler : public NoCopyOrMove
   public:
     Multisampler(const Device& device, const Swapchain& swapchain);
 
+    VkImage image() const
+    {
+        return m_image;
+    }
+
     VkImageView image_view() const
     {
         return m_image_view;
@@ -0,0 +1,121 @@
+#include "pipeline_cache.h"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+using namespace steeplejack;
+
+PipelineCache::PipelineCache(const Device& device, std::filesystem::path path) :
+    m_device(device), m_path(std::move(path)), m_pipeline_cache(create_pipeline_cache())
+{
+}
+
+PipelineCache::~PipelineCache()
+{
+    spdlog::info("Destroying Pipeline Cache");
+
+    try
+    {
+        save();
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::warn("Pipeline cache not saved: {}", e.what());
+    }
+
+    vkDestroyPipelineCache(m_device, m_pipeline_cache, nullptr);
+}
+
+PipelineCacheHeader PipelineCache::device_header() const
+{
+    const auto properties = m_device.properties();
+
+    PipelineCacheHeader header = {.vendor_id = properties.vendorID, .device_id = properties.deviceID, .uuid = {}};
+    std::copy_n(properties.pipelineCacheUUID, header.uuid.size(), header.uuid.begin());
+
+    return header;
+}
+
+std::vector<std::byte> PipelineCache::read_data() const
+{
+    std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        spdlog::info("No pipeline cache at {}", m_path.generic_string());
+        return {};
+    }
+
+    std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file)
+    {
+        spdlog::warn("Failed to read pipeline cache {}, starting empty", m_path.generic_string());
+        return {};
+    }
+
+    if (!device_header().matches(data))
+    {
+        spdlog::info("Pipeline cache {} was saved by another device or driver, starting empty",
+                     m_path.generic_string());
+        return {};
+    }
+
+    return data;
+}
+
+VkPipelineCache PipelineCache::create_pipeline_cache()
+{
+    spdlog::info("Creating Pipeline Cache");
+
+    const auto data = read_data();
+
+    VkPipelineCacheCreateInfo cache_info = {};
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.initialDataSize = data.size();
+    cache_info.pInitialData = data.data();
+
+    VkPipelineCache pipeline_cache = nullptr;
+    if (vkCreatePipelineCache(m_device, &cache_info, nullptr, &pipeline_cache) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create pipeline cache");
+    }
+
+    return pipeline_cache;
+}
+
+void PipelineCache::save() const
+{
+    size_t size = 0;
+    if (vkGetPipelineCacheData(m_device, m_pipeline_cache, &size, nullptr) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to get pipeline cache size");
+    }
+
+    std::vector<std::byte> data(size);
+    if (vkGetPipelineCacheData(m_device, m_pipeline_cache, &size, data.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to get pipeline cache data");
+    }
+    data.resize(size);
+
+    auto temporary = m_path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write pipeline cache: " + temporary.generic_string());
+        }
+    }
+
+    std::filesystem::rename(temporary, m_path);
+
+    spdlog::info("Saved pipeline cache {} ({} bytes)", m_path.generic_string(), data.size());
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "device.h"
+#include "util/no_copy_or_move.h"
+#include "util/pipeline_cache_header.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// Pipeline cache shared by everything that creates pipelines. It starts from the data saved at path by an earlier run
+// when that data was written by this device and driver, and from nothing otherwise. The data is saved back to path
+// when the cache is destroyed, written aside and moved into place so that a crash never leaves half a file.
+class PipelineCache : NoCopyOrMove
+{
+  public:
+    static constexpr const char* kDefaultPath = "pipeline_cache.bin";
+
+  private:
+    const Device& m_device;
+    const std::filesystem::path m_path;
+    const VkPipelineCache m_pipeline_cache;
+
+    PipelineCacheHeader device_header() const;
+    std::vector<std::byte> read_data() const;
+    VkPipelineCache create_pipeline_cache();
+
+  public:
+    PipelineCache(const Device& device, std::filesystem::path path = kDefaultPath);
+    ~PipelineCache();
+
+    // Writes the current contents of the cache to path.
+    void save() const;
+
+    operator VkPipelineCache() const
+    {
+        return m_pipeline_cache;
+    }
+};
+} // namespace steeplejack
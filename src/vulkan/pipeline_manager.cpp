@@ -0,0 +1,527 @@
+#include "pipeline_manager.h"
+
+#include "depth_buffer.h"
+#include "shader_module.h"
+#include "spdlog/spdlog.h"
+#include "specialization_info.h"
+#include "vertex.h"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace steeplejack;
+
+namespace
+{
+constexpr uint32_t kMaxWorkers = 2;
+
+// Fixed function state of a pipeline filled in from a PipelineState and its vertex shader. The create infos point
+// into it, so it stays put.
+struct FixedFunctionState : NoCopyOrMove
+{
+    VertexInputState vertex_input;
+    SpecializationInfo specialization;
+    VkFormat color_format;
+    VkPipelineRenderingCreateInfo rendering = {};
+    VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
+    VkPipelineViewportStateCreateInfo viewport = {};
+    VkPipelineRasterizationStateCreateInfo rasterization = {};
+    VkPipelineMultisampleStateCreateInfo multisample = {};
+    VkPipelineDepthStencilStateCreateInfo depth_stencil = {};
+    VkPipelineColorBlendAttachmentState color_blend_attachment = {};
+    VkPipelineColorBlendStateCreateInfo color_blend = {};
+    std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamic = {};
+
+    FixedFunctionState(const PipelineState& state, const ShaderModule& vertex_shader) :
+        vertex_input(0, Vertex::components(vertex_shader.reflection().input_locations)),
+        specialization(state.specialization),
+        color_format(state.color_format)
+    {
+        rendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+        rendering.colorAttachmentCount = 1;
+        rendering.pColorAttachmentFormats = &color_format;
+        rendering.depthAttachmentFormat = state.depth_format;
+
+        // With dynamic raster state only the topology class is fixed here; the raster state below is set per draw.
+        input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        input_assembly.topology = state.raster.topology;
+
+        // Viewport and scissor are dynamic.
+        viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewport.viewportCount = 1;
+        viewport.scissorCount = 1;
+
+        rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterization.lineWidth = 1.0F;
+        rasterization.cullMode = state.raster.cull_mode;
+        rasterization.frontFace = state.raster.front_face;
+
+        multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisample.rasterizationSamples = state.samples;
+
+        depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depth_stencil.depthTestEnable = state.raster.depth_test ? VK_TRUE : VK_FALSE;
+        depth_stencil.depthWriteEnable = state.raster.depth_write ? VK_TRUE : VK_FALSE;
+        depth_stencil.depthCompareOp = state.raster.depth_compare_op;
+        depth_stencil.maxDepthBounds = 1.0F;
+
+        color_blend_attachment.colorWriteMask = static_cast<VkColorComponentFlags>(
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT);
+        if (state.blend)
+        {
+            color_blend_attachment.blendEnable = VK_TRUE;
+            color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+            color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        }
+
+        color_blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        color_blend.logicOp = VK_LOGIC_OP_COPY;
+        color_blend.attachmentCount = 1;
+        color_blend.pAttachments = &color_blend_attachment;
+
+        if (state.dynamic_raster)
+        {
+            dynamic_states.insert(
+                dynamic_states.end(), std::begin(RasterState::kDynamicStates), std::end(RasterState::kDynamicStates));
+        }
+
+        dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamic.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+        dynamic.pDynamicStates = dynamic_states.data();
+    }
+};
+
+VkPipelineShaderStageCreateInfo create_shader_stage(VkShaderStageFlagBits stage,
+                                                    const ShaderModule& shader_module,
+                                                    const SpecializationInfo& specialization)
+{
+    VkPipelineShaderStageCreateInfo result = {};
+    result.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    result.stage = stage;
+    result.module = shader_module;
+    result.pName = "main";
+    result.pSpecializationInfo = specialization.get();
+
+    return result;
+}
+} // namespace
+
+PipelineManager::PipelineManager(const Device& device,
+                                 ShaderModuleCache& shader_modules,
+                                 const PipelineCache& pipeline_cache,
+                                 VkPipelineLayout pipeline_layout,
+                                 const RenderPass& render_pass,
+                                 bool dynamic_raster_state) :
+    m_device(device),
+    m_shader_modules(shader_modules),
+    m_pipeline_cache(pipeline_cache),
+    m_pipeline_layout(pipeline_layout),
+    m_color_format(render_pass.color_format()),
+    m_dynamic_raster_state(dynamic_raster_state),
+    m_workers(create_workers())
+{
+    spdlog::info("Creating Pipeline Manager (graphics pipeline library {}, raster state {})",
+                 device.graphics_pipeline_library() ? "supported" : "not supported",
+                 dynamic_raster_state ? "dynamic" : "baked");
+}
+
+PipelineManager::~PipelineManager()
+{
+    spdlog::info("Destroying Pipeline Manager");
+
+    // A pipeline being compiled is finished first, so everything compiled is in m_compiled or m_entries afterwards.
+    for (auto& worker : m_workers)
+    {
+        worker.request_stop();
+    }
+    m_workers.clear();
+
+    for (const auto& compiled : m_compiled)
+    {
+        vkDestroyPipeline(m_device, compiled.pipeline, nullptr);
+    }
+    for (const auto& entry : m_entries)
+    {
+        vkDestroyPipeline(m_device, entry.pipeline, nullptr);
+    }
+    for (const auto& retired : m_retired)
+    {
+        vkDestroyPipeline(m_device, retired.pipeline, nullptr);
+    }
+    for (const auto& [key, library] : m_libraries)
+    {
+        vkDestroyPipeline(m_device, library, nullptr);
+    }
+}
+
+std::vector<std::jthread> PipelineManager::create_workers()
+{
+    const auto count = std::clamp(std::thread::hardware_concurrency(), 2U, kMaxWorkers + 1) - 1;
+
+    std::vector<std::jthread> workers;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        workers.emplace_back([this](std::stop_token stop_token) { compile(stop_token); });
+    }
+
+    return workers;
+}
+
+PipelineState PipelineManager::state(const std::string& vertex_shader,
+                                     const std::string& fragment_shader,
+                                     const SpecializationConstants& specialization) const
+{
+    PipelineState result;
+    result.vertex_shader = vertex_shader;
+    result.fragment_shader = fragment_shader;
+    result.specialization = specialization;
+    result.color_format = m_color_format;
+    result.depth_format = DepthBuffer::kFormat;
+    result.samples = m_device.msaa_samples();
+    result.dynamic_raster = m_dynamic_raster_state;
+
+    return result;
+}
+
+PipelineManager::Handle PipelineManager::request(const PipelineState& requested)
+{
+    // Dynamic raster state is set per draw, so states differing only in it share a pipeline.
+    const auto state = requested.baked();
+
+    if (auto found = m_handles.find(state); found != m_handles.end())
+    {
+        return found->second;
+    }
+
+    if (m_entries.size() >= kMaxPipelines)
+    {
+        throw std::runtime_error("Failed to request pipeline: too many pipelines");
+    }
+
+    m_entries.push_back({
+        .state = state,
+        .pipeline = VK_NULL_HANDLE,
+        .optimized = false,
+        .generation = 0,
+        .published_generation = 0,
+    });
+    const auto handle = static_cast<Handle>(m_entries.size());
+    m_handles.emplace(state, handle);
+
+    queue(handle);
+
+    return handle;
+}
+
+size_t PipelineManager::reload(const std::string& shader)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        auto& entry = m_entries[i];
+        if (entry.state.vertex_shader == shader || entry.state.fragment_shader == shader)
+        {
+            entry.generation++;
+            queue(static_cast<Handle>(i + 1));
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void PipelineManager::queue(Handle handle)
+{
+    const auto& entry = m_entries[handle - 1];
+
+    {
+        std::scoped_lock lock(m_mutex);
+        m_jobs.push_back({.handle = handle, .generation = entry.generation, .state = entry.state});
+    }
+
+    m_condition.notify_one();
+}
+
+// update runs after the fence of the frame about to be recorded has been waited on, so once max_frames_in_flight more
+// updates have passed no submitted frame can still use a replaced pipeline.
+void PipelineManager::update()
+{
+    m_frame++;
+    while (!m_retired.empty() && m_retired.front().frame + Device::max_frames_in_flight <= m_frame)
+    {
+        vkDestroyPipeline(m_device, m_retired.front().pipeline, nullptr);
+        m_retired.pop_front();
+    }
+
+    std::vector<Compiled> compiled;
+    {
+        std::scoped_lock lock(m_mutex);
+        compiled.swap(m_compiled);
+    }
+
+    for (const auto& pipeline : compiled)
+    {
+        auto& entry = m_entries[pipeline.handle - 1];
+        if (pipeline.generation < entry.published_generation)
+        {
+            vkDestroyPipeline(m_device, pipeline.pipeline, nullptr);
+            continue;
+        }
+
+        if (entry.pipeline != VK_NULL_HANDLE)
+        {
+            m_retired.push_back({.frame = m_frame, .pipeline = entry.pipeline});
+        }
+
+        entry.pipeline = pipeline.pipeline;
+        entry.optimized = pipeline.optimized;
+        entry.published_generation = pipeline.generation;
+    }
+}
+
+void PipelineManager::compile(std::stop_token stop_token)
+{
+    while (true)
+    {
+        CompileJob job;
+        {
+            std::unique_lock lock(m_mutex);
+            if (!m_condition.wait(lock, stop_token, [this] { return !m_jobs.empty(); }))
+            {
+                return;
+            }
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        try
+        {
+            if (m_device.graphics_pipeline_library())
+            {
+                compile_libraries(job);
+            }
+            else
+            {
+                compile_monolithic(job);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::error("Failed to compile pipeline {} ({}, {}): {}",
+                          job.handle,
+                          job.state.vertex_shader,
+                          job.state.fragment_shader,
+                          e.what());
+        }
+    }
+}
+
+void PipelineManager::compile_monolithic(const CompileJob& job)
+{
+    const auto vertex_shader = m_shader_modules.get(job.state.vertex_shader);
+    const auto fragment_shader = m_shader_modules.get(job.state.fragment_shader);
+    const FixedFunctionState fixed(job.state, *vertex_shader);
+
+    const std::array<VkPipelineShaderStageCreateInfo, 2> stages = {
+        create_shader_stage(VK_SHADER_STAGE_VERTEX_BIT, *vertex_shader, fixed.specialization),
+        create_shader_stage(VK_SHADER_STAGE_FRAGMENT_BIT, *fragment_shader, fixed.specialization),
+    };
+
+    VkGraphicsPipelineCreateInfo pipeline_info = {};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.pNext = &fixed.rendering;
+    pipeline_info.stageCount = static_cast<uint32_t>(stages.size());
+    pipeline_info.pStages = stages.data();
+    pipeline_info.pVertexInputState = &fixed.vertex_input.pipeline;
+    pipeline_info.pInputAssemblyState = &fixed.input_assembly;
+    pipeline_info.pViewportState = &fixed.viewport;
+    pipeline_info.pRasterizationState = &fixed.rasterization;
+    pipeline_info.pMultisampleState = &fixed.multisample;
+    pipeline_info.pDepthStencilState = &fixed.depth_stencil;
+    pipeline_info.pColorBlendState = &fixed.color_blend;
+    pipeline_info.pDynamicState = &fixed.dynamic;
+    pipeline_info.layout = m_pipeline_layout;
+
+    publish(job, create_pipeline(pipeline_info), true);
+}
+
+// Links the four parts of the pipeline from cached libraries, building those not cached yet, and publishes a fast link
+// of them and then an optimized one.
+void PipelineManager::compile_libraries(const CompileJob& job)
+{
+    const auto vertex_shader = m_shader_modules.get(job.state.vertex_shader);
+    const auto fragment_shader = m_shader_modules.get(job.state.fragment_shader);
+    const FixedFunctionState fixed(job.state, *vertex_shader);
+
+    const auto vertex_stage = create_shader_stage(VK_SHADER_STAGE_VERTEX_BIT, *vertex_shader, fixed.specialization);
+    const auto fragment_stage =
+        create_shader_stage(VK_SHADER_STAGE_FRAGMENT_BIT, *fragment_shader, fixed.specialization);
+
+    const auto get_library = [&](VkGraphicsPipelineLibraryFlagsEXT part, VkGraphicsPipelineCreateInfo pipeline_info)
+    {
+        return library(library_key(part, job.state, *vertex_shader, *fragment_shader),
+                       [&]
+                       {
+                           // Every part but the vertex input interface depends on the attachment formats.
+                           VkGraphicsPipelineLibraryCreateInfoEXT library_info = {};
+                           library_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+                           library_info.pNext = &fixed.rendering;
+                           library_info.flags = part;
+
+                           pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+                           pipeline_info.pNext = &library_info;
+                           pipeline_info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+                               VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+                           return create_pipeline(pipeline_info);
+                       });
+    };
+
+    // Each library picks the dynamic states it owns out of the shared list: the topology, then viewport, scissor, cull
+    // mode and front face, then the depth states.
+    const std::array<VkPipeline, 4> libraries = {
+        get_library(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+                    {
+                        .pVertexInputState = &fixed.vertex_input.pipeline,
+                        .pInputAssemblyState = &fixed.input_assembly,
+                        .pDynamicState = &fixed.dynamic,
+                    }),
+        get_library(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+                    {
+                        .stageCount = 1,
+                        .pStages = &vertex_stage,
+                        .pViewportState = &fixed.viewport,
+                        .pRasterizationState = &fixed.rasterization,
+                        .pDynamicState = &fixed.dynamic,
+                        .layout = m_pipeline_layout,
+                    }),
+        get_library(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+                    {
+                        .stageCount = 1,
+                        .pStages = &fragment_stage,
+                        .pMultisampleState = &fixed.multisample,
+                        .pDepthStencilState = &fixed.depth_stencil,
+                        .pDynamicState = &fixed.dynamic,
+                        .layout = m_pipeline_layout,
+                    }),
+        get_library(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+                    {
+                        .pMultisampleState = &fixed.multisample,
+                        .pColorBlendState = &fixed.color_blend,
+                    }),
+    };
+
+    VkPipelineLibraryCreateInfoKHR link_info = {};
+    link_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    link_info.libraryCount = static_cast<uint32_t>(libraries.size());
+    link_info.pLibraries = libraries.data();
+
+    VkGraphicsPipelineCreateInfo pipeline_info = {};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.pNext = &link_info;
+    pipeline_info.layout = m_pipeline_layout;
+
+    publish(job, create_pipeline(pipeline_info), false);
+
+    pipeline_info.flags = VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+    publish(job, create_pipeline(pipeline_info), true);
+}
+
+// Two workers may build the same library at once; the one that finishes second destroys its copy and uses the first.
+VkPipeline PipelineManager::library(const LibraryKey& key, const std::function<VkPipeline()>& create)
+{
+    {
+        std::scoped_lock lock(m_library_mutex);
+        if (auto found = m_libraries.find(key); found != m_libraries.end())
+        {
+            return found->second;
+        }
+    }
+
+    auto* created = create();
+
+    std::scoped_lock lock(m_library_mutex);
+    const auto [it, inserted] = m_libraries.try_emplace(key, created);
+    if (!inserted)
+    {
+        vkDestroyPipeline(m_device, created, nullptr);
+    }
+
+    return it->second;
+}
+
+// The fields each part is built from: the vertex input interface from the vertex shader's inputs and the topology, the
+// pre-rasterization shaders from the vertex shader and the cull state, the fragment shader from itself and the depth
+// state, and the fragment output interface from blending. Dynamic raster fields have already been reset by request.
+PipelineManager::LibraryKey PipelineManager::library_key(VkGraphicsPipelineLibraryFlagsEXT part,
+                                                         const PipelineState& state,
+                                                         const ShaderModule& vertex_shader,
+                                                         const ShaderModule& fragment_shader)
+{
+    LibraryKey result = {.part = part, .state = {}, .shader_hash = 0, .input_locations = {}};
+    result.state.dynamic_raster = state.dynamic_raster;
+
+    switch (part)
+    {
+    case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+        result.state.raster.topology = state.raster.topology;
+        result.input_locations = vertex_shader.reflection().input_locations;
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+        result.state.specialization = state.specialization;
+        result.state.raster.cull_mode = state.raster.cull_mode;
+        result.state.raster.front_face = state.raster.front_face;
+        result.state.color_format = state.color_format;
+        result.state.depth_format = state.depth_format;
+        result.shader_hash = vertex_shader.code_hash();
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+        result.state.specialization = state.specialization;
+        result.state.raster.depth_test = state.raster.depth_test;
+        result.state.raster.depth_write = state.raster.depth_write;
+        result.state.raster.depth_compare_op = state.raster.depth_compare_op;
+        result.state.color_format = state.color_format;
+        result.state.depth_format = state.depth_format;
+        result.state.samples = state.samples;
+        result.shader_hash = fragment_shader.code_hash();
+        break;
+    default:
+        result.state.blend = state.blend;
+        result.state.color_format = state.color_format;
+        result.state.depth_format = state.depth_format;
+        result.state.samples = state.samples;
+        break;
+    }
+
+    return result;
+}
+
+void PipelineManager::publish(const CompileJob& job, VkPipeline pipeline, bool optimized)
+{
+    std::scoped_lock lock(m_mutex);
+    m_compiled.push_back(
+        {.handle = job.handle, .generation = job.generation, .pipeline = pipeline, .optimized = optimized});
+}
+
+VkPipeline PipelineManager::create_pipeline(const VkGraphicsPipelineCreateInfo& pipeline_info) const
+{
+    VkPipeline pipeline = nullptr;
+    if (vkCreateGraphicsPipelines(m_device, m_pipeline_cache, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create pipeline");
+    }
+
+    return pipeline;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "device.h"
+#include "pipeline_cache.h"
+#include "pipeline_state.h"
+#include "render_pass.h"
+#include "shader_module.h"
+#include "shader_module_cache.h"
+#include "util/hash.h"
+#include "util/no_copy_or_move.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// Compiles graphics pipelines in the background. request returns a handle at once and worker threads build the
+// pipeline; until update has published it, get returns VK_NULL_HANDLE and draws using it are skipped. Where
+// VK_EXT_graphics_pipeline_library is supported a pipeline is first built from libraries and fast-linked, so it can be
+// drawn with sooner, and then relinked with link time optimization; the fast-linked pipeline is kept until the frames
+// in flight are done with it. Each library is cached under the parts of the state it is built from, so a new state
+// only builds the libraries no earlier state shared with it. All pipelines share one layout and are compatible with
+// one render pass. With dynamic raster state, states that differ only in their RasterState map to one pipeline and the
+// draw sets it instead.
+class PipelineManager : NoCopyOrMove
+{
+  public:
+    using Handle = uint32_t;
+
+    // Handles count up from 1 and fit the pipeline field of a draw key, where 0 stands for the scene's own pipeline.
+    static constexpr uint32_t kMaxPipelines = 255;
+
+  private:
+    // A pipeline is compiled again when one of its shaders changes; the generation tells the compiles apart, so that
+    // an older one finishing late cannot replace a newer one.
+    struct CompileJob
+    {
+        Handle handle;
+        uint32_t generation;
+        PipelineState state;
+    };
+
+    struct Compiled
+    {
+        Handle handle;
+        uint32_t generation;
+        VkPipeline pipeline;
+        bool optimized;
+    };
+
+    struct Entry
+    {
+        PipelineState state;
+        VkPipeline pipeline;
+        bool optimized;
+        uint32_t generation;
+        uint32_t published_generation;
+    };
+
+    struct Retired
+    {
+        uint64_t frame;
+        VkPipeline pipeline;
+    };
+
+    // Identifies a pipeline library: state keeps only the fields the part is built from, the others left at their
+    // defaults, and shader_hash and input_locations stand for the shader versions it uses.
+    struct LibraryKey
+    {
+        VkGraphicsPipelineLibraryFlagsEXT part;
+        PipelineState state;
+        uint64_t shader_hash;
+        std::vector<uint32_t> input_locations;
+
+        bool operator==(const LibraryKey& other) const = default;
+    };
+
+    struct LibraryKeyHash
+    {
+        size_t operator()(const LibraryKey& key) const
+        {
+            size_t hash = PipelineStateHash{}(key.state);
+
+            hash_combine(hash, key.part);
+            hash_combine(hash, key.shader_hash);
+            for (const auto location : key.input_locations)
+            {
+                hash_combine(hash, location);
+            }
+
+            return hash;
+        }
+    };
+
+    const Device& m_device;
+    ShaderModuleCache& m_shader_modules;
+    const PipelineCache& m_pipeline_cache;
+    const VkPipelineLayout m_pipeline_layout;
+    const VkFormat m_color_format;
+    const bool m_dynamic_raster_state;
+
+    // Only touched on the render thread.
+    std::vector<Entry> m_entries;
+    std::unordered_map<PipelineState, Handle, PipelineStateHash> m_handles;
+    std::deque<Retired> m_retired;
+    uint64_t m_frame = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_condition;
+    std::deque<CompileJob> m_jobs;
+    std::vector<Compiled> m_compiled;
+
+    // Libraries are kept until the manager is destroyed, those of replaced shader versions included.
+    std::mutex m_library_mutex;
+    std::unordered_map<LibraryKey, VkPipeline, LibraryKeyHash> m_libraries;
+
+    std::vector<std::jthread> m_workers;
+
+    std::vector<std::jthread> create_workers();
+
+    void compile(std::stop_token stop_token);
+    void compile_monolithic(const CompileJob& job);
+    void compile_libraries(const CompileJob& job);
+    VkPipeline library(const LibraryKey& key, const std::function<VkPipeline()>& create);
+    void queue(Handle handle);
+    void publish(const CompileJob& job, VkPipeline pipeline, bool optimized);
+
+    VkPipeline create_pipeline(const VkGraphicsPipelineCreateInfo& pipeline_info) const;
+
+    static LibraryKey library_key(VkGraphicsPipelineLibraryFlagsEXT part,
+                                  const PipelineState& state,
+                                  const ShaderModule& vertex_shader,
+                                  const ShaderModule& fragment_shader);
+
+  public:
+    PipelineManager(const Device& device,
+                    ShaderModuleCache& shader_modules,
+                    const PipelineCache& pipeline_cache,
+                    VkPipelineLayout pipeline_layout,
+                    const RenderPass& render_pass,
+                    bool dynamic_raster_state);
+    ~PipelineManager();
+
+    // Default state for the given shaders, with the attachment formats and sample count of the render pass.
+    PipelineState state(const std::string& vertex_shader,
+                        const std::string& fragment_shader,
+                        const SpecializationConstants& specialization = {}) const;
+
+    // Returns the handle of the pipeline for state, queueing it to be compiled the first time state is seen.
+    Handle request(const PipelineState& requested);
+
+    // Compiles every pipeline using shader again, from its current source; each keeps drawing with its previous
+    // pipeline until the new one is published. Returns the number of pipelines queued.
+    size_t reload(const std::string& shader);
+
+    // Publishes the pipelines compiled since the previous call and destroys those replaced long enough ago. Called
+    // once per frame on the render thread, after the frame's fence has been waited on.
+    void update();
+
+    // The best pipeline compiled so far for handle, or VK_NULL_HANDLE when none is ready yet.
+    VkPipeline get(Handle handle) const
+    {
+        return handle > 0 && handle <= m_entries.size() ? m_entries[handle - 1].pipeline : VK_NULL_HANDLE;
+    }
+
+    // True when the pipelines leave their RasterState to be set with RasterState::set before drawing.
+    bool dynamic_raster_state() const
+    {
+        return m_dynamic_raster_state;
+    }
+
+    // True once the final, link time optimized or monolithic, pipeline for handle is in use.
+    bool optimized(Handle handle) const
+    {
+        return handle > 0 && handle <= m_entries.size() && m_entries[handle - 1].optimized;
+    }
+};
+} // namespace steeplejack
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "raster_state.h"
+#include "util/hash.h"
+#include "util/specialization_constants.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// Everything a graphics pipeline is built from apart from its layout, which all pipelines share, and its vertex input,
+// which is reflected from the vertex shader. Equal states make the same pipeline, so each distinct state is compiled
+// once.
+struct PipelineState
+{
+    std::string vertex_shader;
+    std::string fragment_shader;
+    // Shared by both stages; variants of the same shaders are told apart by these.
+    SpecializationConstants specialization;
+
+    // Baked into the pipeline unless dynamic_raster is set, in which case baked() leaves it out and it is set per draw
+    // instead.
+    RasterState raster;
+    bool dynamic_raster = false;
+    bool blend = false;
+
+    VkFormat color_format = VK_FORMAT_UNDEFINED;
+    VkFormat depth_format = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    bool operator==(const PipelineState& other) const = default;
+
+    // The state the pipeline is built from, with the raster state reset when it is dynamic, so that states differing
+    // only in it compare equal and PipelineManager::request hands them the same pipeline.
+    PipelineState baked() const
+    {
+        auto result = *this;
+        if (result.dynamic_raster)
+        {
+            result.raster = {};
+        }
+
+        return result;
+    }
+};
+
+struct PipelineStateHash
+{
+    size_t operator()(const PipelineState& state) const
+    {
+        size_t hash = 0;
+
+        hash_combine(hash, std::hash<std::string>{}(state.vertex_shader));
+        hash_combine(hash, std::hash<std::string>{}(state.fragment_shader));
+        hash_combine(hash, state.specialization.hash());
+
+        hash_combine(hash, RasterStateHash{}(state.raster));
+        hash_combine(hash, (state.dynamic_raster ? 1U : 0U) | (state.blend ? 2U : 0U));
+        hash_combine(hash, state.color_format);
+        hash_combine(hash, state.depth_format);
+        hash_combine(hash, state.samples);
+
+        return hash;
+    }
+};
+} // namespace steeplejack
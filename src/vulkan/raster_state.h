@@ -0,0 +1,62 @@
+#pragma once
+
+#include "util/hash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// The rasterization and depth state that Vulkan 1.3 lets a pipeline leave dynamic: cull mode, front face, depth test,
+// depth write, depth compare op and primitive topology. A pipeline built with dynamic raster state draws with
+// whatever set last recorded, so draws that differ only in these share the pipeline; otherwise they are baked in.
+// Topology may only change within its class, so triangle lists stay triangle lists.
+struct RasterState
+{
+    VkCullModeFlags cull_mode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    bool depth_test = true;
+    bool depth_write = true;
+    VkCompareOp depth_compare_op = VK_COMPARE_OP_LESS;
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    static constexpr VkDynamicState kDynamicStates[] = {
+        VK_DYNAMIC_STATE_CULL_MODE,
+        VK_DYNAMIC_STATE_FRONT_FACE,
+        VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+        VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+        VK_DYNAMIC_STATE_DEPTH_COMPARE_OP,
+        VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+    };
+
+    bool operator==(const RasterState& other) const = default;
+
+    // Records the state for the draws that follow, which must use a pipeline built with kDynamicStates.
+    void set(VkCommandBuffer command_buffer) const
+    {
+        vkCmdSetCullMode(command_buffer, cull_mode);
+        vkCmdSetFrontFace(command_buffer, front_face);
+        vkCmdSetDepthTestEnable(command_buffer, depth_test ? VK_TRUE : VK_FALSE);
+        vkCmdSetDepthWriteEnable(command_buffer, depth_write ? VK_TRUE : VK_FALSE);
+        vkCmdSetDepthCompareOp(command_buffer, depth_compare_op);
+        vkCmdSetPrimitiveTopology(command_buffer, topology);
+    }
+};
+
+struct RasterStateHash
+{
+    size_t operator()(const RasterState& state) const
+    {
+        size_t hash = 0;
+
+        hash_combine(hash, state.cull_mode);
+        hash_combine(hash, state.front_face);
+        hash_combine(hash, (state.depth_test ? 1U : 0U) | (state.depth_write ? 2U : 0U));
+        hash_combine(hash, state.depth_compare_op);
+        hash_combine(hash, state.topology);
+
+        return hash;
+    }
+};
+} // namespace steeplejack
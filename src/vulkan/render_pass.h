@@ -1,36 +1,83 @@
 #pragma once
 
-#include "depth_buffer.h"
 #include "device.h"
-#include "swapchain.h"
 #include "util/no_copy_or_move.h"
 
+#include <vulkan/vulkan.h>
+
 namespace steeplejack
 {
+// A pass drawn with dynamic rendering into one color attachment, multisampled and resolved when the device uses MSAA,
+// and one depth attachment. It only holds the attachment formats and sample count, which pipelines are built against,
+// so it outlives swapchain recreation unless the swapchain's image format changes; the images are given each frame.
 class RenderPass : NoCopyOrMove
 {
+  public:
+    // An image rendered to and the view it is rendered through.
+    struct Attachment
+    {
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+    };
+
   private:
     const Device& m_device;
-    const Swapchain& m_swapchain;
+    const VkFormat m_color_format;
+    const VkFormat m_depth_format;
+    const VkSampleCountFlagBits m_samples;
 
-    const VkRenderPass m_render_pass;
+    const VkPipelineRenderingCreateInfo m_pipeline_rendering_info;
 
-    VkRenderPass create_render_pass(const DepthBuffer& depth_buffer) const;
+    VkPipelineRenderingCreateInfo create_pipeline_rendering_info() const;
+
+    static void transition(VkCommandBuffer command_buffer,
+                           VkImage image,
+                           VkImageAspectFlags aspect,
+                           VkImageLayout old_layout,
+                           VkImageLayout new_layout,
+                           VkPipelineStageFlags src_stage,
+                           VkAccessFlags src_access,
+                           VkPipelineStageFlags dst_stage,
+                           VkAccessFlags dst_access);
 
   public:
-    RenderPass(const Device& device, const Swapchain& swapchain, const DepthBuffer& depth_buffer);
+    RenderPass(const Device& device, VkFormat color_format);
     ~RenderPass();
 
-    operator VkRenderPass() const
+    VkFormat color_format() const
     {
-        return m_render_pass;
+        return m_color_format;
     }
 
-    void begin(VkCommandBuffer command_buffer, VkFramebuffer framebuffer) const;
+    VkFormat depth_format() const
+    {
+        return m_depth_format;
+    }
 
-    void end(VkCommandBuffer command_buffer) const
+    VkSampleCountFlagBits samples() const
     {
-        vkCmdEndRenderPass(command_buffer);
+        return m_samples;
     }
+
+    bool multisampled() const
+    {
+        return m_samples != VK_SAMPLE_COUNT_1_BIT;
+    }
+
+    // Chained into VkGraphicsPipelineCreateInfo::pNext in place of a VkRenderPass.
+    const VkPipelineRenderingCreateInfo& pipeline_rendering_info() const
+    {
+        return m_pipeline_rendering_info;
+    }
+
+    // Clears and starts rendering to output, through multisampled_color when the pass is multisampled, and to depth.
+    void begin(VkCommandBuffer command_buffer,
+               VkExtent2D extent,
+               Attachment output,
+               Attachment multisampled_color,
+               Attachment depth) const;
+
+    // Ends rendering and leaves output ready to be presented.
+    void end(VkCommandBuffer command_buffer, Attachment output) const;
 };
-} // namespace steeplejack
\ No newline at end of file
+} // namespace steeplejack
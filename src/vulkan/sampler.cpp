@@ -2,11 +2,15 @@
 
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 using namespace steeplejack;
 
-Sampler::Sampler(const Device& device) : m_device(device), m_sampler(create_sampler()) {}
+Sampler::Sampler(const Device& device, const SamplerState& state) :
+    m_device(device), m_state(state), m_sampler(create_sampler())
+{
+}
 
 Sampler::~Sampler()
 {
@@ -20,21 +24,24 @@ VkSampler Sampler::create_sampler()
 
     VkSamplerCreateInfo sampler_info = {};
     sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    sampler_info.magFilter = VK_FILTER_LINEAR;
-    sampler_info.minFilter = VK_FILTER_LINEAR;
-    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.anisotropyEnable = VK_TRUE;
-    sampler_info.maxAnisotropy = m_device.properties().limits.maxSamplerAnisotropy;
+    const float max_anisotropy =
+        std::min(m_state.max_anisotropy, m_device.properties().limits.maxSamplerAnisotropy);
+
+    sampler_info.magFilter = m_state.filter;
+    sampler_info.minFilter = m_state.filter;
+    sampler_info.addressModeU = m_state.address_mode;
+    sampler_info.addressModeV = m_state.address_mode;
+    sampler_info.addressModeW = m_state.address_mode;
+    sampler_info.anisotropyEnable = max_anisotropy > 1.0F ? VK_TRUE : VK_FALSE;
+    sampler_info.maxAnisotropy = std::max(max_anisotropy, 1.0F);
     sampler_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     sampler_info.unnormalizedCoordinates = VK_FALSE;
     sampler_info.compareEnable = VK_FALSE;
     sampler_info.compareOp = VK_COMPARE_OP_ALWAYS;
-    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_info.mipmapMode = m_state.mipmap_mode;
     sampler_info.mipLodBias = 0.0F;
-    sampler_info.minLod = 0.0F;
-    sampler_info.maxLod = 0.0F;
+    sampler_info.minLod = m_state.min_lod;
+    sampler_info.maxLod = m_state.max_lod;
 
     VkSampler sampler = nullptr;
     if (vkCreateSampler(m_device, &sampler_info, nullptr, &sampler) != VK_SUCCESS)
@@ -1,23 +1,47 @@
 #pragma once
 
 #include "device.h"
+#include "util/no_copy_or_move.h"
 
+#include <limits>
 #include <vulkan/vulkan.h>
 
 namespace steeplejack
 {
-class Sampler
+// Filtering, addressing and level of detail range of a sampler. The defaults are trilinear, repeating and as
+// anisotropic as the device allows; a max_anisotropy of 1 or less turns anisotropic filtering off.
+struct SamplerState
+{
+    static constexpr float kDeviceMaxAnisotropy = std::numeric_limits<float>::max();
+
+    VkFilter filter = VK_FILTER_LINEAR;
+    VkSamplerMipmapMode mipmap_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    VkSamplerAddressMode address_mode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    float max_anisotropy = kDeviceMaxAnisotropy;
+    float min_lod = 0.0F;
+    float max_lod = VK_LOD_CLAMP_NONE;
+
+    bool operator==(const SamplerState& other) const = default;
+};
+
+class Sampler : NoCopyOrMove
 {
   private:
     const Device& m_device;
+    const SamplerState m_state;
     const VkSampler m_sampler;
 
     VkSampler create_sampler();
 
   public:
-    Sampler(const Device& device);
+    Sampler(const Device& device, const SamplerState& state = {});
     ~Sampler();
 
+    const SamplerState& state() const
+    {
+        return m_state;
+    }
+
     operator VkSampler() const
     {
         return m_sampler;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "device.h"
+#include "sampler.h"
+#include "util/hash.h"
+#include "util/no_copy_or_move.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// Hands out one Sampler per distinct SamplerState, created on first use and kept until the cache is destroyed. States
+// are first clamped to the device's limits, so that states which would create identical samplers share one. Use from
+// the render thread only.
+class SamplerCache : NoCopyOrMove
+{
+  private:
+    struct StateHash
+    {
+        size_t operator()(const SamplerState& state) const
+        {
+            size_t hash = 0;
+
+            hash_combine(hash, state.filter);
+            hash_combine(hash, state.mipmap_mode);
+            hash_combine(hash, state.address_mode);
+            hash_combine(hash, std::bit_cast<uint32_t>(state.max_anisotropy));
+            hash_combine(hash, std::bit_cast<uint32_t>(state.min_lod));
+            hash_combine(hash, std::bit_cast<uint32_t>(state.max_lod));
+
+            return hash;
+        }
+    };
+
+    const Device& m_device;
+
+    std::unordered_map<SamplerState, std::unique_ptr<Sampler>, StateHash> m_samplers;
+
+    SamplerState normalize(SamplerState state) const
+    {
+        state.max_anisotropy =
+            std::max(std::min(state.max_anisotropy, m_device.properties().limits.maxSamplerAnisotropy), 1.0F);
+
+        return state;
+    }
+
+  public:
+    SamplerCache(const Device& device) : m_device(device) {}
+
+    const Sampler& get(const SamplerState& state = {})
+    {
+        const auto key = normalize(state);
+
+        auto& sampler = m_samplers[key];
+        if (sampler == nullptr)
+        {
+            sampler = std::make_unique<Sampler>(m_device, key);
+        }
+
+        return *sampler;
+    }
+
+    size_t size() const
+    {
+        return m_samplers.size();
+    }
+};
+} // namespace steeplejack
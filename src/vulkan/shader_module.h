@@ -2,26 +2,31 @@
 
 #include "device.h"
 #include "util/no_copy_or_move.h"
+#include "util/spirv_code.h"
+#include "util/spirv_reflection.h"
 
+#include <cstdint>
 #include <string>
 
 namespace steeplejack
 {
+// Created through ShaderModuleCache, which shares one module per shader between all the pipelines built from it.
 class ShaderModule : NoCopyOrMove
 {
   private:
     const Device& m_device;
 
     const std::string m_name;
+    const uint64_t m_code_hash;
 
+    SpirvReflection m_reflection;
     VkShaderModule m_shader_module;
 
-    static std::vector<char> read_file(const std::string& name);
-
-    VkShaderModule create_shader_module();
+    VkShaderModule create_shader_module(const SpirvCode& code);
 
   public:
-    ShaderModule(const Device& device, std::string name);
+    // name, such as mesh.frag, is only for logs and errors; the code need not outlive the module.
+    ShaderModule(const Device& device, std::string name, const SpirvCode& code);
     ~ShaderModule();
 
     const std::string& name() const
@@ -29,6 +34,18 @@ class ShaderModule : NoCopyOrMove
         return m_name;
     }
 
+    // Hash of the SPIR-V the module was created from, which tells versions of a shader apart.
+    uint64_t code_hash() const
+    {
+        return m_code_hash;
+    }
+
+    // The interface of the shader, read from its SPIR-V when it was loaded.
+    const SpirvReflection& reflection() const
+    {
+        return m_reflection;
+    }
+
     operator VkShaderModule() const
     {
         return m_shader_module;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "device.h"
+#include "shader_module.h"
+#include "util/no_copy_or_move.h"
+#include "util/shader_compiler.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace steeplejack
+{
+// Hands out one ShaderModule per shader name and version, shared by every pipeline built from it, so that building
+// pipelines again, for another state or after a swapchain change, neither creates modules nor reflects SPIR-V anew.
+// Each get loads the shader's SPIR-V, which is memory mapped and cheap, and compares the hash of its words with the
+// cached module's: a shader whose source changed gets a new module, and the old one lives on for as long as a
+// pipeline being built still holds it. Safe to use from several threads at once.
+class ShaderModuleCache : NoCopyOrMove
+{
+  private:
+    struct Entry
+    {
+        uint64_t hash;
+        std::shared_ptr<const ShaderModule> module;
+    };
+
+    const Device& m_device;
+    const ShaderCompiler& m_shaders;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_modules;
+
+  public:
+    ShaderModuleCache(const Device& device, const ShaderCompiler& shaders) : m_device(device), m_shaders(shaders) {}
+
+    // The module for the current version of the shader name, such as mesh.frag.
+    std::shared_ptr<const ShaderModule> get(const std::string& name)
+    {
+        // Loading may compile the shader, which is done outside the lock so that other shaders are not held up.
+        const auto code = m_shaders.load(name);
+        const auto hash = code.hash();
+
+        std::scoped_lock lock(m_mutex);
+
+        auto& entry = m_modules[name];
+        if (entry.module == nullptr || entry.hash != hash)
+        {
+            entry = {.hash = hash, .module = std::make_shared<const ShaderModule>(m_device, name, code)};
+        }
+
+        return entry.module;
+    }
+};
+} // namespace steeplejack
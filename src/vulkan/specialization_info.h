@@ -0,0 +1,46 @@
+#pragma once
+
+#include "util/no_copy_or_move.h"
+#include "util/specialization_constants.h"
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// The VkSpecializationInfo of a set of specialization constants, shared by every stage of a pipeline: a stage ignores
+// the constants it does not declare. Shader stage create infos point into it, so it stays put.
+class SpecializationInfo : NoCopyOrMove
+{
+  private:
+    std::vector<VkSpecializationMapEntry> m_entries;
+    std::vector<uint32_t> m_data;
+    VkSpecializationInfo m_info = {};
+
+  public:
+    explicit SpecializationInfo(const SpecializationConstants& constants)
+    {
+        for (const auto& [id, value] : constants.values())
+        {
+            m_entries.push_back({
+                .constantID = id,
+                .offset = static_cast<uint32_t>(m_data.size() * sizeof(uint32_t)),
+                .size = sizeof(uint32_t),
+            });
+            m_data.push_back(value);
+        }
+
+        m_info.mapEntryCount = static_cast<uint32_t>(m_entries.size());
+        m_info.pMapEntries = m_entries.data();
+        m_info.dataSize = m_data.size() * sizeof(uint32_t);
+        m_info.pData = m_data.data();
+    }
+
+    // For VkPipelineShaderStageCreateInfo::pSpecializationInfo; null when no constant is set.
+    const VkSpecializationInfo* get() const
+    {
+        return m_entries.empty() ? nullptr : &m_info;
+    }
+};
+} // namespace steeplejack
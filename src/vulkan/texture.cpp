@@ -1,31 +1,177 @@
 #include "texture.h"
 
-#include "buffer/staging_buffer.h"
 #include "spdlog/spdlog.h"
 #include "stb_image.h"
+#include "upload_batch.h"
+#include "util/ktx2.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <span>
+#include <stdexcept>
 #include <utility>
 
 using namespace steeplejack;
 
-Texture::Texture(const Device& device, const Sampler& sampler, const AdhocQueues& adhoc_queues, std::string name) :
+Texture::Texture(const Device& device,
+                 const Sampler& sampler,
+                 BindlessTextures& bindless_textures,
+                 std::string name,
+                 const TextureData& data) :
     m_device(device),
+    m_sampler(sampler),
+    m_bindless_textures(bindless_textures),
     m_name(std::move(name)),
-    m_image(create_image(adhoc_queues)),
-    m_image_view(m_device, *m_image, VK_IMAGE_ASPECT_COLOR_BIT),
-    m_image_descriptor_info(create_image_descriptor_info(sampler))
+    m_placeholder(nullptr),
+    m_array(nullptr),
+    m_layer(0)
 {
+    auto image = create_image(m_device, data);
+
+    UploadBatch upload_batch(m_device);
+    upload_batch.upload(*image, data);
+    upload_batch.submit();
+    upload_batch.wait();
+
+    set_image(std::move(image), data);
+}
+
+Texture::Texture(const Device& device,
+                 const Sampler& sampler,
+                 BindlessTextures& bindless_textures,
+                 std::string name,
+                 const Texture& placeholder) :
+    m_device(device),
+    m_sampler(sampler),
+    m_bindless_textures(bindless_textures),
+    m_name(std::move(name)),
+    m_placeholder(&placeholder),
+    m_array(nullptr),
+    m_layer(0)
+{
+}
+
+Texture::Texture(const Device& device,
+                 const Sampler& sampler,
+                 BindlessTextures& bindless_textures,
+                 std::string name,
+                 const Texture& array,
+                 uint32_t layer) :
+    m_device(device),
+    m_sampler(sampler),
+    m_bindless_textures(bindless_textures),
+    m_name(std::move(name)),
+    m_placeholder(nullptr),
+    m_array(&array),
+    m_layer(layer)
+{
+}
+
+Texture::~Texture()
+{
+    if (m_bindless_index != BindlessTextures::kNoTexture)
+    {
+        m_bindless_textures.remove(m_bindless_index);
+    }
+}
+
+// Frames in flight may still sample the old slot, and slots in use cannot be updated, so the new image always gets a
+// slot of its own.
+std::unique_ptr<RetiredImage> Texture::set_image(std::unique_ptr<Image> image, const TextureData& data)
+{
+    std::unique_ptr<RetiredImage> retired;
+    if (ready())
+    {
+        retired = std::make_unique<RetiredImage>(
+            m_bindless_textures, std::move(m_image), std::move(m_image_view), m_bindless_index);
+    }
+
+    m_image = std::move(image);
+    // Shaders sample every texture as an array, single images included.
+    m_image_view =
+        std::make_unique<ImageView>(m_device, *m_image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY);
+
+    m_image_descriptor_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    m_image_descriptor_info.imageView = *m_image_view;
+    m_image_descriptor_info.sampler = m_sampler;
+
+    m_bindless_index = m_bindless_textures.add(m_image_descriptor_info);
+
+    m_base_level = data.base_level;
+    m_size = data.full_size;
+    m_level_bytes = data.level_bytes;
+
+    return retired;
+}
+
+// A .ktx2 file next to the requested image is preferred: its levels are uploaded as stored, with no decoding and no
+// mip generation. The requested image is decoded instead when there is none or the device cannot sample its format.
+TextureData
+Texture::load(const Device& device, const AssetReader& assets, const std::string& name, uint32_t base_level)
+{
+    // Names may climb out of assets/textures, as those of model textures do; pack entries only match normal paths.
+    const auto path = (std::filesystem::path("assets/textures") / name).lexically_normal();
+    auto ktx2_path = path;
+    ktx2_path.replace_extension(".ktx2");
+
+    if (assets.exists(ktx2_path.generic_string()))
+    {
+        auto data = read_ktx2(device, assets, ktx2_path.generic_string(), base_level);
+        if (data.has_value())
+        {
+            return std::move(*data);
+        }
+    }
+
+    return decode_image(device, assets, path.generic_string());
 }
 
-std::unique_ptr<Buffer> Texture::create_staging_buffer(const std::string& name, int& width, int& height)
+uint32_t Texture::probe_size(const AssetReader& assets, const std::string& name)
 {
-    auto file_name = "assets/textures/" + name;
+    const auto path = (std::filesystem::path("assets/textures") / name).lexically_normal();
+    auto ktx2_path = path;
+    ktx2_path.replace_extension(".ktx2");
+
+    if (assets.exists(ktx2_path.generic_string()))
+    {
+        const auto ktx2 = Ktx2::parse(assets.read(ktx2_path.generic_string()).view());
+        return std::max(ktx2.width, ktx2.height);
+    }
+
+    const auto file = assets.read(path.generic_string());
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    if (stbi_info_from_memory(reinterpret_cast<const stbi_uc*>(file.view().data()),
+                              static_cast<int>(file.size()),
+                              &width,
+                              &height,
+                              &channels) == 0)
+    {
+        throw std::runtime_error("Failed to load image " + path.generic_string() + ": " + stbi_failure_reason());
+    }
 
+    return static_cast<uint32_t>(std::max(width, height));
+}
+
+// Image files only hold the full resolution, so any level costs decoding the whole file. They are loaded whole, once,
+// with the chain generated on the GPU, and their chain is reported as a single level so that it is never streamed.
+TextureData Texture::decode_image(const Device& device, const AssetReader& assets, const std::string& file_name)
+{
     spdlog::info("Loading image: {}", file_name);
+
+    const auto file = assets.read(file_name);
+
+    int width = 0;
+    int height = 0;
     int channels = 0;
-    auto* pixels = stbi_load(file_name.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    auto* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.view().data()),
+                                         static_cast<int>(file.size()),
+                                         &width,
+                                         &height,
+                                         &channels,
+                                         STBI_rgb_alpha);
 
     if (pixels == nullptr)
     {
@@ -33,92 +179,280 @@ std::unique_ptr<Buffer> Texture::create_staging_buffer(const std::string& name,
     }
 
     const size_t bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * 4U;
-    const auto bytes_view = std::span<const std::byte>(reinterpret_cast<const std::byte*>(pixels), bytes);
-    auto staging_buffer = std::make_unique<StagingBuffer>(m_device, bytes_view);
+    const auto* pixel_bytes = reinterpret_cast<const std::byte*>(pixels);
+    std::vector<std::byte> rgba(pixel_bytes, pixel_bytes + bytes);
 
     stbi_image_free(pixels);
 
-    return staging_buffer;
+    auto data = from_pixels(static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::move(rgba));
+
+    if (supports_linear_blit(device, data.format))
+    {
+        data.mip_levels = Image::full_mip_levels(data.width, data.height);
+        data.generate_mipmaps = true;
+
+        uint64_t chain_bytes = 0;
+        for (uint32_t level = 0; level < data.mip_levels; level++)
+        {
+            chain_bytes += uint64_t{std::max(data.width >> level, 1U)} * std::max(data.height >> level, 1U) * 4U;
+        }
+        data.level_bytes = {chain_bytes};
+    }
+    else
+    {
+        spdlog::warn("Linear blits are not supported for image {}, mipmaps disabled", file_name);
+    }
+
+    return data;
 }
 
-std::unique_ptr<Image> Texture::create_image(const AdhocQueues& adhoc_queues)
+std::optional<TextureData> Texture::read_ktx2(const Device& device,
+                                              const AssetReader& assets,
+                                              const std::string& file_name,
+                                              uint32_t base_level)
 {
-    int width = 0;
-    int height = 0;
-    auto staging_buffer = create_staging_buffer(m_name, width, height);
-    auto image = std::make_unique<Image>(m_device,
-                                         width,
-                                         height,
-                                         VK_FORMAT_R8G8B8A8_SRGB,
-                                         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-                                         VK_IMAGE_TILING_OPTIMAL);
+    spdlog::info("Loading image: {}", file_name);
+
+    auto bytes = assets.read(file_name);
+    const auto ktx2 = Ktx2::parse(bytes.view());
 
-    transition_image_layout(adhoc_queues, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    const auto format = static_cast<VkFormat>(ktx2.vk_format);
+    if (!supports_sampling(device, format))
+    {
+        spdlog::info("Format {} of {} is not supported, falling back to a decoded image", ktx2.vk_format, file_name);
+        return std::nullopt;
+    }
 
-    copy_staging_buffer_to_image(*staging_buffer, adhoc_queues);
+    // Only the levels from base_level down are kept. The file stores them contiguously, so they are cut out as one
+    // range and their offsets rebased onto it.
+    const auto level_count = static_cast<uint32_t>(ktx2.levels.size());
+    base_level = std::min(base_level, level_count - 1);
 
-    transition_image_layout(
-        adhoc_queues, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint64_t first = UINT64_MAX;
+    uint64_t last = 0;
+    std::vector<uint64_t> level_bytes;
+    for (uint32_t level = 0; level < level_count; level++)
+    {
+        const auto& level_info = ktx2.levels[level];
+        level_bytes.push_back(level_info.size);
+
+        if (level >= base_level)
+        {
+            first = std::min(first, level_info.offset);
+            last = std::max(last, level_info.offset + level_info.size);
+        }
+    }
 
-    return image;
+    std::vector<VkBufferImageCopy> regions;
+    for (uint32_t level = base_level; level < level_count; level++)
+    {
+        const auto& level_info = ktx2.levels[level];
+        regions.push_back(
+            create_copy_region(level_info.offset - first, level - base_level, level_info.width, level_info.height));
+    }
+
+    return TextureData{
+        .format = format,
+        .width = ktx2.levels[base_level].width,
+        .height = ktx2.levels[base_level].height,
+        .mip_levels = level_count - base_level,
+        .array_layers = 1,
+        .generate_mipmaps = false,
+        .bytes = std::move(bytes).slice(first, last - first),
+        .regions = std::move(regions),
+        .base_level = base_level,
+        .level_bytes = std::move(level_bytes),
+        .full_size = std::max(ktx2.width, ktx2.height),
+    };
 }
 
-void Texture::transition_image_layout(const AdhocQueues& adhoc_queues,
-                                      VkImageLayout old_layout,
-                                      VkImageLayout new_layout)
+TextureData Texture::from_pixels(uint32_t width, uint32_t height, std::vector<std::byte> rgba)
 {
-    VkCommandBuffer command_buffer = adhoc_queues.graphics().begin();
+    return {
+        .format = VK_FORMAT_R8G8B8A8_SRGB,
+        .width = width,
+        .height = height,
+        .mip_levels = 1,
+        .array_layers = 1,
+        .generate_mipmaps = false,
+        .bytes = Asset(std::move(rgba)),
+        .regions = {create_copy_region(0, 0, width, height)},
+        .base_level = 0,
+        .level_bytes = {uint64_t{width} * height * 4U},
+        .full_size = std::max(width, height),
+    };
+}
 
+TextureData Texture::pack(const std::vector<const TextureData*>& layers)
+{
+    const auto& first = *layers.front();
+
+    std::vector<std::byte> bytes;
+    std::vector<VkBufferImageCopy> regions;
+    for (uint32_t layer = 0; layer < layers.size(); layer++)
+    {
+        const auto& layer_data = *layers[layer];
+        if (layer_data.format != first.format || layer_data.width != first.width ||
+            layer_data.height != first.height || layer_data.mip_levels != first.mip_levels ||
+            layer_data.generate_mipmaps != first.generate_mipmaps || layer_data.array_layers != 1)
+        {
+            throw std::runtime_error("Failed to pack textures: layers differ in format, size or mip levels");
+        }
+
+        const auto offset = bytes.size();
+        const auto layer_bytes = layer_data.bytes.view();
+        bytes.insert(bytes.end(), layer_bytes.begin(), layer_bytes.end());
+
+        for (auto region : layer_data.regions)
+        {
+            region.bufferOffset += offset;
+            region.imageSubresource.baseArrayLayer = layer;
+            regions.push_back(region);
+        }
+    }
+
+    return {
+        .format = first.format,
+        .width = first.width,
+        .height = first.height,
+        .mip_levels = first.mip_levels,
+        .array_layers = static_cast<uint32_t>(layers.size()),
+        .generate_mipmaps = first.generate_mipmaps,
+        .bytes = Asset(std::move(bytes)),
+        .regions = std::move(regions),
+        .base_level = first.base_level,
+        .level_bytes = first.level_bytes,
+        .full_size = first.full_size,
+    };
+}
+
+std::unique_ptr<Image> Texture::create_image(const Device& device, const TextureData& data)
+{
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (data.generate_mipmaps)
+    {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
+    return std::make_unique<Image>(device,
+                                   data.width,
+                                   data.height,
+                                   data.format,
+                                   usage,
+                                   VK_IMAGE_TILING_OPTIMAL,
+                                   VK_SAMPLE_COUNT_1_BIT,
+                                   data.mip_levels,
+                                   data.array_layers);
+}
+
+VkImageMemoryBarrier Texture::create_barrier(const Image& image, VkImageLayout old_layout, VkImageLayout new_layout)
+{
     VkImageMemoryBarrier barrier = {};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = old_layout;
     barrier.newLayout = new_layout;
     barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = *m_image;
+    barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = image.image_info().mip_levels;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-
-    VkPipelineStageFlags source_stage = 0;
-    VkPipelineStageFlags destination_stage = 0;
+    barrier.subresourceRange.layerCount = image.image_info().array_layers;
 
-    if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    return barrier;
+}
 
-        source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-             new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-    {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+// The device always has a dedicated transfer queue family, so the image changes queue family between the upload and
+// its first use and needs a release on the transfer queue matched by an acquire on the graphics queue.
+void Texture::record_upload(VkCommandBuffer command_buffer,
+                            const Device& device,
+                            const Image& image,
+                            const Buffer& staging_buffer,
+                            const TextureData& data)
+{
+    auto barrier = create_barrier(image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+
+    vkCmdCopyBufferToImage(command_buffer,
+                           staging_buffer,
+                           image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(data.regions.size()),
+                           data.regions.data());
+
+    barrier = create_barrier(image,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             data.generate_mipmaps ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                                   : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = device.transfer_queue_index();
+    barrier.dstQueueFamilyIndex = device.graphics_queue_index();
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+}
 
-        source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    }
-    else
+void Texture::record_acquire(VkCommandBuffer command_buffer,
+                             const Device& device,
+                             const Image& image,
+                             const TextureData& data)
+{
+    auto barrier = create_barrier(image,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  data.generate_mipmaps ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                                        : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = data.generate_mipmaps ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+                                                  : VK_ACCESS_SHADER_READ_BIT;
+    barrier.srcQueueFamilyIndex = device.transfer_queue_index();
+    barrier.dstQueueFamilyIndex = device.graphics_queue_index();
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         data.generate_mipmaps ? VK_PIPELINE_STAGE_TRANSFER_BIT
+                                               : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+
+    if (data.generate_mipmaps)
     {
-        throw std::invalid_argument("Unsupported layout transition");
+        record_generate_mipmaps(command_buffer, image);
     }
-
-    vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-    adhoc_queues.graphics().submit_and_wait();
 }
 
-void Texture::copy_staging_buffer_to_image(const Buffer& staging_buffer, const AdhocQueues& adhoc_queues)
+VkBufferImageCopy
+Texture::create_copy_region(VkDeviceSize buffer_offset, uint32_t mip_level, uint32_t width, uint32_t height)
 {
-    VkCommandBuffer command_buffer = adhoc_queues.transfer().begin();
-
     VkImageSubresourceLayers subresource = {};
     subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    subresource.mipLevel = 0;
+    subresource.mipLevel = mip_level;
     subresource.baseArrayLayer = 0;
     subresource.layerCount = 1;
 
@@ -128,29 +462,128 @@ void Texture::copy_staging_buffer_to_image(const Buffer& staging_buffer, const A
     offset.z = 0;
 
     VkExtent3D extent = {};
-    extent.width = m_image->image_info().width;
-    extent.height = m_image->image_info().height;
+    extent.width = width;
+    extent.height = height;
     extent.depth = 1;
 
     VkBufferImageCopy region = {};
-    region.bufferOffset = 0;
+    region.bufferOffset = buffer_offset;
     region.bufferRowLength = 0;
     region.bufferImageHeight = 0;
     region.imageSubresource = subresource;
     region.imageOffset = offset;
     region.imageExtent = extent;
 
-    vkCmdCopyBufferToImage(command_buffer, staging_buffer, *m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    return region;
+}
+
+bool Texture::supports_sampling(const Device& device, VkFormat format)
+{
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(device.physical_device(), format, &properties);
 
-    adhoc_queues.transfer().submit_and_wait();
+    return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
 }
 
-VkDescriptorImageInfo Texture::create_image_descriptor_info(const Sampler& sampler)
+bool Texture::supports_linear_blit(const Device& device, VkFormat format)
 {
-    VkDescriptorImageInfo image_info = {};
-    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    image_info.imageView = m_image_view;
-    image_info.sampler = sampler;
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(device.physical_device(), format, &properties);
+
+    return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
+}
+
+// Level 0 holds the uploaded pixels in TRANSFER_DST_OPTIMAL. Each further level is blitted from the one above it,
+// and every level ends up in SHADER_READ_ONLY_OPTIMAL.
+void Texture::record_generate_mipmaps(VkCommandBuffer command_buffer, const Image& image)
+{
+    auto barrier = create_barrier(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    barrier.subresourceRange.levelCount = 1;
+
+    const auto mip_levels = image.image_info().mip_levels;
+    auto width = static_cast<int32_t>(image.image_info().width);
+    auto height = static_cast<int32_t>(image.image_info().height);
+
+    for (uint32_t level = 1; level < mip_levels; level++)
+    {
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+
+        const int32_t next_width = std::max(width / 2, 1);
+        const int32_t next_height = std::max(height / 2, 1);
+
+        VkImageBlit blit = {};
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {width, height, 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = image.image_info().array_layers;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {next_width, next_height, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = image.image_info().array_layers;
+
+        vkCmdBlitImage(command_buffer,
+                       image,
+                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1,
+                       &blit,
+                       VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+
+        width = next_width;
+        height = next_height;
+    }
 
-    return image_info;
+    // The last level is only ever written.
+    barrier.subresourceRange.baseMipLevel = mip_levels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
 }
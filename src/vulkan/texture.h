@@ -1,48 +1,247 @@
 #pragma once
 
-#include "adhoc_queues.h"
+#include "bindless_textures.h"
 #include "buffer/buffer.h"
-#include "buffer/buffer_host.h"
-#include "descriptor_set_layout.h"
 #include "device.h"
-#include "graphics_pipeline.h"
 #include "image.h"
 #include "image_view.h"
 #include "sampler.h"
-#include "swapchain.h"
+#include "util/asset_reader.h"
 #include "util/no_copy_or_move.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
-#include <vma/vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
 namespace steeplejack
 {
+// Pixels ready for upload: bytes go to a staging buffer unchanged and regions say where each stored level lives. When
+// generate_mipmaps is set only level 0 is stored and the remaining levels are blitted on the GPU. The image may start
+// part way down the source's mip chain: base_level is the level of the full chain that becomes level 0 of the image,
+// and level_bytes gives the size of every level of the full chain, whose level 0 is full_size wide or high, whichever
+// is larger. Arrays store their layers one after another.
+struct TextureData
+{
+    VkFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mip_levels;
+    uint32_t array_layers;
+    bool generate_mipmaps;
+    Asset bytes;
+    std::vector<VkBufferImageCopy> regions;
+    uint32_t base_level;
+    std::vector<uint64_t> level_bytes;
+    uint32_t full_size;
+};
+
+// Image, view and bindless slot that a texture has stopped using. They are released when this is destroyed, which must
+// wait until no frame in flight can still read them.
+class RetiredImage : NoCopyOrMove
+{
+  private:
+    BindlessTextures& m_bindless_textures;
+    const std::unique_ptr<Image> m_image;
+    const std::unique_ptr<ImageView> m_image_view;
+    const uint32_t m_bindless_index;
+
+  public:
+    RetiredImage(BindlessTextures& bindless_textures,
+                 std::unique_ptr<Image> image,
+                 std::unique_ptr<ImageView> image_view,
+                 uint32_t bindless_index) :
+        m_bindless_textures(bindless_textures),
+        m_image(std::move(image)),
+        m_image_view(std::move(image_view)),
+        m_bindless_index(bindless_index)
+    {
+    }
+
+    ~RetiredImage()
+    {
+        m_bindless_textures.remove(m_bindless_index);
+    }
+};
+
 class Texture : public NoCopyOrMove
 {
   private:
     const Device& m_device;
+    const Sampler& m_sampler;
+    BindlessTextures& m_bindless_textures;
     const std::string m_name;
-    const std::unique_ptr<Image> m_image;
-    const ImageView m_image_view;
-    VkDescriptorImageInfo m_image_descriptor_info;
+    const Texture* const m_placeholder;
+    const Texture* const m_array;
+    const uint32_t m_layer;
+
+    std::unique_ptr<Image> m_image;
+    std::unique_ptr<ImageView> m_image_view;
+    VkDescriptorImageInfo m_image_descriptor_info = {};
+    uint32_t m_bindless_index = BindlessTextures::kNoTexture;
 
-    std::unique_ptr<Buffer> create_staging_buffer(const std::string& name, int& width, int& height);
-    std::unique_ptr<Image> create_image(const AdhocQueues& adhoc_queues);
-    VkDescriptorImageInfo create_image_descriptor_info(const Sampler& sampler);
+    uint32_t m_base_level = 0;
+    uint32_t m_size = 0;
+    bool m_failed = false;
+    std::vector<uint64_t> m_level_bytes;
+    float m_screen_size = 0.0F;
 
-    void transition_image_layout(const AdhocQueues& adhoc_queues, VkImageLayout old_layout, VkImageLayout new_layout);
+    static TextureData decode_image(const Device& device, const AssetReader& assets, const std::string& file_name);
+    static std::optional<TextureData>
+    read_ktx2(const Device& device, const AssetReader& assets, const std::string& file_name, uint32_t base_level);
 
-    void copy_staging_buffer_to_image(const Buffer& staging_buffer, const AdhocQueues& adhoc_queues);
+    static VkBufferImageCopy
+    create_copy_region(VkDeviceSize buffer_offset, uint32_t mip_level, uint32_t width, uint32_t height);
+
+    static VkImageMemoryBarrier create_barrier(const Image& image, VkImageLayout old_layout, VkImageLayout new_layout);
+
+    static bool supports_sampling(const Device& device, VkFormat format);
+    static bool supports_linear_blit(const Device& device, VkFormat format);
+
+    static void record_generate_mipmaps(VkCommandBuffer command_buffer, const Image& image);
 
   public:
-    Texture(const Device& device, const Sampler& sampler, const AdhocQueues& adhoc_queues, std::string name);
+    // Uploads data synchronously.
+    Texture(const Device& device,
+            const Sampler& sampler,
+            BindlessTextures& bindless_textures,
+            std::string name,
+            const TextureData& data);
+
+    // Stands in for placeholder until set_image is called.
+    Texture(const Device& device,
+            const Sampler& sampler,
+            BindlessTextures& bindless_textures,
+            std::string name,
+            const Texture& placeholder);
+
+    // Draws from one layer of array, which must outlive it; it has no image of its own.
+    Texture(const Device& device,
+            const Sampler& sampler,
+            BindlessTextures& bindless_textures,
+            std::string name,
+            const Texture& array,
+            uint32_t layer);
+
+    ~Texture();
+
+    // Reads and decodes assets/textures/<name>, preferring a .ktx2 file with the same stem, of which only base_level
+    // and the coarser levels are read. Other images are always loaded whole. Does not touch any queue, so it can run
+    // on any thread.
+    static TextureData
+    load(const Device& device, const AssetReader& assets, const std::string& name, uint32_t base_level = 0);
+
+    // The full_size load would report for assets/textures/<name>, read from the file headers without decoding.
+    static uint32_t probe_size(const AssetReader& assets, const std::string& name);
+
+    static TextureData from_pixels(uint32_t width, uint32_t height, std::vector<std::byte> rgba);
+
+    // Stacks textures of the same format, size and mip chain into the layers of one array.
+    static TextureData pack(const std::vector<const TextureData*>& layers);
+
+    static std::unique_ptr<Image> create_image(const Device& device, const TextureData& data);
+
+    // Records the copy of staging_buffer into image on the transfer queue and releases the image to the graphics
+    // queue. record_acquire must be recorded on the graphics queue afterwards with the same data.
+    static void record_upload(VkCommandBuffer command_buffer,
+                              const Device& device,
+                              const Image& image,
+                              const Buffer& staging_buffer,
+                              const TextureData& data);
+
+    // Acquires the image released by record_upload, builds the mip chain if needed and leaves every level ready for
+    // sampling.
+    static void
+    record_acquire(VkCommandBuffer command_buffer, const Device& device, const Image& image, const TextureData& data);
+
+    const std::string& name() const
+    {
+        return m_name;
+    }
+
+    bool ready() const
+    {
+        return m_image != nullptr;
+    }
+
+    // Set when streaming the texture failed. It keeps drawing what it had, the placeholder when that is nothing, and is
+    // not streamed again.
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+    void set_failed()
+    {
+        m_failed = true;
+    }
+
+    // Makes image, uploaded from data, the content of this texture; it must already be in SHADER_READ_ONLY_OPTIMAL on
+    // the graphics queue. The texture moves to a new bindless slot and the previous image, if any, is returned.
+    std::unique_ptr<RetiredImage> set_image(std::unique_ptr<Image> image, const TextureData& data);
+
+    // Level of the full mip chain held by level 0 of the image.
+    uint32_t base_level() const
+    {
+        return m_base_level;
+    }
+
+    // Width or height, whichever is larger, of level 0 of the full mip chain.
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    const std::vector<uint64_t>& level_bytes() const
+    {
+        return m_level_bytes;
+    }
+
+    // Called while the scene is updated by every mesh using the texture, with the number of pixels it covers.
+    void request_screen_size(float screen_size)
+    {
+        m_screen_size = std::max(m_screen_size, screen_size);
+    }
+
+    // Returns the largest size requested since the previous call, or 0 when the texture was not requested.
+    float take_screen_size()
+    {
+        return std::exchange(m_screen_size, 0.0F);
+    }
 
     VkDescriptorImageInfo* descriptor()
     {
         return &m_image_descriptor_info;
     }
+
+    // Slot of this texture in the bindless texture array, or the placeholder's slot until the texture is ready. Layers
+    // of an array share the array's slot.
+    uint32_t bindless_index() const
+    {
+        if (m_array != nullptr)
+        {
+            return m_array->bindless_index();
+        }
+
+        if (!ready() && m_placeholder != nullptr)
+        {
+            return m_placeholder->bindless_index();
+        }
+
+        return m_bindless_index;
+    }
+
+    // Array layer to sample at bindless_index.
+    uint32_t layer() const
+    {
+        return m_layer;
+    }
 };
-} // namespace steeplejack
\ No newline at end of file
+} // namespace steeplejack
@@ -1,46 +1,298 @@
 #pragma once
 
-#include "vulkan/adhoc_queues.h"
+#include "util/asset_reader.h"
+#include "util/texture_residency.h"
+#include "vulkan/bindless_textures.h"
 #include "vulkan/device.h"
 #include "vulkan/sampler.h"
+#include "vulkan/sampler_cache.h"
 #include "vulkan/texture.h"
+#include "vulkan/texture_streamer.h"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <format>
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace steeplejack
 {
+// Streamed textures start at their coarsest mip level and are then kept at the level their on-screen size needs, within
+// a budget for the bytes they occupy. Textures loaded synchronously are always fully resident and not budgeted. Small
+// textures loaded together are packed into texture arrays, while large ones are streamed. Each texture samples with the
+// sampler for the state it was loaded with, which defaults to trilinear, repeating and fully anisotropic.
 class TextureFactory
 {
+  public:
+    static constexpr uint64_t kDefaultBudget = uint64_t{256} << 20U;
+    static constexpr uint32_t kMaxPackedSize = 256;
+
   private:
+    static constexpr uint32_t kCoarsestLevel = UINT32_MAX;
+
+    struct Retired
+    {
+        uint64_t frame;
+        std::unique_ptr<Texture> texture;
+    };
+
     const Device& m_device;
-    const Sampler& m_sampler;
-    const AdhocQueues& m_adhoc_queues;
+    const AssetReader& m_assets;
+    SamplerCache& m_samplers;
+    BindlessTextures& m_bindless_textures;
 
+    const std::unique_ptr<Texture> m_placeholder;
+    TextureStreamer m_streamer;
+    TextureResidency<Texture*> m_residency;
+
+    std::vector<std::unique_ptr<Texture>> m_arrays;
     std::unordered_map<std::string, std::unique_ptr<Texture>> m_textures;
 
+    // Replaced and removed textures, with their image, view and bindless slot, kept until no frame in flight can still
+    // sample them. Declared after m_arrays so that retired layers go before the arrays they draw from.
+    std::deque<Retired> m_retired;
+    uint64_t m_frame = 0;
+
+    std::unique_ptr<Texture> create_placeholder()
+    {
+        static constexpr std::array<std::byte, 4> kGrey = {
+            std::byte{0x80}, std::byte{0x80}, std::byte{0x80}, std::byte{0xFF}};
+
+        return std::make_unique<Texture>(m_device,
+                                         m_samplers.get(),
+                                         m_bindless_textures,
+                                         "placeholder",
+                                         Texture::from_pixels(1, 1, {kGrey.begin(), kGrey.end()}));
+    }
+
+    void insert(const std::string& name, std::unique_ptr<Texture> texture)
+    {
+        remove_texture(name);
+        m_textures[name] = std::move(texture);
+    }
+
+    void retire(std::unique_ptr<Texture> texture)
+    {
+        m_retired.push_back({.frame = m_frame, .texture = std::move(texture)});
+    }
+
+    // update runs after the fence of the frame about to be recorded has been waited on, so once max_frames_in_flight
+    // more updates have passed no submitted frame can still sample a retired texture.
+    void release_retired()
+    {
+        m_frame++;
+        while (!m_retired.empty() && m_retired.front().frame + Device::max_frames_in_flight <= m_frame)
+        {
+            m_retired.pop_front();
+        }
+    }
+
   public:
-    TextureFactory(const Device& device, const Sampler& sampler, const AdhocQueues& adhoc_queues) :
-        m_device(device), m_sampler(sampler), m_adhoc_queues(adhoc_queues), m_textures()
+    TextureFactory(const Device& device,
+                   const AssetReader& assets,
+                   SamplerCache& samplers,
+                   BindlessTextures& bindless_textures) :
+        m_device(device),
+        m_assets(assets),
+        m_samplers(samplers),
+        m_bindless_textures(bindless_textures),
+        m_placeholder(create_placeholder()),
+        m_streamer(device, assets),
+        m_residency(kDefaultBudget),
+        m_arrays(),
+        m_textures(),
+        m_retired()
+    {
+    }
+
+    void load_texture(const std::string& name, const std::string& texture_name, const SamplerState& sampler = {})
+    {
+        auto data = Texture::load(m_device, m_assets, texture_name);
+        insert(name,
+               std::make_unique<Texture>(m_device, m_samplers.get(sampler), m_bindless_textures, texture_name, data));
+    }
+
+    // Loads (name, texture name) pairs and returns their textures in the same order. Textures no larger than
+    // kMaxPackedSize are loaded synchronously and grouped by format, size and mip chain, and each group becomes one
+    // texture array whose layers are the textures: meshes using them share a bindless slot and are drawn together.
+    // Small textures with nothing to share with stand alone, and larger ones are streamed as by load_texture_async.
+    // All of them sample with sampler.
+    std::vector<Texture*> load_textures(const std::vector<std::pair<std::string, std::string>>& textures,
+                                        const SamplerState& sampler = {})
+    {
+        const auto& texture_sampler = m_samplers.get(sampler);
+
+        using GroupKey = std::tuple<VkFormat, uint32_t, uint32_t, uint32_t, bool>;
+
+        std::vector<Texture*> result(textures.size());
+        std::vector<TextureData> data(textures.size());
+        std::map<GroupKey, std::vector<size_t>> groups;
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            if (Texture::probe_size(m_assets, textures[i].second) > kMaxPackedSize)
+            {
+                result[i] = load_texture_async(textures[i].first, textures[i].second, sampler);
+                continue;
+            }
+
+            data[i] = Texture::load(m_device, m_assets, textures[i].second);
+            groups[{data[i].format, data[i].width, data[i].height, data[i].mip_levels, data[i].generate_mipmaps}]
+                .push_back(i);
+        }
+
+        const size_t max_layers = m_device.properties().limits.maxImageArrayLayers;
+        for (const auto& [key, indexes] : groups)
+        {
+            for (size_t first = 0; first < indexes.size(); first += max_layers)
+            {
+                const size_t last = std::min(first + max_layers, indexes.size());
+                if (last - first == 1)
+                {
+                    const auto i = indexes[first];
+                    auto texture = std::make_unique<Texture>(
+                        m_device, texture_sampler, m_bindless_textures, textures[i].second, data[i]);
+                    result[i] = texture.get();
+                    insert(textures[i].first, std::move(texture));
+                    continue;
+                }
+
+                std::vector<const TextureData*> layers;
+                for (size_t j = first; j < last; j++)
+                {
+                    layers.push_back(&data[indexes[j]]);
+                }
+
+                const auto& array = *m_arrays.emplace_back(
+                    std::make_unique<Texture>(m_device,
+                                              texture_sampler,
+                                              m_bindless_textures,
+                                              std::format("texture array {}", m_arrays.size()),
+                                              Texture::pack(layers)));
+
+                for (size_t j = first; j < last; j++)
+                {
+                    const auto i = indexes[j];
+                    auto texture = std::make_unique<Texture>(m_device,
+                                                             texture_sampler,
+                                                             m_bindless_textures,
+                                                             textures[i].second,
+                                                             array,
+                                                             static_cast<uint32_t>(j - first));
+                    result[i] = texture.get();
+                    insert(textures[i].first, std::move(texture));
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // Returns at once with a texture that draws as a placeholder until update has uploaded the real image.
+    Texture* load_texture_async(const std::string& name,
+                                const std::string& texture_name,
+                                const SamplerState& sampler = {})
     {
+        auto texture = std::make_unique<Texture>(
+            m_device, m_samplers.get(sampler), m_bindless_textures, texture_name, *m_placeholder);
+        m_streamer.load(*texture, kCoarsestLevel);
+
+        auto* result = texture.get();
+        insert(name, std::move(texture));
+
+        return result;
     }
 
-    void load_texture(const std::string& name, const std::string& texture_name)
+    // Completes streamed loads and streams mip levels in and out to follow the sizes requested by the scene since the
+    // previous call; call once per frame from the render thread.
+    void update()
     {
-        m_textures[name] = std::make_unique<Texture>(m_device, m_sampler, m_adhoc_queues, texture_name);
+        release_retired();
+        m_bindless_textures.release_retired();
+
+        const auto results = m_streamer.update();
+        for (auto* texture : results.completed)
+        {
+            if (!m_residency.contains(texture))
+            {
+                m_residency.add(texture, texture->level_bytes(), texture->base_level());
+            }
+        }
+
+        // A texture that failed to stream stops being budgeted, so it is not asked for other levels again.
+        for (auto* texture : results.failed)
+        {
+            m_residency.remove(texture);
+        }
+
+        for (const auto& [name, texture] : m_textures)
+        {
+            const auto screen_size = texture->take_screen_size();
+            if (screen_size > 0.0F && m_residency.contains(texture.get()))
+            {
+                const auto mip_levels = static_cast<uint32_t>(texture->level_bytes().size());
+                const auto level = TextureResidency<Texture*>::required_level(texture->size(), screen_size, mip_levels);
+                m_residency.request(texture.get(), level);
+            }
+        }
+
+        for (const auto& change : m_residency.update())
+        {
+            m_streamer.load(*change.key, change.level);
+        }
+    }
+
+    uint64_t budget() const
+    {
+        return m_residency.budget();
+    }
+
+    void set_budget(uint64_t budget)
+    {
+        m_residency.set_budget(budget);
+    }
+
+    uint64_t resident_bytes() const
+    {
+        return m_residency.resident_bytes();
     }
 
     void remove_texture(const std::string& name)
     {
-        m_textures.erase(name);
+        auto it = m_textures.find(name);
+        if (it != m_textures.end())
+        {
+            m_streamer.cancel(*it->second);
+            m_residency.remove(it->second.get());
+            retire(std::move(it->second));
+            m_textures.erase(it);
+        }
     }
 
+    // Arrays are retired after the textures drawing from their layers, so that they are released after them too.
     void clear()
     {
+        for (auto& [name, texture] : m_textures)
+        {
+            m_streamer.cancel(*texture);
+            m_residency.remove(texture.get());
+            retire(std::move(texture));
+        }
+
+        for (auto& array : m_arrays)
+        {
+            retire(std::move(array));
+        }
+
         m_textures.clear();
+        m_arrays.clear();
     }
 
     Texture* operator[](const std::string& name)
@@ -53,5 +305,10 @@ class TextureFactory
 
         return it->second.get();
     }
+
+    uint32_t bindless_index(const std::string& name)
+    {
+        return (*this)[name]->bindless_index();
+    }
 };
 } // namespace steeplejack
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "texture_streamer.h"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+using namespace steeplejack;
+
+namespace
+{
+constexpr uint32_t kMaxWorkers = 4;
+}
+
+TextureStreamer::TextureStreamer(const Device& device, const AssetReader& assets) :
+    m_device(device), m_assets(assets), m_workers(create_workers())
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    spdlog::info("Destroying Texture Streamer");
+
+    for (auto& worker : m_workers)
+    {
+        worker.request_stop();
+    }
+    m_workers.clear();
+
+    // Each batch waits for the GPU as it is destroyed; with no targets left nothing is handed over.
+    m_targets.clear();
+    m_uploads.clear();
+    m_retired.clear();
+}
+
+std::vector<std::jthread> TextureStreamer::create_workers()
+{
+    const auto count = std::clamp(std::thread::hardware_concurrency(), 2U, kMaxWorkers + 1) - 1;
+
+    std::vector<std::jthread> workers;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        workers.emplace_back([this](std::stop_token stop_token) { decode(stop_token); });
+    }
+
+    return workers;
+}
+
+void TextureStreamer::decode(std::stop_token stop_token)
+{
+    while (true)
+    {
+        DecodeJob job;
+        {
+            std::unique_lock lock(m_mutex);
+            if (!m_condition.wait(lock, stop_token, [this] { return !m_jobs.empty(); }))
+            {
+                return;
+            }
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        try
+        {
+            auto data = Texture::load(m_device, m_assets, job.name, job.base_level);
+
+            std::scoped_lock lock(m_mutex);
+            m_decoded.push_back({.id = job.id, .data = std::move(data)});
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::error("Failed to stream texture {}: {}", job.name, e.what());
+
+            std::scoped_lock lock(m_mutex);
+            m_failed.push_back(job.id);
+        }
+    }
+}
+
+void TextureStreamer::load(Texture& texture, uint32_t base_level)
+{
+    cancel(texture);
+
+    const auto id = m_next_id++;
+    m_targets[id] = &texture;
+
+    {
+        std::scoped_lock lock(m_mutex);
+        m_jobs.push_back({.id = id, .name = texture.name(), .base_level = base_level});
+    }
+
+    m_condition.notify_one();
+}
+
+void TextureStreamer::cancel(const Texture& texture)
+{
+    std::erase_if(m_targets, [&texture](const auto& target) { return target.second == &texture; });
+}
+
+// update runs after the fence of the frame about to be recorded has been waited on, so once max_frames_in_flight more
+// updates have passed no submitted frame can still refer to a retired image.
+TextureStreamer::Results TextureStreamer::update()
+{
+    m_frame++;
+    while (!m_retired.empty() && m_retired.front().frame + Device::max_frames_in_flight <= m_frame)
+    {
+        m_retired.pop_front();
+    }
+
+    std::erase_if(m_uploads, [](const auto& upload) { return upload->poll(); });
+
+    std::vector<DecodedTexture> decoded;
+    std::vector<uint64_t> failed;
+    {
+        std::scoped_lock lock(m_mutex);
+        decoded.swap(m_decoded);
+        failed.swap(m_failed);
+    }
+
+    Results results;
+    for (const auto id : failed)
+    {
+        if (auto target = m_targets.find(id); target != m_targets.end())
+        {
+            target->second->set_failed();
+            results.failed.push_back(target->second);
+            m_targets.erase(target);
+        }
+    }
+
+    std::erase_if(decoded, [this](const DecodedTexture& texture) { return !m_targets.contains(texture.id); });
+    if (!decoded.empty())
+    {
+        submit_uploads(std::move(decoded));
+    }
+
+    results.completed = std::exchange(m_completed, {});
+
+    return results;
+}
+
+void TextureStreamer::submit_uploads(std::vector<DecodedTexture> decoded)
+{
+    auto upload = std::make_unique<UploadBatch>(m_device);
+
+    for (auto& texture : decoded)
+    {
+        auto image = Texture::create_image(m_device, texture.data);
+        upload->upload(*image, texture.data);
+
+        // The pixels are in the staging buffer now; only the description is needed from here on.
+        texture.data.bytes = Asset();
+
+        upload->on_complete(
+            [this, id = texture.id, image = std::move(image), data = std::move(texture.data)]() mutable
+            {
+                auto target = m_targets.find(id);
+                if (target != m_targets.end())
+                {
+                    auto retired = target->second->set_image(std::move(image), data);
+                    if (retired != nullptr)
+                    {
+                        m_retired.push_back({.frame = m_frame, .image = std::move(retired)});
+                    }
+
+                    m_completed.push_back(target->second);
+                    m_targets.erase(target);
+                }
+            });
+    }
+
+    upload->submit();
+    m_uploads.push_back(std::move(upload));
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "device.h"
+#include "texture.h"
+#include "upload_batch.h"
+#include "util/asset_reader.h"
+#include "util/no_copy_or_move.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace steeplejack
+{
+// Loads textures in the background. Worker threads read and decode the files; update, called once per frame on the
+// render thread, records everything decoded since the previous frame into one upload batch and hands the images to
+// their textures once the batch has completed. A texture can be loaded again at another mip level; the image it
+// replaces is kept until the frames in flight are done with it. A load that fails is reported by update and not
+// retried.
+class TextureStreamer : NoCopyOrMove
+{
+  public:
+    struct Results
+    {
+        // Textures that received an image.
+        std::vector<Texture*> completed;
+        // Textures whose load failed; they are marked failed and keep what they had.
+        std::vector<Texture*> failed;
+    };
+
+  private:
+    struct DecodeJob
+    {
+        uint64_t id;
+        std::string name;
+        uint32_t base_level;
+    };
+
+    struct Retired
+    {
+        uint64_t frame;
+        std::unique_ptr<RetiredImage> image;
+    };
+
+    struct DecodedTexture
+    {
+        uint64_t id;
+        TextureData data;
+    };
+
+    const Device& m_device;
+    const AssetReader& m_assets;
+
+    // Only touched on the render thread. Ids rather than pointers identify textures in flight, so that a texture
+    // removed and another created at the same address cannot pick up the wrong image.
+    uint64_t m_next_id = 0;
+    std::unordered_map<uint64_t, Texture*> m_targets;
+    std::vector<std::unique_ptr<UploadBatch>> m_uploads;
+    std::vector<Texture*> m_completed;
+    std::deque<Retired> m_retired;
+    uint64_t m_frame = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_condition;
+    std::deque<DecodeJob> m_jobs;
+    std::vector<DecodedTexture> m_decoded;
+    std::vector<uint64_t> m_failed;
+
+    std::vector<std::jthread> m_workers;
+
+    std::vector<std::jthread> create_workers();
+
+    void decode(std::stop_token stop_token);
+    void submit_uploads(std::vector<DecodedTexture> decoded);
+
+  public:
+    TextureStreamer(const Device& device, const AssetReader& assets);
+    ~TextureStreamer();
+
+    // Queues texture to be loaded from the file named after it, from base_level of its mip chain down. Replaces any
+    // load of the same texture still in flight.
+    void load(Texture& texture, uint32_t base_level);
+
+    // Forgets texture before it is destroyed; any work still in flight for it is discarded.
+    void cancel(const Texture& texture);
+
+    Results update();
+
+    size_t pending() const
+    {
+        return m_targets.size();
+    }
+};
+} // namespace steeplejack
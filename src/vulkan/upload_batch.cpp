@@ -0,0 +1,263 @@
+#include "upload_batch.h"
+
+#include <stdexcept>
+#include <utility>
+
+using namespace steeplejack;
+
+UploadBatch::UploadBatch(const Device& device) :
+    m_device(device),
+    m_transfer_command_pool(create_command_pool(device.transfer_queue_index())),
+    m_graphics_command_pool(create_command_pool(device.graphics_queue_index())),
+    m_transfer_command_buffer(create_command_buffer(m_transfer_command_pool)),
+    m_graphics_command_buffer(create_command_buffer(m_graphics_command_pool)),
+    m_timeline(create_timeline())
+{
+}
+
+UploadBatch::~UploadBatch()
+{
+    // The staging buffers and command buffers must outlive the GPU's use of them, but the callbacks are not run: their
+    // targets may already be gone.
+    if (m_submitted && !m_completed)
+    {
+        VkSemaphoreWaitInfo wait_info = {};
+        wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        wait_info.semaphoreCount = 1;
+        wait_info.pSemaphores = &m_timeline;
+        wait_info.pValues = &kGraphicsDone;
+        vkWaitSemaphores(m_device, &wait_info, UINT64_MAX);
+    }
+
+    vkDestroySemaphore(m_device, m_timeline, nullptr);
+    vkDestroyCommandPool(m_device, m_graphics_command_pool, nullptr);
+    vkDestroyCommandPool(m_device, m_transfer_command_pool, nullptr);
+}
+
+VkCommandPool UploadBatch::create_command_pool(uint32_t queue_family_index)
+{
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.queueFamilyIndex = queue_family_index;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    VkCommandPool command_pool = nullptr;
+    if (vkCreateCommandPool(m_device, &pool_info, nullptr, &command_pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create upload batch command pool");
+    }
+
+    return command_pool;
+}
+
+VkCommandBuffer UploadBatch::create_command_buffer(VkCommandPool command_pool)
+{
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = command_pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+
+    VkCommandBuffer command_buffer = nullptr;
+    if (vkAllocateCommandBuffers(m_device, &alloc_info, &command_buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate upload batch command buffer");
+    }
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to begin recording upload batch command buffer");
+    }
+
+    return command_buffer;
+}
+
+VkSemaphore UploadBatch::create_timeline()
+{
+    VkSemaphoreTypeCreateInfo type_info = {};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphore_info = {};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &type_info;
+
+    VkSemaphore semaphore = nullptr;
+    if (vkCreateSemaphore(m_device, &semaphore_info, nullptr, &semaphore) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create upload batch timeline semaphore");
+    }
+
+    return semaphore;
+}
+
+void UploadBatch::upload(const Buffer& buffer,
+                         std::span<const std::byte> bytes,
+                         VkPipelineStageFlags dst_stage,
+                         VkAccessFlags dst_access)
+{
+    if (m_submitted)
+    {
+        throw std::runtime_error("Failed to record upload: the batch has already been submitted");
+    }
+
+    auto& staging_buffer = *m_staging_buffers.emplace_back(std::make_unique<StagingBuffer>(m_device, bytes));
+
+    VkBufferCopy copy_region = {};
+    copy_region.size = bytes.size();
+    vkCmdCopyBuffer(m_transfer_command_buffer, staging_buffer, buffer, 1, &copy_region);
+
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = m_device.transfer_queue_index();
+    barrier.dstQueueFamilyIndex = m_device.graphics_queue_index();
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    vkCmdPipelineBarrier(m_transfer_command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = dst_access;
+    vkCmdPipelineBarrier(
+        m_graphics_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dst_stage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void UploadBatch::upload(const Image& image, const TextureData& data)
+{
+    if (m_submitted)
+    {
+        throw std::runtime_error("Failed to record upload: the batch has already been submitted");
+    }
+
+    auto& staging_buffer = *m_staging_buffers.emplace_back(std::make_unique<StagingBuffer>(m_device, data.bytes.view()));
+
+    Texture::record_upload(m_transfer_command_buffer, m_device, image, staging_buffer, data);
+    Texture::record_acquire(m_graphics_command_buffer, m_device, image, data);
+}
+
+void UploadBatch::submit()
+{
+    if (m_submitted)
+    {
+        throw std::runtime_error("Failed to submit upload batch: it has already been submitted");
+    }
+
+    submit(m_device.transfer_queue(), m_transfer_command_buffer, 0, kTransferDone);
+    submit(m_device.graphics_queue(), m_graphics_command_buffer, kTransferDone, kGraphicsDone);
+    m_submitted = true;
+}
+
+// wait_value 0 means the submission does not wait.
+void UploadBatch::submit(VkQueue queue, VkCommandBuffer command_buffer, uint64_t wait_value, uint64_t signal_value)
+{
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to record upload batch command buffer");
+    }
+
+    const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = wait_value != 0 ? 1 : 0;
+    timeline_info.pWaitSemaphoreValues = &wait_value;
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues = &signal_value;
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.pNext = &timeline_info;
+    submit_info.waitSemaphoreCount = wait_value != 0 ? 1 : 0;
+    submit_info.pWaitSemaphores = &m_timeline;
+    submit_info.pWaitDstStageMask = &wait_stage;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &m_timeline;
+
+    if (vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to submit upload batch command buffer");
+    }
+}
+
+bool UploadBatch::poll()
+{
+    if (!m_submitted)
+    {
+        return false;
+    }
+
+    if (!m_completed)
+    {
+        uint64_t value = 0;
+        if (vkGetSemaphoreCounterValue(m_device, m_timeline, &value) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to read upload batch timeline semaphore");
+        }
+
+        if (value < kGraphicsDone)
+        {
+            return false;
+        }
+
+        complete();
+    }
+
+    return true;
+}
+
+void UploadBatch::wait()
+{
+    if (!m_submitted)
+    {
+        throw std::runtime_error("Failed to wait for upload batch: it has not been submitted");
+    }
+
+    if (m_completed)
+    {
+        return;
+    }
+
+    VkSemaphoreWaitInfo wait_info = {};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &m_timeline;
+    wait_info.pValues = &kGraphicsDone;
+    if (vkWaitSemaphores(m_device, &wait_info, UINT64_MAX) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to wait for upload batch");
+    }
+
+    complete();
+}
+
+// The staging memory is no longer needed once the GPU is done; callbacks may start new batches.
+void UploadBatch::complete()
+{
+    m_completed = true;
+    m_staging_buffers.clear();
+
+    auto callbacks = std::move(m_callbacks);
+    for (auto& callback : callbacks)
+    {
+        callback();
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "buffer/buffer.h"
+#include "buffer/staging_buffer.h"
+#include "device.h"
+#include "image.h"
+#include "texture.h"
+#include "util/no_copy_or_move.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace steeplejack
+{
+// Records many uploads into one transfer and one graphics command buffer that are submitted together. Copies run on
+// the dedicated transfer queue; ownership of every destination is then released to the graphics queue and acquired
+// there, where images also get their mip chains and final layouts. A timeline semaphore orders the two submissions and
+// tells when the batch is done.
+class UploadBatch : NoCopyOrMove
+{
+  private:
+    static constexpr uint64_t kTransferDone = 1;
+    static constexpr uint64_t kGraphicsDone = 2;
+
+    const Device& m_device;
+
+    const VkCommandPool m_transfer_command_pool;
+    const VkCommandPool m_graphics_command_pool;
+    const VkCommandBuffer m_transfer_command_buffer;
+    const VkCommandBuffer m_graphics_command_buffer;
+    const VkSemaphore m_timeline;
+
+    std::vector<std::unique_ptr<StagingBuffer>> m_staging_buffers;
+    std::vector<std::move_only_function<void()>> m_callbacks;
+
+    bool m_submitted = false;
+    bool m_completed = false;
+
+    VkCommandPool create_command_pool(uint32_t queue_family_index);
+    VkCommandBuffer create_command_buffer(VkCommandPool command_pool);
+    VkSemaphore create_timeline();
+
+    void submit(VkQueue queue, VkCommandBuffer command_buffer, uint64_t wait_value, uint64_t signal_value);
+    void complete();
+
+  public:
+    UploadBatch(const Device& device);
+    ~UploadBatch();
+
+    // Copies bytes into buffer, which is then visible to dst_access in dst_stage on the graphics queue.
+    void upload(const Buffer& buffer,
+                std::span<const std::byte> bytes,
+                VkPipelineStageFlags dst_stage,
+                VkAccessFlags dst_access);
+
+    void upload(const Buffer& buffer,
+                const std::ranges::contiguous_range auto& range,
+                VkPipelineStageFlags dst_stage,
+                VkAccessFlags dst_access)
+    {
+        upload(buffer, std::as_bytes(std::span(range)), dst_stage, dst_access);
+    }
+
+    // Uploads data into image and leaves every level ready for sampling in the fragment shader.
+    void upload(const Image& image, const TextureData& data);
+
+    // Runs on the thread that polls or waits for the batch, once the GPU has finished it.
+    void on_complete(std::move_only_function<void()> callback)
+    {
+        m_callbacks.push_back(std::move(callback));
+    }
+
+    void submit();
+
+    // Returns true once the batch has completed; the callbacks run on the first call that sees it complete.
+    bool poll();
+
+    void wait();
+};
+} // namespace steeplejack
@@ -1,9 +1,28 @@
 #include "vertex.h"
 
 #include <stdexcept>
+#include <string>
 
 using namespace steeplejack;
 
+std::vector<VertexComponent> Vertex::components(std::span<const uint32_t> locations)
+{
+    std::vector<VertexComponent> result;
+    result.reserve(locations.size());
+    for (auto location : locations)
+    {
+        if (location >= kAllComponents.size())
+        {
+            throw std::runtime_error("Vertex shader input at location " + std::to_string(location) +
+                                     " has no vertex component");
+        }
+
+        result.push_back(static_cast<VertexComponent>(location));
+    }
+
+    return result;
+}
+
 VertexInputState::VertexInputState(uint32_t binding, std::span<const VertexComponent> components) :
     binding(create_binding(binding)), attributes(create_attributes(components)), pipeline(create_pipeline())
 {
@@ -18,10 +37,10 @@ VkVertexInputBindingDescription VertexInputState::create_binding(uint32_t bindin
     });
 }
 
-VkVertexInputAttributeDescription VertexInputState::create_attribute(uint32_t location, VertexComponent component) const
+VkVertexInputAttributeDescription VertexInputState::create_attribute(VertexComponent component) const
 {
     VkVertexInputAttributeDescription description{};
-    description.location = location;
+    description.location = static_cast<uint32_t>(component);
     description.binding = binding.binding;
 
     switch (component)
@@ -50,9 +69,9 @@ VertexInputState::create_attributes(std::span<const VertexComponent> components)
 {
     std::vector<VkVertexInputAttributeDescription> descriptions;
     descriptions.reserve(components.size());
-    for (uint32_t location = 0; location < components.size(); location++)
+    for (auto component : components)
     {
-        descriptions.push_back(create_attribute(location, components[location]));
+        descriptions.push_back(create_attribute(component));
     }
 
     return descriptions;
@@ -9,6 +9,7 @@
 
 namespace steeplejack
 {
+// A component is read by the vertex shader input at the location of its value.
 enum class VertexComponent
 {
     Position,
@@ -25,6 +26,9 @@ struct Vertex
     static constexpr std::array<VertexComponent, 3> kAllComponents{
         VertexComponent::Position, VertexComponent::UV, VertexComponent::Color};
 
+    // The components read by a vertex shader with inputs at locations; throws for a location no component has.
+    static std::vector<VertexComponent> components(std::span<const uint32_t> locations);
+
     glm::vec3 pos;
     glm::vec2 uv;
     glm::vec4 color;
@@ -41,7 +45,7 @@ struct VertexInputState
   private:
     static VkVertexInputBindingDescription create_binding(uint32_t binding);
 
-    VkVertexInputAttributeDescription create_attribute(uint32_t location, VertexComponent component) const;
+    VkVertexInputAttributeDescription create_attribute(VertexComponent component) const;
 
     std::vector<VkVertexInputAttributeDescription> create_attributes(std::span<const VertexComponent> components);
 
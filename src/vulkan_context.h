@@ -3,17 +3,22 @@
 #include "gui/gui.h"
 #include "model/scene.h"
 #include "scenes/render_scene.h"
+#include "util/asset_reader.h"
 #include "util/no_copy_or_move.h"
-#include "vulkan/adhoc_queues.h"
+#include "util/shader_compiler.h"
+#include "vulkan/bindless_textures.h"
 #include "vulkan/depth_buffer.h"
 #include "vulkan/descriptor_set_layout.h"
 #include "vulkan/device.h"
-#include "vulkan/framebuffers.h"
 #include "vulkan/graphics_buffers.h"
 #include "vulkan/graphics_pipeline.h"
 #include "vulkan/graphics_queue.h"
+#include "vulkan/multisampler.h"
+#include "vulkan/pipeline_cache.h"
+#include "vulkan/pipeline_manager.h"
 #include "vulkan/render_pass.h"
-#include "vulkan/sampler.h"
+#include "vulkan/sampler_cache.h"
+#include "vulkan/shader_module_cache.h"
 #include "vulkan/swapchain.h"
 #include "vulkan/texture_factory.h"
 #include "vulkan/vertex.h"
@@ -28,20 +33,27 @@ class VulkanContext : NoCopyOrMove
   private:
     std::unique_ptr<Window> m_window;
     std::unique_ptr<Device> m_device;
-    std::unique_ptr<AdhocQueues> m_adhoc_queues;
+    std::unique_ptr<AssetReader> m_asset_reader;
+    std::unique_ptr<ShaderCompiler> m_shader_compiler;
+    std::unique_ptr<ShaderModuleCache> m_shader_modules;
+    std::unique_ptr<PipelineCache> m_pipeline_cache;
     std::unique_ptr<GraphicsQueue> m_graphics_queue;
     std::unique_ptr<DescriptorSetLayout> m_descriptor_set_layout;
     std::unique_ptr<GraphicsBuffers> m_graphics_buffers;
-    std::unique_ptr<Sampler> m_sampler;
+    std::unique_ptr<SamplerCache> m_sampler_cache;
+    std::unique_ptr<BindlessTextures> m_bindless_textures;
     std::unique_ptr<TextureFactory> m_texture_factory;
     std::unique_ptr<RenderScene> m_render_scene;
-    std::unique_ptr<Swapchain> m_swapchain;
-    std::unique_ptr<DepthBuffer> m_depth_buffer;
     std::unique_ptr<RenderPass> m_render_pass;
-    std::unique_ptr<Framebuffers> m_framebuffers;
     std::unique_ptr<GraphicsPipeline> m_graphics_pipeline;
+    std::unique_ptr<PipelineManager> m_pipeline_manager;
     std::unique_ptr<Gui> m_gui;
 
+    // Recreated with the swapchain; everything above survives a resize.
+    std::unique_ptr<Swapchain> m_swapchain;
+    std::unique_ptr<DepthBuffer> m_depth_buffer;
+    std::unique_ptr<Multisampler> m_multisampler;
+
   public:
     VulkanContext() = default;
 
@@ -55,9 +67,24 @@ class VulkanContext : NoCopyOrMove
         return *m_device;
     }
 
-    const AdhocQueues& adhoc_queues() const
+    const AssetReader& asset_reader() const
     {
-        return *m_adhoc_queues;
+        return *m_asset_reader;
+    }
+
+    const ShaderCompiler& shader_compiler() const
+    {
+        return *m_shader_compiler;
+    }
+
+    ShaderModuleCache& shader_modules()
+    {
+        return *m_shader_modules;
+    }
+
+    const PipelineCache& pipeline_cache() const
+    {
+        return *m_pipeline_cache;
     }
 
     GraphicsQueue& graphics_queue()
@@ -87,9 +114,9 @@ class VulkanContext : NoCopyOrMove
         return *m_graphics_buffers;
     }
 
-    const Sampler& sampler() const
+    SamplerCache& sampler_cache()
     {
-        return *m_sampler;
+        return *m_sampler_cache;
     }
 
     const RenderScene& render_scene() const
@@ -101,6 +128,11 @@ class VulkanContext : NoCopyOrMove
         return *m_render_scene;
     }
 
+    const BindlessTextures& bindless_textures() const
+    {
+        return *m_bindless_textures;
+    }
+
     TextureFactory& texture_factory()
     {
         return *m_texture_factory;
@@ -116,9 +148,15 @@ class VulkanContext : NoCopyOrMove
         return *m_render_pass;
     }
 
-    const Framebuffers& framebuffers() const
+    const DepthBuffer& depth_buffer() const
+    {
+        return *m_depth_buffer;
+    }
+
+    // Null when the render pass is not multisampled.
+    const Multisampler* multisampler() const
     {
-        return *m_framebuffers;
+        return m_multisampler.get();
     }
 
     const GraphicsPipeline& graphics_pipeline() const
@@ -130,6 +168,15 @@ class VulkanContext : NoCopyOrMove
         return *m_graphics_pipeline;
     }
 
+    const PipelineManager& pipeline_manager() const
+    {
+        return *m_pipeline_manager;
+    }
+    PipelineManager& pipeline_manager()
+    {
+        return *m_pipeline_manager;
+    }
+
     const Gui& gui() const
     {
         return *m_gui;
@@ -16,9 +16,28 @@ VulkanContextBuilder& VulkanContextBuilder::add_device(bool enableValidationLaye
     return *this;
 }
 
-VulkanContextBuilder& VulkanContextBuilder::add_adhoc_queues()
+VulkanContextBuilder& VulkanContextBuilder::add_asset_reader(const std::filesystem::path& pack_path)
 {
-    m_context->m_adhoc_queues = std::make_unique<AdhocQueues>(*m_context->m_device);
+    m_context->m_asset_reader = std::make_unique<AssetReader>(pack_path);
+    return *this;
+}
+
+VulkanContextBuilder& VulkanContextBuilder::add_shader_compiler(const std::filesystem::path& source_directory)
+{
+    m_context->m_shader_compiler = std::make_unique<ShaderCompiler>(*m_context->m_asset_reader, source_directory);
+    return *this;
+}
+
+VulkanContextBuilder& VulkanContextBuilder::add_shader_modules()
+{
+    m_context->m_shader_modules =
+        std::make_unique<ShaderModuleCache>(*m_context->m_device, *m_context->m_shader_compiler);
+    return *this;
+}
+
+VulkanContextBuilder& VulkanContextBuilder::add_pipeline_cache(const std::filesystem::path& path)
+{
+    m_context->m_pipeline_cache = std::make_unique<PipelineCache>(*m_context->m_device, path);
     return *this;
 }
 
@@ -28,31 +47,44 @@ VulkanContextBuilder& VulkanContextBuilder::add_graphics_queue()
     return *this;
 }
 
-VulkanContextBuilder&
-VulkanContextBuilder::add_descriptor_set_layout(const std::function<void(DescriptorSetLayoutBuilder&)>& configure)
+VulkanContextBuilder& VulkanContextBuilder::add_descriptor_set_layout()
 {
+    // Every pipeline shares the layout, so shaders loaded later, by the pipeline manager or a reload, must declare the
+    // same interface.
     DescriptorSetLayoutBuilder builder;
-    configure(builder);
+    const auto& scene = *m_context->m_render_scene;
+    for (const auto& shader : {scene.vertex_shader(), scene.fragment_shader()})
+    {
+        builder.add_shader(m_context->m_shader_modules->get(shader)->reflection());
+    }
     m_context->m_descriptor_set_layout = builder.build(*m_context->m_device);
     return *this;
 }
 
 VulkanContextBuilder& VulkanContextBuilder::add_graphics_buffers()
 {
-    m_context->m_graphics_buffers = std::make_unique<GraphicsBuffers>(*m_context->m_device, *m_context->m_adhoc_queues);
+    m_context->m_graphics_buffers = std::make_unique<GraphicsBuffers>(*m_context->m_device);
     return *this;
 }
 
-VulkanContextBuilder& VulkanContextBuilder::add_sampler()
+VulkanContextBuilder& VulkanContextBuilder::add_sampler_cache()
 {
-    m_context->m_sampler = std::make_unique<Sampler>(*m_context->m_device);
+    m_context->m_sampler_cache = std::make_unique<SamplerCache>(*m_context->m_device);
+    return *this;
+}
+
+VulkanContextBuilder& VulkanContextBuilder::add_bindless_textures()
+{
+    m_context->m_bindless_textures = std::make_unique<BindlessTextures>(*m_context->m_device);
     return *this;
 }
 
 VulkanContextBuilder& VulkanContextBuilder::add_texture_factory()
 {
-    m_context->m_texture_factory =
-        std::make_unique<TextureFactory>(*m_context->m_device, *m_context->m_sampler, *m_context->m_adhoc_queues);
+    m_context->m_texture_factory = std::make_unique<TextureFactory>(*m_context->m_device,
+                                                                    *m_context->m_asset_reader,
+                                                                    *m_context->m_sampler_cache,
+                                                                    *m_context->m_bindless_textures);
     return *this;
 }
 
@@ -68,10 +100,7 @@ VulkanContextBuilder& VulkanContextBuilder::add_swapchain()
 {
     if (m_context->m_swapchain != nullptr)
     {
-        m_context->m_gui.reset();
-        m_context->m_graphics_pipeline.reset();
-        m_context->m_framebuffers.reset();
-        m_context->m_render_pass.reset();
+        m_context->m_multisampler.reset();
         m_context->m_depth_buffer.reset();
         m_context->m_swapchain.reset();
     }
@@ -90,34 +119,66 @@ VulkanContextBuilder& VulkanContextBuilder::add_depth_buffer()
 VulkanContextBuilder& VulkanContextBuilder::add_render_pass()
 {
     m_context->m_render_pass =
-        std::make_unique<RenderPass>(*m_context->m_device, *m_context->m_swapchain, *m_context->m_depth_buffer);
+        std::make_unique<RenderPass>(*m_context->m_device, m_context->m_swapchain->image_format());
 
     return *this;
 }
 
-VulkanContextBuilder& VulkanContextBuilder::add_framebuffers()
+VulkanContextBuilder& VulkanContextBuilder::add_multisampler()
 {
-    m_context->m_framebuffers = std::make_unique<Framebuffers>(
-        *m_context->m_device, *m_context->m_swapchain, *m_context->m_render_pass, *m_context->m_depth_buffer);
+    m_context->m_multisampler.reset();
+    if (m_context->m_render_pass->multisampled())
+    {
+        m_context->m_multisampler = std::make_unique<Multisampler>(*m_context->m_device, *m_context->m_swapchain);
+    }
 
     return *this;
 }
 
-VulkanContextBuilder& VulkanContextBuilder::add_graphics_pipeline()
+VulkanContextBuilder& VulkanContextBuilder::add_graphics_pipeline(bool dynamic_raster_state)
 {
     m_context->m_graphics_pipeline = std::make_unique<GraphicsPipeline>(*m_context->m_device,
+                                                                        *m_context->m_shader_modules,
+                                                                        *m_context->m_pipeline_cache,
                                                                         *m_context->m_descriptor_set_layout,
-                                                                        *m_context->m_swapchain,
+                                                                        *m_context->m_bindless_textures,
                                                                         *m_context->m_render_pass,
                                                                         m_context->m_render_scene->vertex_shader(),
-                                                                        m_context->m_render_scene->fragment_shader());
+                                                                        m_context->m_render_scene->fragment_shader(),
+                                                                        m_context->m_render_scene->specialization(),
+                                                                        dynamic_raster_state);
+
+    return *this;
+}
+
+VulkanContextBuilder& VulkanContextBuilder::add_pipeline_manager()
+{
+    // Pipelines compiled against the previous render pass go with the previous manager.
+    m_context->m_pipeline_manager.reset();
+    const bool dynamic_raster_state = m_context->m_graphics_pipeline->dynamic_raster_state();
+    m_context->m_pipeline_manager = std::make_unique<PipelineManager>(*m_context->m_device,
+                                                                      *m_context->m_shader_modules,
+                                                                      *m_context->m_pipeline_cache,
+                                                                      m_context->m_graphics_pipeline->layout(),
+                                                                      *m_context->m_render_pass,
+                                                                      dynamic_raster_state);
+
+    return *this;
+}
+
+VulkanContextBuilder& VulkanContextBuilder::remove_pipeline_manager()
+{
+    m_context->m_pipeline_manager.reset();
 
     return *this;
 }
 
 VulkanContextBuilder& VulkanContextBuilder::add_gui()
 {
-    m_context->m_gui = std::make_unique<Gui>(*m_context->m_window, *m_context->m_device, *m_context->m_render_pass);
+    // ImGui has one backend at a time, so the old one must be shut down before the new one starts.
+    m_context->m_gui.reset();
+    m_context->m_gui = std::make_unique<Gui>(
+        *m_context->m_window, *m_context->m_device, *m_context->m_pipeline_cache, *m_context->m_render_pass);
 
     return *this;
 }
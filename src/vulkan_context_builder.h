@@ -4,6 +4,7 @@
 #include "vulkan/descriptor_set_layout_builder.h"
 #include "vulkan_context.h"
 
+#include <filesystem>
 #include <functional>
 
 namespace steeplejack
@@ -22,15 +23,25 @@ class VulkanContextBuilder : NoCopyOrMove
 
     VulkanContextBuilder& add_device(bool enableValidationLayers = true);
 
-    VulkanContextBuilder& add_adhoc_queues();
+    VulkanContextBuilder& add_asset_reader(const std::filesystem::path& pack_path = AssetReader::kDefaultPack);
+
+    VulkanContextBuilder& add_shader_compiler(const std::filesystem::path& source_directory = {});
+
+    // Shader modules shared by all pipelines, so it goes after add_device and add_shader_compiler.
+    VulkanContextBuilder& add_shader_modules();
+
+    VulkanContextBuilder& add_pipeline_cache(const std::filesystem::path& path = PipelineCache::kDefaultPath);
 
     VulkanContextBuilder& add_graphics_queue();
 
-    VulkanContextBuilder& add_descriptor_set_layout(const std::function<void(DescriptorSetLayoutBuilder&)>& configure);
+    // Pushed descriptor set and push constants reflected from the scene's shaders, so it goes after add_scene.
+    VulkanContextBuilder& add_descriptor_set_layout();
 
     VulkanContextBuilder& add_graphics_buffers();
 
-    VulkanContextBuilder& add_sampler();
+    VulkanContextBuilder& add_sampler_cache();
+
+    VulkanContextBuilder& add_bindless_textures();
 
     VulkanContextBuilder& add_texture_factory();
 
@@ -42,12 +53,28 @@ class VulkanContextBuilder : NoCopyOrMove
 
     VulkanContextBuilder& add_render_pass();
 
-    VulkanContextBuilder& add_framebuffers();
+    // The multisampled color image, when the render pass is multisampled, so it goes after add_render_pass.
+    VulkanContextBuilder& add_multisampler();
 
-    VulkanContextBuilder& add_graphics_pipeline();
+    // With dynamic_raster_state, cull mode, front face, depth and topology are set per draw instead of being baked into
+    // the pipelines, so materials differing only in them share one.
+    VulkanContextBuilder& add_graphics_pipeline(bool dynamic_raster_state = true);
+
+    // Takes the raster state mode of the graphics pipeline, so it goes after add_graphics_pipeline.
+    VulkanContextBuilder& add_pipeline_manager();
+
+    // Stops the pipeline manager's workers and destroys its pipelines. Goes before add_render_pass or
+    // add_graphics_pipeline replace what the workers compile against, the render pass and the pipeline layout.
+    VulkanContextBuilder& remove_pipeline_manager();
 
     VulkanContextBuilder& add_gui();
 
+    // The context built so far, for decisions about what to add next.
+    const VulkanContext& context() const
+    {
+        return *m_context;
+    }
+
     std::unique_ptr<VulkanContext> build();
 };
 } // namespace steeplejack
\ No newline at end of file
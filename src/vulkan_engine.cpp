@@ -2,6 +2,8 @@
 
 #include "scenes/george.h"
 #include "spdlog/spdlog.h"
+#include "util/shader_source.h"
+#include "vulkan/upload_batch.h"
 #include "vulkan_context_builder.h"
 
 #include <chrono>
@@ -10,13 +12,27 @@
 
 using namespace steeplejack;
 
-VulkanEngine::VulkanEngine(std::unique_ptr<VulkanContext> context) : m_context(std::move(context)) {}
+VulkanEngine::VulkanEngine(std::unique_ptr<VulkanContext> context) : m_context(std::move(context))
+{
+    const auto& shader_directory = m_context->shader_compiler().source_directory();
+    if (!shader_directory.empty())
+    {
+        m_shader_watcher = std::make_unique<DirectoryWatcher>(shader_directory);
+    }
+}
 
 void VulkanEngine::run()
 {
     spdlog::info("Vulkan Engine is running");
 
-    m_context->render_scene().load(m_context->device(), m_context->texture_factory(), m_context->graphics_buffers());
+    UploadBatch upload_batch(m_context->device());
+    m_context->render_scene().load(m_context->device(),
+                                   m_context->asset_reader(),
+                                   m_context->texture_factory(),
+                                   m_context->graphics_buffers(),
+                                   upload_batch);
+    upload_batch.submit();
+    upload_batch.wait();
 
     while (!m_context->window().should_close())
     {
@@ -32,35 +48,80 @@ void VulkanEngine::recreate_swapchain()
     m_context->window().wait_resize();
     m_context->device().wait_idle();
 
-    auto context = VulkanContextBuilder(std::move(m_context))
-                       .add_swapchain()
-                       .add_depth_buffer()
-                       .add_render_pass()
-                       .add_framebuffers()
-                       .add_graphics_pipeline()
-                       .add_gui()
-                       .build();
-    m_context = std::move(context);
+    VulkanContextBuilder builder(std::move(m_context));
+    builder.add_swapchain().add_depth_buffer();
+
+    // The render pass, and the pipelines built against it, only depend on the image format, which a resize keeps.
+    auto& context = builder.context();
+    if (context.swapchain().image_format() != context.render_pass().color_format())
+    {
+        spdlog::info("Swapchain format changed, rebuilding pipelines");
+        const bool dynamic_raster_state = context.graphics_pipeline().dynamic_raster_state();
+        builder.remove_pipeline_manager()
+            .add_render_pass()
+            .add_graphics_pipeline(dynamic_raster_state)
+            .add_pipeline_manager()
+            .add_gui();
+        m_scene_pipeline = 0;
+        context.render_scene().reset_pipelines();
+    }
+
+    m_context = builder.add_multisampler().build();
+}
+
+void VulkanEngine::reload_shaders()
+{
+    if (m_shader_watcher == nullptr)
+    {
+        return;
+    }
+
+    auto& pipelines = m_context->pipeline_manager();
+    const auto& scene = m_context->render_scene();
+
+    for (const auto& file_name : m_shader_watcher->poll())
+    {
+        const auto shader = ShaderSource::shader_name(file_name);
+        if (!shader)
+        {
+            continue;
+        }
+
+        auto count = pipelines.reload(*shader);
+
+        // The scene's own pipeline was built synchronously at startup; from its first change on it is built by the
+        // pipeline manager instead, and the one built at startup is used until that is ready.
+        if (m_scene_pipeline == 0 && (*shader == scene.vertex_shader() || *shader == scene.fragment_shader()))
+        {
+            m_scene_pipeline = pipelines.request(
+                pipelines.state(scene.vertex_shader(), scene.fragment_shader(), scene.specialization()));
+            count++;
+        }
+
+        spdlog::info("Shader {} changed, rebuilding {} pipelines", *shader, count);
+    }
 }
 
 void VulkanEngine::draw_frame()
 {
     m_context->gui().begin_frame();
 
-    auto* framebuffer = m_context->graphics_queue().prepare_framebuffer(
-        m_current_frame, m_context->swapchain(), m_context->framebuffers());
-
-    if (framebuffer == nullptr)
+    const auto image_index = m_context->graphics_queue().acquire_image(m_current_frame, m_context->swapchain());
+    if (!image_index)
     {
         recreate_swapchain();
         return;
     }
 
+    m_context->texture_factory().update();
+    reload_shaders();
+    m_context->pipeline_manager().update();
+    m_context->graphics_pipeline().set_override(m_context->pipeline_manager().get(m_scene_pipeline));
     m_context->render_scene().update(m_current_frame, m_context->swapchain().aspect_ratio());
 
-    render(framebuffer);
+    render(*image_index);
 
-    if (!m_context->graphics_queue().present_framebuffer())
+    if (!m_context->graphics_queue().present_image())
     {
         recreate_swapchain();
     }
@@ -68,20 +129,31 @@ void VulkanEngine::draw_frame()
     next_frame();
 }
 
-void VulkanEngine::render(VkFramebuffer framebuffer)
+void VulkanEngine::render(uint32_t image_index)
 {
     auto* command_buffer = m_context->graphics_queue().begin_command();
 
-    m_context->render_pass().begin(command_buffer, framebuffer);
+    const auto& swapchain = m_context->swapchain();
+    const RenderPass::Attachment output = {swapchain.image(image_index), swapchain.image_view(image_index)};
+    RenderPass::Attachment multisampled_color;
+    if (const auto* multisampler = m_context->multisampler())
+    {
+        multisampled_color = {multisampler->image(), multisampler->image_view()};
+    }
+    const RenderPass::Attachment depth = {m_context->depth_buffer().image(), m_context->depth_buffer().image_view()};
+
+    m_context->render_pass().begin(command_buffer, swapchain.extent(), output, multisampled_color, depth);
 
     m_context->graphics_pipeline().bind(command_buffer);
+    m_context->bindless_textures().bind(command_buffer, m_context->graphics_pipeline().layout());
     m_context->swapchain().clip(command_buffer);
     m_context->graphics_buffers().bind(command_buffer);
 
-    m_context->render_scene().render(command_buffer, m_current_frame, m_context->graphics_pipeline());
+    m_context->render_scene().render(
+        command_buffer, m_current_frame, m_context->graphics_pipeline(), m_context->pipeline_manager());
     steeplejack::Gui::render(command_buffer);
 
-    m_context->render_pass().end(command_buffer);
+    m_context->render_pass().end(command_buffer, output);
 
     m_context->graphics_queue().submit_command();
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "scenes/render_scene.h"
+#include "util/directory_watcher.h"
 #include "util/no_copy_or_move.h"
 #include "vulkan_context.h"
 
@@ -16,9 +17,15 @@ class VulkanEngine : NoCopyOrMove
 
     uint32_t m_current_frame = 0;
 
+    // Set when shaders are compiled from source: changed shaders are compiled again in the background, and the scene
+    // draws with m_scene_pipeline once a shader of its own has changed.
+    std::unique_ptr<DirectoryWatcher> m_shader_watcher;
+    PipelineManager::Handle m_scene_pipeline = 0;
+
     void draw_frame();
+    void reload_shaders();
     void recreate_swapchain();
-    void render(VkFramebuffer framebuffer);
+    void render(uint32_t image_index);
 
     void next_frame()
     {
@@ -0,0 +1,181 @@
+#include "bake/asset_baker.h"
+#include "util/asset_pack.h"
+#include "util/asset_reader.h"
+#include "util/ktx2.h"
+#include "util/mapped_file.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using steeplejack::AssetBaker;
+using steeplejack::AssetPack;
+using steeplejack::AssetReader;
+using steeplejack::Ktx2;
+using steeplejack::MappedFile;
+
+namespace
+{
+std::vector<std::byte> bytes_of(const std::string& text)
+{
+    const auto* data = reinterpret_cast<const std::byte*>(text.data());
+    return {data, data + text.size()};
+}
+
+void write(const std::filesystem::path& path, const std::vector<std::byte>& bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+// An uncompressed, top-left origin 32-bit TGA of width by height pixels.
+std::vector<std::byte> tga(uint16_t width, uint16_t height)
+{
+    std::vector<std::byte> result(18);
+    result[2] = std::byte{2};
+    result[12] = std::byte(width & 0xFFU);
+    result[13] = std::byte(width >> 8U);
+    result[14] = std::byte(height & 0xFFU);
+    result[15] = std::byte(height >> 8U);
+    result[16] = std::byte{32};
+    result[17] = std::byte{0x28};
+
+    for (uint32_t i = 0; i < uint32_t{width} * height; i++)
+    {
+        result.insert(result.end(), {std::byte(i * 40U), std::byte{0x80}, std::byte{0x20}, std::byte{0xFF}});
+    }
+
+    return result;
+}
+
+// Bytes that LZ4 cannot shrink.
+std::vector<std::byte> noise(size_t size)
+{
+    std::vector<std::byte> result(size);
+    uint32_t state = 12345;
+    for (auto& byte : result)
+    {
+        state = state * 1664525U + 1013904223U;
+        byte = std::byte(state >> 24U);
+    }
+
+    return result;
+}
+
+struct Baked
+{
+    std::filesystem::path input;
+    std::filesystem::path output;
+};
+
+// Bakes a directory holding a compressible text file, a file of noise, an image, and files the baker skips.
+Baked bake(const std::string& name, bool lz4)
+{
+    const auto root = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(root);
+
+    const auto input = root / "assets";
+    std::filesystem::create_directories(input / "textures");
+    write(input / "text.txt", bytes_of(std::string(4096, 'a')));
+    write(input / "noise.bin", noise(64));
+    write(input / "textures" / "image.tga", tga(4, 2));
+    write(input / "README.md", bytes_of("not an asset"));
+    write(input / ".hidden", bytes_of("not an asset"));
+
+    AssetBaker({.inputs = {input}, .output = root / "assets.pack", .cache = root / "cache", .lz4 = lz4}).run();
+
+    return {.input = input, .output = root / "assets.pack"};
+}
+
+std::string name_of(const std::filesystem::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+} // namespace
+
+TEST_CASE("AssetBaker packs every asset under its path, with images baked to KTX2", "[bake]")
+{
+    const auto baked = bake("steeplejack_asset_baker_layout", false);
+
+    const MappedFile file(baked.output);
+    const auto pack = AssetPack::parse(file.bytes());
+
+    REQUIRE(pack.entries.size() == 3);
+    CHECK(pack.find(name_of(baked.input / "README.md")) == nullptr);
+    CHECK(pack.find(name_of(baked.input / ".hidden")) == nullptr);
+    CHECK(pack.find(name_of(baked.input / "textures" / "image.tga")) == nullptr);
+
+    for (const auto& entry : pack.entries)
+    {
+        CHECK(entry.offset % AssetPack::kBlobAlignment == 0);
+        CHECK(entry.compression == AssetPack::Compression::kNone);
+        CHECK(entry.stored_size == entry.size);
+    }
+
+    const auto* text = pack.find(name_of(baked.input / "text.txt"));
+    REQUIRE(text != nullptr);
+    CHECK(text->size == 4096);
+
+    const auto* image = pack.find(name_of(baked.input / "textures" / "image.ktx2"));
+    REQUIRE(image != nullptr);
+
+    const auto ktx2 = Ktx2::parse(file.bytes().subspan(image->offset, image->stored_size));
+    CHECK(ktx2.width == 4);
+    CHECK(ktx2.height == 2);
+    CHECK(ktx2.levels.size() == 3);
+}
+
+TEST_CASE("AssetBaker compresses entries that shrink enough, except KTX2 textures", "[bake]")
+{
+    const auto baked = bake("steeplejack_asset_baker_lz4", true);
+
+    const MappedFile file(baked.output);
+    const auto pack = AssetPack::parse(file.bytes());
+
+    const auto* text = pack.find(name_of(baked.input / "text.txt"));
+    REQUIRE(text != nullptr);
+    CHECK(text->compression == AssetPack::Compression::kLz4);
+    CHECK(text->stored_size < text->size);
+    CHECK(text->size == 4096);
+
+    const auto* noise_entry = pack.find(name_of(baked.input / "noise.bin"));
+    REQUIRE(noise_entry != nullptr);
+    CHECK(noise_entry->compression == AssetPack::Compression::kNone);
+
+    // Kept as stored so the engine can upload their levels straight out of the map.
+    const auto* image = pack.find(name_of(baked.input / "textures" / "image.ktx2"));
+    REQUIRE(image != nullptr);
+    CHECK(image->compression == AssetPack::Compression::kNone);
+}
+
+TEST_CASE("AssetReader reads baked entries back from the pack", "[bake]")
+{
+    for (const bool lz4 : {false, true})
+    {
+        INFO("lz4: " << lz4);
+        const auto baked = bake("steeplejack_asset_baker_read", lz4);
+
+        // The reader falls back to loose files, so they must be gone for it to read from the pack.
+        std::filesystem::remove_all(baked.input);
+
+        const AssetReader reader(baked.output);
+
+        const auto text = reader.read(name_of(baked.input / "text.txt"));
+        const auto expected_text = bytes_of(std::string(4096, 'a'));
+        CHECK(std::vector(text.view().begin(), text.view().end()) == expected_text);
+
+        const auto noise_entry = reader.read(name_of(baked.input / "noise.bin"));
+        const auto expected_noise = noise(64);
+        CHECK(std::vector(noise_entry.view().begin(), noise_entry.view().end()) == expected_noise);
+
+        CHECK(reader.exists(name_of(baked.input / "textures" / "image.ktx2")));
+        CHECK_FALSE(reader.exists(name_of(baked.input / "textures" / "image.tga")));
+
+        const auto image = reader.read(name_of(baked.input / "textures" / "image.ktx2"));
+        CHECK(Ktx2::parse(image.view()).width == 4);
+    }
+}
@@ -0,0 +1,79 @@
+#include "util/asset_pack.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using steeplejack::AssetPack;
+
+namespace
+{
+std::vector<std::byte> bytes_of(const std::string& text)
+{
+    std::vector<std::byte> bytes(text.size());
+    std::memcpy(bytes.data(), text.data(), text.size());
+    return bytes;
+}
+
+std::string text_of(const std::vector<std::byte>& data, const AssetPack::Entry& entry)
+{
+    return {reinterpret_cast<const char*>(data.data() + entry.offset), entry.stored_size};
+}
+} // namespace
+
+TEST_CASE("AssetPack round trips entries in aligned blobs", "[util]")
+{
+    const auto shader = bytes_of("spirv");
+    const auto texture = bytes_of("compressed pixels");
+
+    const auto data = AssetPack::write({
+        {.name = "shaders/a.spv", .bytes = shader, .size = shader.size(), .compression = AssetPack::Compression::kNone},
+        {.name = "assets/textures/b.ktx2",
+         .bytes = texture,
+         .size = 1024,
+         .compression = AssetPack::Compression::kLz4},
+    });
+
+    const auto pack = AssetPack::parse(data);
+    REQUIRE(pack.entries.size() == 2);
+
+    const auto* a = pack.find("shaders/a.spv");
+    REQUIRE(a != nullptr);
+    CHECK(a->offset % AssetPack::kBlobAlignment == 0);
+    CHECK(a->size == shader.size());
+    CHECK(a->compression == AssetPack::Compression::kNone);
+    CHECK(text_of(data, *a) == "spirv");
+
+    const auto* b = pack.find("assets/textures/b.ktx2");
+    REQUIRE(b != nullptr);
+    CHECK(b->offset % AssetPack::kBlobAlignment == 0);
+    CHECK(b->stored_size == texture.size());
+    CHECK(b->size == 1024);
+    CHECK(b->compression == AssetPack::Compression::kLz4);
+    CHECK(text_of(data, *b) == "compressed pixels");
+
+    CHECK(pack.find("shaders/missing.spv") == nullptr);
+    CHECK(pack.find("shaders/a") == nullptr);
+}
+
+TEST_CASE("AssetPack rejects malformed packs", "[util]")
+{
+    const auto bytes = bytes_of("spirv");
+    const auto data = AssetPack::write(
+        {{.name = "shaders/a.spv", .bytes = bytes, .size = bytes.size(), .compression = AssetPack::Compression::kNone}});
+
+    auto bad_identifier = data;
+    bad_identifier[0] = std::byte{'X'};
+    REQUIRE_THROWS_AS(AssetPack::parse(bad_identifier), std::runtime_error);
+
+    const std::vector<std::byte> truncated(data.begin(), data.end() - 8);
+    REQUIRE_THROWS_AS(AssetPack::parse(truncated), std::runtime_error);
+
+    auto out_of_range = data;
+    AssetPack::store<uint64_t>(out_of_range, AssetPack::read<uint64_t>(data, 16) + 8, data.size());
+    REQUIRE_THROWS_AS(AssetPack::parse(out_of_range), std::runtime_error);
+}
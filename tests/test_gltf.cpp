@@ -0,0 +1,190 @@
+#include "util/gltf.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using steeplejack::Gltf;
+
+namespace
+{
+template <typename T> void append(std::vector<std::byte>& data, T value)
+{
+    const auto offset = data.size();
+    data.resize(offset + sizeof(T));
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+// One triangle: three float positions and three unsigned short indices, in a single buffer.
+std::vector<std::byte> make_binary()
+{
+    std::vector<std::byte> binary;
+    for (float value : {0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 2.0F, 0.0F})
+    {
+        append(binary, value);
+    }
+    for (uint16_t index : {0, 1, 2})
+    {
+        append(binary, index);
+    }
+    append<uint16_t>(binary, 0);
+
+    return binary;
+}
+
+const std::string kJson = R"({
+    "asset": {"version": "2.0"},
+    "scene": 0,
+    "scenes": [{"nodes": [0]}],
+    "nodes": [
+        {"name": "root", "children": [1], "translation": [1, 2, 3]},
+        {"mesh": 0, "matrix": [1,0,0,0, 0,1,0,0, 0,0,1,0, 4,5,6,1]}
+    ],
+    "meshes": [{"primitives": [{"attributes": {"POSITION": 0}, "indices": 1, "material": 0}]}],
+    "materials": [{"pbrMetallicRoughness": {"baseColorFactor": [1, 0.5, 0.25, 1], "baseColorTexture": {"index": 0}},
+                   "alphaMode": "MASK", "alphaCutoff": 0.25, "doubleSided": true}],
+    "textures": [{"source": 0, "sampler": 0}],
+    "samplers": [{"magFilter": 9728, "minFilter": 9985, "wrapS": 33071}],
+    "images": [{"uri": "brick.png"}],
+    "accessors": [
+        {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0, 0, 0], "max": [1, 2, 0]},
+        {"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"}
+    ],
+    "bufferViews": [
+        {"buffer": 0, "byteOffset": 0, "byteLength": 36},
+        {"buffer": 0, "byteOffset": 36, "byteLength": 6}
+    ],
+    "buffers": [{"byteLength": 44}]
+})";
+
+std::vector<std::byte> make_glb(std::string json, const std::vector<std::byte>& binary)
+{
+    json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+    std::vector<std::byte> data;
+    append<uint32_t>(data, Gltf::kGlbMagic);
+    append<uint32_t>(data, Gltf::kGlbVersion);
+    append<uint32_t>(data, static_cast<uint32_t>(12 + 8 + json.size() + 8 + binary.size()));
+
+    append<uint32_t>(data, static_cast<uint32_t>(json.size()));
+    append<uint32_t>(data, Gltf::kChunkJson);
+    for (char c : json)
+    {
+        append(data, c);
+    }
+
+    append<uint32_t>(data, static_cast<uint32_t>(binary.size()));
+    append<uint32_t>(data, Gltf::kChunkBin);
+    data.insert(data.end(), binary.begin(), binary.end());
+
+    return data;
+}
+
+std::span<const std::byte> as_bytes(const std::string& text)
+{
+    return std::as_bytes(std::span(text.data(), text.size()));
+}
+} // namespace
+
+TEST_CASE("Gltf parses a GLB and reads accessors in place", "[util]")
+{
+    const auto data = make_glb(kJson, make_binary());
+    const auto gltf = Gltf::parse(data);
+
+    REQUIRE(gltf.root_nodes == std::vector<uint32_t>{0});
+    REQUIRE(gltf.nodes.size() == 2);
+    CHECK(gltf.nodes[0].translation == std::array<float, 3>{1.0F, 2.0F, 3.0F});
+    CHECK(gltf.nodes[0].rotation == std::array<float, 4>{0.0F, 0.0F, 0.0F, 1.0F});
+    CHECK(gltf.nodes[0].scale == std::array<float, 3>{1.0F, 1.0F, 1.0F});
+    CHECK_FALSE(gltf.nodes[0].matrix.has_value());
+    REQUIRE(gltf.nodes[1].matrix.has_value());
+    CHECK((*gltf.nodes[1].matrix)[12] == 4.0F);
+
+    REQUIRE(gltf.materials.size() == 1);
+    CHECK(gltf.materials[0].base_color_factor[1] == 0.5F);
+    CHECK(gltf.materials[0].alpha_mode == Gltf::AlphaMode::kMask);
+    CHECK(gltf.materials[0].alpha_cutoff == 0.25F);
+    CHECK(gltf.materials[0].double_sided);
+    CHECK(gltf.images[gltf.textures[*gltf.materials[0].base_color_texture].source.value()].uri == "brick.png");
+
+    REQUIRE(gltf.samplers.size() == 1);
+    CHECK(gltf.textures[0].sampler == 0U);
+    CHECK(gltf.samplers[0].mag_filter == Gltf::kFilterNearest);
+    CHECK(gltf.samplers[0].min_filter == Gltf::kFilterLinearMipmapNearest);
+    CHECK(gltf.samplers[0].wrap_s == Gltf::kWrapClampToEdge);
+    CHECK(gltf.samplers[0].wrap_t == Gltf::kWrapRepeat);
+
+    // The binary chunk is not copied.
+    REQUIRE(gltf.binary_chunk.size() == 44);
+    CHECK(gltf.binary_chunk.data() == data.data() + data.size() - 44);
+
+    const std::vector<std::span<const std::byte>> buffers = {gltf.binary_chunk};
+    const auto& primitive = gltf.meshes[0].primitives[0];
+    CHECK(primitive.mode == Gltf::kModeTriangles);
+
+    const auto positions = gltf.view(*primitive.position, buffers);
+    CHECK(positions.data == gltf.binary_chunk.data());
+    CHECK(positions.count == 3);
+    CHECK(positions.read_float(1, 0) == 1.0F);
+    CHECK(positions.read_float(2, 1) == 2.0F);
+
+    const auto indices = gltf.view(*primitive.indices, buffers);
+    CHECK(indices.read_index(0) == 0);
+    CHECK(indices.read_index(2) == 2);
+}
+
+TEST_CASE("Gltf parses a JSON document and normalizes components", "[util]")
+{
+    const std::string json = R"({
+        "nodes": [{"children": [1]}, {}, {}],
+        "accessors": [{"bufferView": 0, "componentType": 5121, "normalized": true, "count": 2, "type": "VEC2"}],
+        "bufferViews": [{"buffer": 0, "byteLength": 8, "byteStride": 4}],
+        "buffers": [{"uri": "colors.bin", "byteLength": 8}]
+    })";
+
+    const auto gltf = Gltf::parse(as_bytes(json));
+
+    // Without a scene every node that is nobody's child is a root.
+    CHECK(gltf.root_nodes == std::vector<uint32_t>{0, 2});
+    CHECK(gltf.buffers[0].uri == "colors.bin");
+    CHECK(gltf.binary_chunk.empty());
+
+    std::vector<std::byte> bytes;
+    for (uint8_t value : {255, 0, 9, 9, 51, 102, 9, 9})
+    {
+        append(bytes, value);
+    }
+    const std::vector<std::span<const std::byte>> buffers = {bytes};
+
+    const auto view = gltf.view(0, buffers);
+    CHECK(view.stride == 4);
+    CHECK(view.read_float(0, 0) == 1.0F);
+    CHECK(view.read_float(0, 1) == 0.0F);
+    CHECK(view.read_float(1, 0) == 0.2F);
+    CHECK(view.read_float(1, 1) == 0.4F);
+}
+
+TEST_CASE("Gltf rejects malformed assets", "[util]")
+{
+    REQUIRE_THROWS_AS(Gltf::parse(as_bytes("{ not json")), std::runtime_error);
+    REQUIRE_THROWS_AS(Gltf::parse(as_bytes(R"({"nodes": [{"mesh": 0}]})")), std::runtime_error);
+    REQUIRE_THROWS_AS(Gltf::parse(as_bytes(R"({"nodes": [{"children": [3]}]})")), std::runtime_error);
+    REQUIRE_THROWS_AS(Gltf::parse(as_bytes(R"({"materials": [{"alphaMode": "CLIP"}]})")), std::runtime_error);
+    REQUIRE_THROWS_AS(Gltf::parse(as_bytes(R"({"textures": [{"sampler": 0}]})")), std::runtime_error);
+
+    auto truncated = make_glb(kJson, make_binary());
+    truncated.resize(truncated.size() - 8);
+    REQUIRE_THROWS_AS(Gltf::parse(truncated), std::runtime_error);
+
+    // An accessor that runs past the end of its buffer cannot be viewed.
+    const auto glb = make_glb(kJson, make_binary());
+    const auto gltf = Gltf::parse(glb);
+    const auto short_binary = make_binary();
+    const std::vector<std::span<const std::byte>> buffers = {std::span(short_binary).first(20)};
+    REQUIRE_THROWS_AS(gltf.view(0, buffers), std::runtime_error);
+}
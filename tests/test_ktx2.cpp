@@ -0,0 +1,111 @@
+#include "util/ktx2.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using steeplejack::Ktx2;
+
+namespace
+{
+constexpr uint32_t kBc7SrgbBlock = 146;
+
+template <typename T> void write(std::vector<std::byte>& data, size_t offset, T value)
+{
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+// 8x4 BC7 texture with a full chain: 2 blocks, 1 block, 1 block, 1 block.
+std::vector<std::byte> make_ktx2()
+{
+    const uint32_t level_count = 4;
+    const size_t data_offset = Ktx2::kHeaderSize + level_count * Ktx2::kLevelIndexEntrySize;
+
+    std::vector<std::byte> data(data_offset + 80);
+    std::memcpy(data.data(), Ktx2::kIdentifier.data(), Ktx2::kIdentifier.size());
+    write<uint32_t>(data, 12, kBc7SrgbBlock);
+    write<uint32_t>(data, 16, 1);
+    write<uint32_t>(data, 20, 8);
+    write<uint32_t>(data, 24, 4);
+    write<uint32_t>(data, 36, 1);
+    write<uint32_t>(data, 40, level_count);
+
+    const uint64_t sizes[] = {32, 16, 16, 16};
+    uint64_t offset = data_offset + 80;
+    for (uint32_t level = 0; level < level_count; level++)
+    {
+        // Levels are stored smallest first.
+        offset -= sizes[level];
+        write<uint64_t>(data, Ktx2::kHeaderSize + level * Ktx2::kLevelIndexEntrySize, offset);
+        write<uint64_t>(data, Ktx2::kHeaderSize + level * Ktx2::kLevelIndexEntrySize + 8, sizes[level]);
+        write<uint64_t>(data, Ktx2::kHeaderSize + level * Ktx2::kLevelIndexEntrySize + 16, sizes[level]);
+    }
+
+    return data;
+}
+} // namespace
+
+TEST_CASE("Ktx2 parses the header and level index", "[util]")
+{
+    const auto data = make_ktx2();
+    const auto ktx2 = Ktx2::parse(data);
+
+    REQUIRE(ktx2.vk_format == kBc7SrgbBlock);
+    REQUIRE(ktx2.width == 8);
+    REQUIRE(ktx2.height == 4);
+    REQUIRE(ktx2.levels.size() == 4);
+
+    REQUIRE(ktx2.levels[0].offset == data.size() - 32);
+    REQUIRE(ktx2.levels[0].size == 32);
+    REQUIRE(ktx2.levels[1].width == 4);
+    REQUIRE(ktx2.levels[1].height == 2);
+    REQUIRE(ktx2.levels[3].width == 1);
+    REQUIRE(ktx2.levels[3].height == 1);
+}
+
+TEST_CASE("Ktx2 rejects malformed and unsupported files", "[util]")
+{
+    auto bad_identifier = make_ktx2();
+    bad_identifier[1] = std::byte{0};
+    REQUIRE_THROWS_AS(Ktx2::parse(bad_identifier), std::runtime_error);
+
+    auto truncated = make_ktx2();
+    truncated.resize(truncated.size() - 1);
+    REQUIRE_THROWS_AS(Ktx2::parse(truncated), std::runtime_error);
+
+    auto supercompressed = make_ktx2();
+    write<uint32_t>(supercompressed, 44, 1);
+    REQUIRE_THROWS_AS(Ktx2::parse(supercompressed), std::runtime_error);
+
+    auto cube_map = make_ktx2();
+    write<uint32_t>(cube_map, 36, 6);
+    REQUIRE_THROWS_AS(Ktx2::parse(cube_map), std::runtime_error);
+}
+
+TEST_CASE("Ktx2 writes files it can parse", "[util]")
+{
+    const std::vector<std::byte> level0(32, std::byte{1});
+    const std::vector<std::byte> level1(16, std::byte{2});
+    const std::vector<std::byte> descriptor(12, std::byte{3});
+
+    const auto data = Ktx2::write(kBc7SrgbBlock, 1, 8, 4, {level0, level1}, descriptor);
+    const auto ktx2 = Ktx2::parse(data);
+
+    REQUIRE(ktx2.vk_format == kBc7SrgbBlock);
+    REQUIRE(ktx2.width == 8);
+    REQUIRE(ktx2.height == 4);
+    REQUIRE(ktx2.levels.size() == 2);
+
+    // Coarser levels come first, every level aligned.
+    REQUIRE(ktx2.levels[1].offset < ktx2.levels[0].offset);
+    REQUIRE(ktx2.levels[0].offset % Ktx2::kLevelAlignment == 0);
+    REQUIRE(ktx2.levels[1].offset % Ktx2::kLevelAlignment == 0);
+    REQUIRE(ktx2.levels[0].size == 32);
+    REQUIRE(ktx2.levels[1].width == 4);
+    REQUIRE(data[ktx2.levels[0].offset] == std::byte{1});
+    REQUIRE(data[ktx2.levels[1].offset] == std::byte{2});
+    REQUIRE(Ktx2::read<uint32_t>(data, 52) == descriptor.size());
+}
@@ -0,0 +1,41 @@
+#include "model/lod_selector.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using steeplejack::LodSelector;
+
+TEST_CASE("LodSelector picks coarser levels with distance", "[model]")
+{
+    const LodSelector selector(60.0F, 0.001F, 0.0F);
+    const std::vector<float> errors = {0.0F, 0.01F, 0.1F};
+
+    REQUIRE(selector.select(errors, 1.0F, 0) == 0);
+    REQUIRE(selector.select(errors, 20.0F, 0) == 1);
+    REQUIRE(selector.select(errors, 1000.0F, 0) == 2);
+    REQUIRE(selector.select({0.0F}, 1000.0F, 0) == 0);
+}
+
+TEST_CASE("LodSelector hysteresis delays coarsening but not refining", "[model]")
+{
+    const LodSelector selector(60.0F, 0.001F, 0.5F);
+    const std::vector<float> errors = {0.0F, 0.01F};
+
+    // Distance at which level 1 projects to exactly the threshold.
+    const float boundary = selector.screen_error(0.01F, 1.0F) / 0.001F;
+
+    REQUIRE(selector.select(errors, boundary * 1.5F, 0) == 0);
+    REQUIRE(selector.select(errors, boundary * 2.5F, 0) == 1);
+
+    REQUIRE(selector.select(errors, boundary * 1.5F, 1) == 1);
+    REQUIRE(selector.select(errors, boundary * 0.9F, 1) == 0);
+}
+
+TEST_CASE("LodSelector measures screen size in units of the maximum error", "[model]")
+{
+    const LodSelector selector(90.0F, 0.01F);
+
+    // At 90 degrees the viewport spans twice the distance, so a size equal to the distance covers half of it.
+    REQUIRE(selector.screen_error(1.0F, 1.0F) == 0.5F);
+    REQUIRE(selector.screen_pixels(1.0F, 1.0F) == 50.0F);
+}
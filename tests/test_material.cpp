@@ -0,0 +1,107 @@
+#include "model/material.h"
+#include "vulkan/pipeline_state.h"
+#include "vulkan/raster_state.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using steeplejack::Material;
+using steeplejack::Materials;
+using steeplejack::PipelineState;
+using steeplejack::RasterState;
+
+namespace
+{
+// Hands out a new handle for every request, as a pipeline manager does for states it has not seen.
+struct Pipelines
+{
+    uint32_t first_handle;
+    std::vector<PipelineState> requested;
+
+    uint32_t request(const PipelineState& state)
+    {
+        requested.push_back(state);
+        return first_handle + static_cast<uint32_t>(requested.size()) - 1;
+    }
+};
+} // namespace
+
+TEST_CASE("Materials request pipelines once, and again after a reset", "[material]")
+{
+    Materials materials;
+    auto& opaque = materials.add(std::make_unique<Material>(Material::AlphaMode::kOpaque));
+    REQUIRE(materials.pipelines_pending());
+    CHECK(opaque.pipeline() == 0);
+
+    Pipelines first = {.first_handle = 1, .requested = {}};
+    materials.request_pipelines(first, {});
+    CHECK_FALSE(materials.pipelines_pending());
+    CHECK(first.requested.size() == 1);
+    CHECK(opaque.pipeline() == 1);
+
+    auto& blended = materials.add(std::make_unique<Material>(Material::AlphaMode::kBlend));
+    REQUIRE(materials.pipelines_pending());
+    materials.request_pipelines(first, {});
+    CHECK(first.requested.size() == 2);
+    CHECK(blended.pipeline() == 2);
+
+    // The manager is replaced: its handles mean nothing to the next one.
+    materials.reset_pipelines();
+    CHECK(materials.pipelines_pending());
+    CHECK(opaque.pipeline() == 0);
+    CHECK(blended.pipeline() == 0);
+
+    Pipelines second = {.first_handle = 10, .requested = {}};
+    materials.request_pipelines(second, {});
+    CHECK_FALSE(materials.pipelines_pending());
+    REQUIRE(second.requested.size() == 2);
+    CHECK(second.requested[0] == first.requested[0]);
+    CHECK(second.requested[1] == first.requested[1]);
+    CHECK(opaque.pipeline() == 10);
+    CHECK(blended.pipeline() == 11);
+}
+
+TEST_CASE("Material raster state follows sidedness and blending", "[material]")
+{
+    const Material opaque(Material::AlphaMode::kOpaque);
+    CHECK(opaque.raster_state() == RasterState{});
+
+    const Material double_sided(Material::AlphaMode::kMask, nullptr, glm::vec4(1.0F), 0.5F, true);
+    CHECK(double_sided.raster_state().cull_mode == VK_CULL_MODE_NONE);
+    CHECK(double_sided.raster_state().depth_write);
+
+    const Material blended(Material::AlphaMode::kBlend);
+    CHECK(blended.raster_state().cull_mode == VK_CULL_MODE_BACK_BIT);
+    CHECK_FALSE(blended.raster_state().depth_write);
+
+    const auto state = blended.pipeline_state({});
+    CHECK(state.raster == blended.raster_state());
+    CHECK(state.blend);
+    CHECK_FALSE(opaque.pipeline_state({}).blend);
+}
+
+TEST_CASE("Pipeline states differing only in raster state share a pipeline when it is dynamic", "[material]")
+{
+    const Material single_sided(Material::AlphaMode::kOpaque);
+    const Material double_sided(Material::AlphaMode::kOpaque, nullptr, glm::vec4(1.0F), 0.5F, true);
+    const Material blended(Material::AlphaMode::kBlend);
+
+    PipelineState base;
+    base.vertex_shader = "mesh.vert";
+    base.fragment_shader = "mesh.frag";
+
+    // Baked raster state keeps the variants apart.
+    const auto baked = single_sided.pipeline_state(base);
+    CHECK(baked.baked() == baked);
+    CHECK(baked.baked() != double_sided.pipeline_state(base).baked());
+
+    base.dynamic_raster = true;
+    const auto dynamic = single_sided.pipeline_state(base).baked();
+    CHECK(dynamic.raster == RasterState{});
+    CHECK(dynamic == double_sided.pipeline_state(base).baked());
+
+    // Blending is part of the pipeline either way.
+    CHECK(dynamic != blended.pipeline_state(base).baked());
+}
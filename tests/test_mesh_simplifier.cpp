@@ -0,0 +1,99 @@
+#include "model/lod_selector.h"
+#include "util/mesh_simplifier.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <vector>
+
+using steeplejack::LodSelector;
+using steeplejack::MeshSimplifier;
+
+namespace
+{
+struct Grid
+{
+    std::vector<MeshSimplifier::Position> positions;
+    std::vector<uint32_t> indexes;
+};
+
+// A unit square in the xy plane split into size by size quads of two triangles each.
+Grid grid(uint32_t size)
+{
+    Grid result;
+    const float step = 1.0F / static_cast<float>(size);
+    for (uint32_t y = 0; y <= size; y++)
+    {
+        for (uint32_t x = 0; x <= size; x++)
+        {
+            result.positions.push_back({static_cast<float>(x) * step, static_cast<float>(y) * step, 0.0F});
+        }
+    }
+
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            const uint32_t corner = y * (size + 1) + x;
+            result.indexes.insert(result.indexes.end(), {corner, corner + 1, corner + size + 2});
+            result.indexes.insert(result.indexes.end(), {corner, corner + size + 2, corner + size + 1});
+        }
+    }
+
+    return result;
+}
+} // namespace
+
+TEST_CASE("MeshSimplifier builds coarser levels with growing error", "[util]")
+{
+    const auto mesh = grid(128);
+    const auto lods = MeshSimplifier::build_lods(mesh.positions, mesh.indexes);
+
+    REQUIRE(lods.size() == MeshSimplifier::kMaxLevels);
+
+    size_t triangles = mesh.indexes.size() / 3;
+    float error = 0.0F;
+    for (const auto& lod : lods)
+    {
+        REQUIRE(lod.indexes.size() % 3 == 0);
+        REQUIRE(lod.indexes.size() / 3 <= triangles * 3 / 4);
+        REQUIRE(lod.error > 0.0F);
+        REQUIRE(lod.error >= error);
+        for (const auto index : lod.indexes)
+        {
+            REQUIRE(index < mesh.positions.size());
+        }
+
+        triangles = lod.indexes.size() / 3;
+        error = lod.error;
+    }
+}
+
+TEST_CASE("MeshSimplifier leaves meshes it cannot reduce alone", "[util]")
+{
+    const std::vector<MeshSimplifier::Position> positions = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    const std::vector<uint32_t> indexes = {0, 1, 2};
+
+    REQUIRE(MeshSimplifier::build_lods(positions, indexes).empty());
+    REQUIRE(MeshSimplifier::build_lods(positions, {}).empty());
+}
+
+TEST_CASE("A far mesh draws its coarsest generated level", "[model]")
+{
+    const auto mesh = grid(64);
+    const auto lods = MeshSimplifier::build_lods(mesh.positions, mesh.indexes);
+    REQUIRE_FALSE(lods.empty());
+
+    // As Mesh::add_lod receives them: the full detail level has no error.
+    std::vector<float> errors = {0.0F};
+    for (const auto& lod : lods)
+    {
+        errors.push_back(lod.error);
+    }
+
+    const LodSelector selector(60.0F);
+    REQUIRE(selector.select(errors, 0.5F, 0) == 0);
+
+    const auto far_level = selector.select(errors, 10000.0F, 0);
+    REQUIRE(far_level == lods.size());
+    REQUIRE(lods[far_level - 1].indexes.size() < mesh.indexes.size() / 4);
+}
@@ -0,0 +1,53 @@
+#include "util/pipeline_cache_header.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using steeplejack::PipelineCacheHeader;
+
+namespace
+{
+const PipelineCacheHeader kDevice = {
+    .vendor_id = 0x10DE,
+    .device_id = 0x2684,
+    .uuid = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16},
+};
+
+std::vector<std::byte> cache_data(const PipelineCacheHeader& header, uint32_t header_size = 32, size_t size = 64)
+{
+    std::vector<std::byte> data(PipelineCacheHeader::kSize);
+    const uint32_t fields[] = {header_size, PipelineCacheHeader::kVersionOne, header.vendor_id, header.device_id};
+    std::memcpy(data.data(), fields, sizeof(fields));
+    std::memcpy(data.data() + 16, header.uuid.data(), header.uuid.size());
+    data.resize(size);
+    return data;
+}
+} // namespace
+
+TEST_CASE("PipelineCacheHeader accepts data saved by the same device", "[util]")
+{
+    REQUIRE(kDevice.matches(cache_data(kDevice)));
+    REQUIRE(kDevice.matches(cache_data(kDevice, 48)));
+}
+
+TEST_CASE("PipelineCacheHeader rejects data from another device or a damaged file", "[util]")
+{
+    auto other_driver = kDevice;
+    other_driver.uuid[15] = 0;
+    auto other_device = kDevice;
+    other_device.device_id++;
+
+    CHECK_FALSE(kDevice.matches(cache_data(other_driver)));
+    CHECK_FALSE(kDevice.matches(cache_data(other_device)));
+    CHECK_FALSE(kDevice.matches({}));
+    CHECK_FALSE(kDevice.matches(cache_data(kDevice, 32, 16)));
+    CHECK_FALSE(kDevice.matches(cache_data(kDevice, 16)));
+    CHECK_FALSE(kDevice.matches(cache_data(kDevice, 128)));
+
+    auto version_two = cache_data(kDevice);
+    version_two[4] = std::byte{2};
+    CHECK_FALSE(kDevice.matches(version_two));
+}
@@ -0,0 +1,152 @@
+#include "model/draw_key.h"
+#include "model/raster_state_tracker.h"
+#include "util/radix_sort.h"
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+struct Item
+{
+    uint64_t key;
+    uint32_t order;
+};
+} // namespace
+
+TEST_CASE("radix_sort orders by key and is stable", "[util]")
+{
+    std::mt19937_64 random(42);
+    std::vector<Item> items;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        // few distinct values in the high bytes so that runs of equal keys exist and some passes are skipped
+        items.push_back({.key = (random() % 7) << 56U | (random() % 13), .order = i});
+    }
+
+    auto expected = items;
+    std::ranges::stable_sort(expected, {}, &Item::key);
+
+    std::vector<Item> scratch;
+    steeplejack::radix_sort(items, scratch, [](const Item& item) { return item.key; });
+
+    REQUIRE(items.size() == expected.size());
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        REQUIRE(items[i].key == expected[i].key);
+        REQUIRE(items[i].order == expected[i].order);
+    }
+}
+
+TEST_CASE("radix_sort handles trivial inputs", "[util]")
+{
+    std::vector<Item> scratch;
+
+    std::vector<Item> empty;
+    steeplejack::radix_sort(empty, scratch, [](const Item& item) { return item.key; });
+    REQUIRE(empty.empty());
+
+    std::vector<Item> same = {{.key = 5, .order = 0}, {.key = 5, .order = 1}, {.key = 5, .order = 2}};
+    steeplejack::radix_sort(same, scratch, [](const Item& item) { return item.key; });
+    REQUIRE(same[0].order == 0);
+    REQUIRE(same[1].order == 1);
+    REQUIRE(same[2].order == 2);
+}
+
+TEST_CASE("DrawKey orders state before depth and depth front to back", "[render_queue]")
+{
+    using steeplejack::DrawKey;
+
+    const auto near_key = DrawKey::encode(1, 0, 2, 3, 0.1F);
+    const auto far_key = DrawKey::encode(1, 0, 2, 3, 0.9F);
+    REQUIRE(near_key < far_key);
+    REQUIRE(DrawKey::state(near_key) == DrawKey::state(far_key));
+
+    REQUIRE(DrawKey::encode(0, 0, 9, 9, 1.0F) < DrawKey::encode(1, 0, 0, 0, 0.0F));
+    REQUIRE(DrawKey::encode(1, 0, 9, 9, 1.0F) < DrawKey::encode(1, 1, 0, 0, 0.0F));
+    REQUIRE(DrawKey::encode(1, 0, 1, 9, 1.0F) < DrawKey::encode(1, 0, 2, 0, 0.0F));
+    REQUIRE(DrawKey::encode(1, 0, 1, 1, 1.0F) < DrawKey::encode(1, 0, 1, 2, 0.0F));
+
+    const auto key = DrawKey::encode(7, 5, 300, 42, 0.5F);
+    REQUIRE(DrawKey::pipeline(key) == 7);
+    REQUIRE(DrawKey::raster(key) == 5);
+    REQUIRE(DrawKey::texture(key) == 300);
+    REQUIRE(DrawKey::geometry(key) == 42);
+
+    // The state of a key holds the same fields.
+    const auto state = DrawKey::state(key);
+    REQUIRE(DrawKey::state(state) == state);
+    REQUIRE_FALSE(DrawKey::blended(state));
+    REQUIRE(DrawKey::pipeline(state) == 7);
+    REQUIRE(DrawKey::raster(state) == 5);
+    REQUIRE(DrawKey::texture(state) == 300);
+    REQUIRE(DrawKey::geometry(state) == 42);
+
+    REQUIRE(DrawKey::encode(0, 0, 0, 0, -1.0F) == DrawKey::encode(0, 0, 0, 0, 0.0F));
+    REQUIRE(DrawKey::encode(0, 0, 0, 0, 2.0F) == DrawKey::encode(0, 0, 0, 0, 1.0F));
+}
+
+TEST_CASE("DrawKey orders blended draws after opaque ones and back to front", "[render_queue]")
+{
+    using steeplejack::DrawKey;
+
+    const auto opaque_key = DrawKey::encode(DrawKey::kMaxPipelines - 1, 0, 9, 9, 1.0F);
+    const auto near_key = DrawKey::encode(1, 0, 2, 3, 0.1F, true);
+    const auto far_key = DrawKey::encode(7, 3, 2, 3, 0.9F, true);
+    REQUIRE(opaque_key < far_key);
+    REQUIRE(far_key < near_key);
+    REQUIRE(DrawKey::blended(near_key));
+    REQUIRE_FALSE(DrawKey::blended(opaque_key));
+
+    // Depth decides before state, and equal state at different depths still merges.
+    REQUIRE(DrawKey::encode(1, 0, 0, 0, 0.9F, true) < DrawKey::encode(0, 0, 0, 0, 0.1F, true));
+    REQUIRE(DrawKey::state(near_key) == DrawKey::state(DrawKey::encode(1, 0, 2, 3, 0.5F, true)));
+    REQUIRE(DrawKey::state(near_key) != DrawKey::state(DrawKey::encode(1, 0, 2, 3, 0.1F)));
+
+    REQUIRE(DrawKey::pipeline(far_key) == 7);
+    REQUIRE(DrawKey::raster(far_key) == 3);
+    REQUIRE(DrawKey::texture(far_key) == 2);
+    REQUIRE(DrawKey::geometry(far_key) == 3);
+
+    const auto state = DrawKey::state(far_key);
+    REQUIRE(DrawKey::state(state) == state);
+    REQUIRE(DrawKey::blended(state));
+    REQUIRE(DrawKey::pipeline(state) == 7);
+    REQUIRE(DrawKey::raster(state) == 3);
+    REQUIRE(DrawKey::texture(state) == 2);
+    REQUIRE(DrawKey::geometry(state) == 3);
+}
+
+TEST_CASE("Opaque runs with different raster states each set their raster state", "[render_queue]")
+{
+    using steeplejack::DrawKey;
+    using steeplejack::RasterStateTracker;
+
+    // Double-sided and single-sided meshes sharing a pipeline, as with dynamic raster state, then another pipeline and
+    // a blended mesh.
+    std::vector<uint64_t> keys = {
+        DrawKey::encode(1, 1, 2, 3, 0.2F),
+        DrawKey::encode(1, 0, 2, 3, 0.4F),
+        DrawKey::encode(1, 0, 3, 3, 0.6F),
+        DrawKey::encode(2, 0, 2, 3, 0.1F),
+        DrawKey::encode(2, 2, 2, 3, 0.5F, true),
+    };
+    std::ranges::sort(keys);
+
+    // Set when the raster id of the run differs from the one set last.
+    const std::vector<bool> expected = {true, false, true, true, true};
+
+    RasterStateTracker dynamic(true);
+    RasterStateTracker baked(false);
+    RasterStateTracker overflowed(true);
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        INFO("run " << i);
+        CHECK(dynamic.set(DrawKey::state(keys[i]), false) == expected[i]);
+        CHECK_FALSE(baked.set(keys[i], false));
+        CHECK(overflowed.set(keys[i], true));
+    }
+}
@@ -0,0 +1,51 @@
+#include "util/directory_watcher.h"
+#include "util/shader_source.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using steeplejack::DirectoryWatcher;
+using steeplejack::ShaderSource;
+
+TEST_CASE("ShaderSource maps source files to shader names and stages", "[util]")
+{
+    REQUIRE(ShaderSource::file_name("gltf.frag") == "shader.gltf.frag");
+    REQUIRE(ShaderSource::shader_name("shader.gltf.frag") == "gltf.frag");
+    REQUIRE(ShaderSource::shader_name("shader.cubes_one.vert") == "cubes_one.vert");
+    REQUIRE(ShaderSource::stage("gltf.vert") == ShaderSource::Stage::kVertex);
+    REQUIRE(ShaderSource::stage("gltf.frag") == ShaderSource::Stage::kFragment);
+
+    CHECK_FALSE(ShaderSource::shader_name("CMakeLists.txt"));
+    CHECK_FALSE(ShaderSource::shader_name("shader.gltf.frag.swp"));
+    CHECK_FALSE(ShaderSource::stage("gltf.comp"));
+}
+
+TEST_CASE("ShaderSource hashes sources by content and seed", "[util]")
+{
+    const auto hash = ShaderSource::hash("void main() {}", 1);
+
+    REQUIRE(hash == ShaderSource::hash("void main() {}", 1));
+    CHECK_FALSE(hash == ShaderSource::hash("void main() { }", 1));
+    CHECK_FALSE(hash == ShaderSource::hash("void main() {}", 2));
+}
+
+TEST_CASE("DirectoryWatcher reports files written since the previous poll", "[util]")
+{
+    const auto directory = std::filesystem::temp_directory_path() / "steeplejack_directory_watcher";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    DirectoryWatcher watcher(directory);
+    REQUIRE(watcher.poll().empty());
+
+    std::ofstream(directory / "shader.gltf.frag") << "void main() {}";
+
+    const auto changed = watcher.poll();
+    REQUIRE(changed.size() == 1);
+    REQUIRE(changed[0] == "shader.gltf.frag");
+    REQUIRE(watcher.poll().empty());
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,38 @@
+#include "util/specialization_constants.h"
+
+#include <bit>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+
+using steeplejack::SpecializationConstants;
+
+TEST_CASE("SpecializationConstants stores every value as one word by id", "[util]")
+{
+    SpecializationConstants constants;
+    REQUIRE(constants.empty());
+
+    constants.set(2, 0.5F).set(0, true).set(1, -1);
+
+    const auto& values = constants.values();
+    REQUIRE(values.size() == 3);
+    REQUIRE(values.begin()->first == 0);
+    REQUIRE(values.at(0) == 1);
+    REQUIRE(values.at(1) == 0xffffffffU);
+    REQUIRE(values.at(2) == std::bit_cast<uint32_t>(0.5F));
+
+    constants.set(0, false);
+    REQUIRE(values.at(0) == 0);
+}
+
+TEST_CASE("SpecializationConstants compare and hash by their values", "[util]")
+{
+    const auto a = SpecializationConstants().set(0, true).set(1, 0.5F);
+    const auto b = SpecializationConstants().set(1, 0.5F).set(0, true);
+    const auto c = SpecializationConstants().set(0, false).set(1, 0.5F);
+
+    REQUIRE(a == b);
+    REQUIRE(a.hash() == b.hash());
+    CHECK_FALSE(a == c);
+    CHECK_FALSE(a.hash() == c.hash());
+    CHECK_FALSE(a == SpecializationConstants());
+}
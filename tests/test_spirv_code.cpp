@@ -0,0 +1,73 @@
+#include "util/spirv_code.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using steeplejack::Asset;
+using steeplejack::MappedFile;
+using steeplejack::SpirvCode;
+
+namespace
+{
+const std::vector<uint32_t> kWords = {0x07230203, 0x00010600, 0, 8, 0};
+
+std::vector<std::byte> bytes_of(const std::vector<uint32_t>& words, size_t offset)
+{
+    std::vector<std::byte> bytes(offset + words.size() * sizeof(uint32_t));
+    std::memcpy(bytes.data() + offset, words.data(), words.size() * sizeof(uint32_t));
+    return bytes;
+}
+} // namespace
+
+TEST_CASE("SpirvCode uses aligned words in place and copies unaligned ones", "[util]")
+{
+    const auto aligned = bytes_of(kWords, 0);
+    const auto in_place = SpirvCode(Asset(std::span(aligned)));
+    CHECK(static_cast<const void*>(in_place.words().data()) == static_cast<const void*>(aligned.data()));
+    CHECK(std::vector(in_place.words().begin(), in_place.words().end()) == kWords);
+
+    const auto unaligned = bytes_of(kWords, 1);
+    const auto copied = SpirvCode(Asset(std::span(unaligned).subspan(1)));
+    CHECK(static_cast<const void*>(copied.words().data()) != static_cast<const void*>(unaligned.data() + 1));
+    CHECK(std::vector(copied.words().begin(), copied.words().end()) == kWords);
+
+    // Moving keeps the words where they are.
+    auto moved = SpirvCode(std::vector(kWords));
+    const auto* words = moved.words().data();
+    const SpirvCode target = std::move(moved);
+    CHECK(target.words().data() == words);
+    CHECK(target.size_bytes() == kWords.size() * sizeof(uint32_t));
+
+    REQUIRE_THROWS_AS(SpirvCode(Asset(std::span(aligned).first(6))), std::runtime_error);
+}
+
+TEST_CASE("SpirvCode maps files and hashes its words", "[util]")
+{
+    const auto path = std::filesystem::temp_directory_path() / "steeplejack_test_spirv_code.spv";
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(kWords.data()),
+                   static_cast<std::streamsize>(kWords.size() * sizeof(uint32_t)));
+    }
+
+    {
+        const auto mapped = SpirvCode(std::make_unique<MappedFile>(path));
+        CHECK(std::vector(mapped.words().begin(), mapped.words().end()) == kWords);
+        CHECK(mapped.hash() == SpirvCode(std::vector(kWords)).hash());
+
+        auto changed = kWords;
+        changed[3] = 9;
+        CHECK(mapped.hash() != SpirvCode(std::move(changed)).hash());
+    }
+
+    std::filesystem::remove(path);
+}
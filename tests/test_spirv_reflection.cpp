@@ -0,0 +1,185 @@
+#include "util/spirv_reflection.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+using steeplejack::SpirvReflection;
+
+namespace
+{
+// Assembles SPIR-V by hand, one instruction at a time.
+struct Assembler
+{
+    std::vector<uint32_t> code = {SpirvReflection::kMagic, 0x00010600, 0, 64, 0};
+
+    Assembler& op(uint32_t opcode, std::initializer_list<uint32_t> operands)
+    {
+        code.push_back((static_cast<uint32_t>(operands.size() + 1) << 16U) | opcode);
+        code.insert(code.end(), operands);
+        return *this;
+    }
+};
+
+// The interface of shader.gltf.vert, plus a runtime array of textures in set 1:
+//
+//   layout(binding = 0) uniform Camera { mat4 proj; mat4 view; } camera;
+//   layout(std430, binding = 1) readonly buffer Instances { Instance instances[]; } instances;
+//   layout(push_constant) uniform Draw { uint instanceOffset; uint textureIndex; } draw;
+//   layout(set = 1, binding = 0) uniform sampler2DArray textures[];
+//   layout(location = 0) in vec3 inPosition;
+//   layout(location = 2) in vec4 inColor;
+//   gl_InstanceIndex
+std::vector<uint32_t> vertex_shader()
+{
+    enum : uint32_t
+    {
+        kFloat = 1,
+        kUint,
+        kVec3,
+        kVec4,
+        kMat4,
+        kCamera,
+        kCameraPointer,
+        kCameraVariable,
+        kInstance,
+        kInstances,
+        kInstancesBlock,
+        kInstancesPointer,
+        kInstancesVariable,
+        kDraw,
+        kDrawPointer,
+        kDrawVariable,
+        kImage,
+        kSampledImage,
+        kTextures,
+        kTexturesPointer,
+        kTexturesVariable,
+        kVec3Pointer,
+        kPosition,
+        kVec4Pointer,
+        kColor,
+        kUintPointer,
+        kInstanceIndex,
+    };
+
+    return Assembler()
+        .op(15, {0, 100, 0x6e69616d, 0})                       // OpEntryPoint Vertex %100 "main"
+        .op(71, {kCamera, 2})                                  // OpDecorate Block
+        .op(72, {kCamera, 0, 35, 0})                           // OpMemberDecorate Offset 0
+        .op(72, {kCamera, 0, 7, 16})                           // OpMemberDecorate MatrixStride 16
+        .op(72, {kCamera, 1, 35, 64})                          // OpMemberDecorate Offset 64
+        .op(71, {kCameraVariable, 34, 0})                      // OpDecorate DescriptorSet 0
+        .op(71, {kCameraVariable, 33, 0})                      // OpDecorate Binding 0
+        .op(71, {kInstancesBlock, 2})                          // OpDecorate Block
+        .op(71, {kInstancesVariable, 34, 0})                   // OpDecorate DescriptorSet 0
+        .op(71, {kInstancesVariable, 33, 1})                   // OpDecorate Binding 1
+        .op(71, {kDraw, 2})                                    // OpDecorate Block
+        .op(72, {kDraw, 0, 35, 0})                             // OpMemberDecorate Offset 0
+        .op(72, {kDraw, 1, 35, 4})                             // OpMemberDecorate Offset 4
+        .op(71, {kTexturesVariable, 34, 1})                    // OpDecorate DescriptorSet 1
+        .op(71, {kTexturesVariable, 33, 0})                    // OpDecorate Binding 0
+        .op(71, {kPosition, 30, 0})                            // OpDecorate Location 0
+        .op(71, {kColor, 30, 2})                               // OpDecorate Location 2
+        .op(71, {kInstanceIndex, 11, 43})                      // OpDecorate BuiltIn InstanceIndex
+        .op(22, {kFloat, 32})                                  // OpTypeFloat 32
+        .op(21, {kUint, 32, 0})                                // OpTypeInt 32 0
+        .op(23, {kVec3, kFloat, 3})                            // OpTypeVector
+        .op(23, {kVec4, kFloat, 4})                            // OpTypeVector
+        .op(24, {kMat4, kVec4, 4})                             // OpTypeMatrix
+        .op(30, {kCamera, kMat4, kMat4})                       // OpTypeStruct
+        .op(32, {kCameraPointer, 2, kCamera})                  // OpTypePointer Uniform
+        .op(59, {kCameraPointer, kCameraVariable, 2})          // OpVariable Uniform
+        .op(30, {kInstance, kMat4, kUint})                     // OpTypeStruct
+        .op(29, {kInstances, kInstance})                       // OpTypeRuntimeArray
+        .op(30, {kInstancesBlock, kInstances})                 // OpTypeStruct
+        .op(32, {kInstancesPointer, 12, kInstancesBlock})      // OpTypePointer StorageBuffer
+        .op(59, {kInstancesPointer, kInstancesVariable, 12})   // OpVariable StorageBuffer
+        .op(30, {kDraw, kUint, kUint})                         // OpTypeStruct
+        .op(32, {kDrawPointer, 9, kDraw})                      // OpTypePointer PushConstant
+        .op(59, {kDrawPointer, kDrawVariable, 9})              // OpVariable PushConstant
+        .op(25, {kImage, kFloat, 1, 0, 1, 0, 1, 0})            // OpTypeImage 2D Arrayed Sampled
+        .op(27, {kSampledImage, kImage})                       // OpTypeSampledImage
+        .op(29, {kTextures, kSampledImage})                    // OpTypeRuntimeArray
+        .op(32, {kTexturesPointer, 0, kTextures})              // OpTypePointer UniformConstant
+        .op(59, {kTexturesPointer, kTexturesVariable, 0})      // OpVariable UniformConstant
+        .op(32, {kVec3Pointer, 1, kVec3})                      // OpTypePointer Input
+        .op(59, {kVec3Pointer, kPosition, 1})                  // OpVariable Input
+        .op(32, {kVec4Pointer, 1, kVec4})                      // OpTypePointer Input
+        .op(59, {kVec4Pointer, kColor, 1})                     // OpVariable Input
+        .op(32, {kUintPointer, 1, kUint})                      // OpTypePointer Input
+        .op(59, {kUintPointer, kInstanceIndex, 1})             // OpVariable Input
+        .code;
+}
+
+//   layout(binding = 0) uniform sampler2D textures[kLength];
+//
+// with kLength an OpConstant, or an OpSpecConstant when spec_constant is set.
+std::vector<uint32_t> fragment_shader(bool spec_constant)
+{
+    enum : uint32_t
+    {
+        kFloat = 1,
+        kUint,
+        kLength,
+        kImage,
+        kSampledImage,
+        kTextures,
+        kTexturesPointer,
+        kTexturesVariable,
+    };
+
+    return Assembler()
+        .op(15, {4, 100, 0x6e69616d, 0})                       // OpEntryPoint Fragment %100 "main"
+        .op(71, {kTexturesVariable, 34, 0})                    // OpDecorate DescriptorSet 0
+        .op(71, {kTexturesVariable, 33, 0})                    // OpDecorate Binding 0
+        .op(22, {kFloat, 32})                                  // OpTypeFloat 32
+        .op(21, {kUint, 32, 0})                                // OpTypeInt 32 0
+        .op(spec_constant ? 50 : 43, {kUint, kLength, 4})      // OpConstant or OpSpecConstant 4
+        .op(25, {kImage, kFloat, 1, 0, 0, 0, 1, 0})            // OpTypeImage 2D Sampled
+        .op(27, {kSampledImage, kImage})                       // OpTypeSampledImage
+        .op(28, {kTextures, kSampledImage, kLength})           // OpTypeArray
+        .op(32, {kTexturesPointer, 0, kTextures})              // OpTypePointer UniformConstant
+        .op(59, {kTexturesPointer, kTexturesVariable, 0})      // OpVariable UniformConstant
+        .code;
+}
+} // namespace
+
+TEST_CASE("SpirvReflection reads descriptors, push constants and inputs", "[util]")
+{
+    const auto reflection = SpirvReflection::parse(vertex_shader());
+
+    REQUIRE(reflection.stage == SpirvReflection::Stage::kVertex);
+    REQUIRE(reflection.bindings.size() == 3);
+    REQUIRE(reflection.bindings[0] ==
+            SpirvReflection::Binding{0, 0, SpirvReflection::DescriptorType::kUniformBuffer, 1});
+    REQUIRE(reflection.bindings[1] ==
+            SpirvReflection::Binding{0, 1, SpirvReflection::DescriptorType::kStorageBuffer, 1});
+    REQUIRE(reflection.bindings[2] ==
+            SpirvReflection::Binding{1, 0, SpirvReflection::DescriptorType::kCombinedImageSampler, 0});
+    REQUIRE(reflection.push_constant_size == 8);
+    REQUIRE(reflection.input_locations == std::vector<uint32_t>{0, 2});
+}
+
+TEST_CASE("SpirvReflection sizes arrays by constants and rejects specialization constants", "[util]")
+{
+    const auto reflection = SpirvReflection::parse(fragment_shader(false));
+
+    REQUIRE(reflection.stage == SpirvReflection::Stage::kFragment);
+    REQUIRE(reflection.bindings.size() == 1);
+    REQUIRE(reflection.bindings[0] ==
+            SpirvReflection::Binding{0, 0, SpirvReflection::DescriptorType::kCombinedImageSampler, 4});
+
+    REQUIRE_THROWS_AS(SpirvReflection::parse(fragment_shader(true)), std::runtime_error);
+}
+
+TEST_CASE("SpirvReflection rejects data that is not SPIR-V", "[util]")
+{
+    REQUIRE_THROWS_AS(SpirvReflection::parse(std::vector<uint32_t>{1, 2, 3, 4, 5}), std::runtime_error);
+
+    auto truncated = vertex_shader();
+    truncated.pop_back();
+    REQUIRE_THROWS_AS(SpirvReflection::parse(truncated), std::runtime_error);
+}
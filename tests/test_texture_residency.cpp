@@ -0,0 +1,97 @@
+#include "util/texture_residency.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using steeplejack::TextureResidency;
+
+namespace
+{
+// A 4x4 RGBA8 texture: 64, 16 and 4 bytes for levels 0, 1 and 2.
+const std::vector<uint64_t> kLevels = {64, 16, 4};
+
+uint32_t level_of(const std::vector<TextureResidency<int>::Change>& changes, int key)
+{
+    for (const auto& change : changes)
+    {
+        if (change.key == key)
+        {
+            return change.level;
+        }
+    }
+
+    return std::numeric_limits<uint32_t>::max();
+}
+} // namespace
+
+TEST_CASE("TextureResidency maps on-screen size to a mip level", "[util]")
+{
+    REQUIRE(TextureResidency<int>::required_level(1024, 1024.0F, 11) == 0);
+    REQUIRE(TextureResidency<int>::required_level(1024, 2048.0F, 11) == 0);
+    REQUIRE(TextureResidency<int>::required_level(1024, 512.0F, 11) == 1);
+    REQUIRE(TextureResidency<int>::required_level(1024, 300.0F, 11) == 1);
+    REQUIRE(TextureResidency<int>::required_level(1024, 1.0F, 11) == 10);
+    REQUIRE(TextureResidency<int>::required_level(1024, 0.0F, 11) == 10);
+    REQUIRE(TextureResidency<int>::required_level(1024, std::numeric_limits<float>::infinity(), 11) == 0);
+}
+
+TEST_CASE("TextureResidency streams in requested levels within budget", "[util]")
+{
+    TextureResidency<int> residency(1024);
+    residency.add(1, kLevels, 2);
+
+    residency.request(1, 1);
+    residency.request(1, 0);
+    auto changes = residency.update();
+
+    REQUIRE(changes.size() == 1);
+    REQUIRE(level_of(changes, 1) == 0);
+    REQUIRE(residency.resident_bytes() == 84);
+
+    // Finer levels than needed are kept while there is room.
+    residency.request(1, 2);
+    REQUIRE(residency.update().empty());
+    REQUIRE(residency.update().empty());
+}
+
+TEST_CASE("TextureResidency evicts least recently used textures first", "[util]")
+{
+    TextureResidency<int> residency(84 + 20);
+    residency.add(1, kLevels, 2);
+    residency.add(2, kLevels, 2);
+
+    residency.request(1, 0);
+    residency.update();
+
+    residency.request(2, 0);
+    auto changes = residency.update();
+
+    REQUIRE(level_of(changes, 1) == 1);
+    REQUIRE(level_of(changes, 2) == 0);
+    REQUIRE(residency.resident_bytes() <= residency.budget());
+}
+
+TEST_CASE("TextureResidency degrades textures in view when over budget", "[util]")
+{
+    TextureResidency<int> residency(40);
+    residency.add(1, kLevels, 2);
+    residency.add(2, kLevels, 2);
+
+    residency.request(1, 0);
+    residency.request(2, 0);
+    auto changes = residency.update();
+
+    REQUIRE(level_of(changes, 1) == 1);
+    REQUIRE(level_of(changes, 2) == 1);
+    REQUIRE(residency.resident_bytes() == 40);
+
+    residency.set_budget(0);
+    residency.request(1, 0);
+    residency.request(2, 0);
+    residency.update();
+
+    REQUIRE(residency.resident_level(1) == 2);
+    REQUIRE(residency.resident_level(2) == 2);
+}
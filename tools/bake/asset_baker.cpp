@@ -0,0 +1,291 @@
+#include "asset_baker.h"
+
+#include "spdlog/spdlog.h"
+#include "stb_image.h"
+#include "util/asset_pack.h"
+#include "util/ktx2.h"
+#include "util/rgba_image.h"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <fstream>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+using namespace steeplejack;
+
+namespace
+{
+constexpr uint32_t kVkFormatR8G8B8A8Srgb = 43;
+} // namespace
+
+AssetBaker::AssetBaker(Options options) : m_options(std::move(options)) {}
+
+void AssetBaker::run()
+{
+    const auto files = collect_files();
+
+    std::set<std::string> names;
+    for (const auto& file : files)
+    {
+        names.insert(file.generic_string());
+    }
+
+    std::vector<Entry> entries;
+    for (const auto& file : files)
+    {
+        auto name = file.generic_string();
+        auto source = read_file(file);
+
+        // An authored .ktx2 next to an image wins, as it does when the engine loads loose files.
+        auto ktx2_name = std::filesystem::path(file).replace_extension(".ktx2").generic_string();
+        if (is_image(file))
+        {
+            if (names.contains(ktx2_name))
+            {
+                continue;
+            }
+
+            auto baked = bake_cached(name, source, ".ktx2", bake_image);
+            entries.push_back(create_entry(std::move(ktx2_name), std::move(baked)));
+            continue;
+        }
+
+        entries.push_back(create_entry(std::move(name), std::move(source)));
+    }
+
+    std::vector<AssetPack::Input> inputs;
+    for (const auto& entry : entries)
+    {
+        inputs.push_back({
+            .name = entry.name,
+            .bytes = entry.bytes,
+            .size = entry.size,
+            .compression = entry.compressed ? AssetPack::Compression::kLz4 : AssetPack::Compression::kNone,
+        });
+    }
+
+    // Written aside and moved into place, so that an engine starting meanwhile never maps half a pack.
+    const auto pack = AssetPack::write(inputs);
+    auto temporary = m_options.output;
+    temporary += ".tmp";
+    write_file(temporary, pack);
+    std::filesystem::rename(temporary, m_options.output);
+
+    spdlog::info("Baked {} entries into {} ({} bytes): {} baked, {} from cache",
+                 entries.size(),
+                 m_options.output.generic_string(),
+                 pack.size(),
+                 m_baked,
+                 m_cached);
+}
+
+// Files are named by their path relative to the working directory, the names the engine asks for. Hidden files,
+// documentation and the output itself are left out; the order is sorted so that packs are reproducible.
+std::vector<std::filesystem::path> AssetBaker::collect_files() const
+{
+    const auto output = std::filesystem::weakly_canonical(m_options.output);
+    const auto cache = std::filesystem::weakly_canonical(m_options.cache);
+
+    std::vector<std::filesystem::path> result;
+    for (const auto& input : m_options.inputs)
+    {
+        if (!std::filesystem::is_directory(input))
+        {
+            throw std::runtime_error("Failed to bake: " + input.generic_string() + " is not a directory");
+        }
+
+        for (const auto& item : std::filesystem::recursive_directory_iterator(input))
+        {
+            const auto& path = item.path();
+            const auto file_name = path.filename().string();
+            if (!item.is_regular_file() || file_name.starts_with('.') || path.extension() == ".md")
+            {
+                continue;
+            }
+
+            const auto canonical = std::filesystem::weakly_canonical(path);
+            if (canonical == output || canonical.string().starts_with(cache.string()))
+            {
+                continue;
+            }
+
+            result.push_back(path.lexically_normal());
+        }
+    }
+
+    std::ranges::sort(result);
+    return result;
+}
+
+std::vector<std::byte>
+AssetBaker::bake_cached(const std::string& name,
+                        std::span<const std::byte> source,
+                        const std::string& extension,
+                        const std::function<std::vector<std::byte>(std::span<const std::byte>)>& bake)
+{
+    const auto cache_path = m_options.cache / std::format("{:016x}{}", hash(source, kBakeVersion), extension);
+    if (std::filesystem::exists(cache_path))
+    {
+        m_cached++;
+        return read_file(cache_path);
+    }
+
+    spdlog::info("Baking {}", name);
+
+    auto baked = bake(source);
+    std::filesystem::create_directories(m_options.cache);
+    write_file(cache_path, baked);
+
+    m_baked++;
+    return baked;
+}
+
+// Textures stay uncompressed in the pack: the engine copies their levels to the GPU straight out of the map, touching
+// only the levels it streams in, where a compressed entry would have to be decompressed whole for any of them.
+AssetBaker::Entry AssetBaker::create_entry(std::string name, std::vector<std::byte> bytes) const
+{
+    const uint64_t size = bytes.size();
+    if (!m_options.lz4 || name.ends_with(".ktx2") || bytes.empty())
+    {
+        return {.name = std::move(name), .bytes = std::move(bytes), .size = size, .compressed = false};
+    }
+
+    std::vector<std::byte> compressed(LZ4_compressBound(static_cast<int>(bytes.size())));
+    const int compressed_size = LZ4_compress_HC(reinterpret_cast<const char*>(bytes.data()),
+                                                reinterpret_cast<char*>(compressed.data()),
+                                                static_cast<int>(bytes.size()),
+                                                static_cast<int>(compressed.size()),
+                                                LZ4HC_CLEVEL_MAX);
+
+    if (compressed_size <= 0 || static_cast<size_t>(compressed_size) > bytes.size() - bytes.size() / kMinSavingDivisor)
+    {
+        return {.name = std::move(name), .bytes = std::move(bytes), .size = size, .compressed = false};
+    }
+
+    compressed.resize(compressed_size);
+    return {.name = std::move(name), .bytes = std::move(compressed), .size = size, .compressed = true};
+}
+
+bool AssetBaker::is_image(const std::filesystem::path& path)
+{
+    auto extension = path.extension().string();
+    std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" ||
+        extension == ".bmp";
+}
+
+// Decodes the image to RGBA and stores its full mip chain, filtered as the engine would filter it.
+std::vector<std::byte> AssetBaker::bake_image(std::span<const std::byte> source)
+{
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    auto* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(source.data()),
+                                         static_cast<int>(source.size()),
+                                         &width,
+                                         &height,
+                                         &channels,
+                                         STBI_rgb_alpha);
+
+    if (pixels == nullptr)
+    {
+        throw std::runtime_error(std::string("Failed to decode image: ") + stbi_failure_reason());
+    }
+
+    const auto* pixel_bytes = reinterpret_cast<const std::byte*>(pixels);
+    std::vector<std::byte> rgba(pixel_bytes, pixel_bytes + static_cast<size_t>(width) * height * 4U);
+    stbi_image_free(pixels);
+
+    auto level_width = static_cast<uint32_t>(width);
+    auto level_height = static_cast<uint32_t>(height);
+
+    std::vector<std::vector<std::byte>> levels = {rgba};
+    while (level_width > 1 || level_height > 1)
+    {
+        downsample_rgba(rgba, level_width, level_height);
+        levels.push_back(rgba);
+    }
+
+    const std::vector<std::span<const std::byte>> level_spans(levels.begin(), levels.end());
+    return Ktx2::write(kVkFormatR8G8B8A8Srgb,
+                       1,
+                       static_cast<uint32_t>(width),
+                       static_cast<uint32_t>(height),
+                       level_spans,
+                       rgba_srgb_descriptor());
+}
+
+// Basic data format descriptor of VK_FORMAT_R8G8B8A8_SRGB: one block with a sample per channel, alpha linear.
+std::vector<std::byte> AssetBaker::rgba_srgb_descriptor()
+{
+    constexpr uint32_t kBlockSize = 24 + 4 * 16;
+    constexpr uint8_t kModelRgbsda = 1;
+    constexpr uint8_t kPrimariesBt709 = 1;
+    constexpr uint8_t kTransferSrgb = 2;
+    constexpr uint8_t kChannelAlpha = 15;
+    constexpr uint8_t kQualifierLinear = 0x10;
+
+    std::vector<std::byte> result(4 + kBlockSize);
+    Ktx2::store<uint32_t>(result, 0, static_cast<uint32_t>(result.size()));
+    Ktx2::store<uint32_t>(result, 4, 0);
+    Ktx2::store<uint32_t>(result, 8, 2U | (kBlockSize << 16U));
+    Ktx2::store<uint8_t>(result, 12, kModelRgbsda);
+    Ktx2::store<uint8_t>(result, 13, kPrimariesBt709);
+    Ktx2::store<uint8_t>(result, 14, kTransferSrgb);
+    Ktx2::store<uint8_t>(result, 20, 4);
+
+    const uint8_t channels[] = {0, 1, 2, kChannelAlpha | kQualifierLinear};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const size_t sample = 28 + i * 16;
+        Ktx2::store<uint16_t>(result, sample, static_cast<uint16_t>(i * 8));
+        Ktx2::store<uint8_t>(result, sample + 2, 7);
+        Ktx2::store<uint8_t>(result, sample + 3, channels[i]);
+        Ktx2::store<uint32_t>(result, sample + 12, 255);
+    }
+
+    return result;
+}
+
+// 64-bit FNV-1a.
+uint64_t AssetBaker::hash(std::span<const std::byte> bytes, uint64_t seed)
+{
+    uint64_t result = 0xcbf29ce484222325ULL ^ seed;
+    for (auto byte : bytes)
+    {
+        result = (result ^ std::to_integer<uint64_t>(byte)) * 0x100000001b3ULL;
+    }
+
+    return result;
+}
+
+std::vector<std::byte> AssetBaker::read_file(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open file: " + path.generic_string());
+    }
+
+    std::vector<std::byte> result(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(result.size()));
+
+    return result;
+}
+
+void AssetBaker::write_file(const std::filesystem::path& path, std::span<const std::byte> bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write file: " + path.generic_string());
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "util/no_copy_or_move.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace steeplejack
+{
+// Turns the files under the input directories into an asset pack the engine maps at startup. Images are decoded once
+// here and stored as KTX2 files with their full mip chain, so the engine uploads them as they lie in the pack instead
+// of decoding and blitting mips on every launch; everything else, SPIR-V and glTF models included, is packed as it is.
+// Baked outputs are cached under a hash of their input, so unchanged inputs are not baked again.
+class AssetBaker : NoCopyOrMove
+{
+  public:
+    struct Options
+    {
+        std::vector<std::filesystem::path> inputs;
+        std::filesystem::path output;
+        std::filesystem::path cache;
+        bool lz4;
+    };
+
+  private:
+    // Changes whenever a baked output would come out differently, so that older cache entries are not used.
+    static constexpr uint64_t kBakeVersion = 1;
+
+    // Entries compressed with --lz4 must shrink by at least this fraction to be stored compressed.
+    static constexpr size_t kMinSavingDivisor = 8;
+
+    struct Entry
+    {
+        std::string name;
+        std::vector<std::byte> bytes;
+        uint64_t size;
+        bool compressed;
+    };
+
+    const Options m_options;
+
+    size_t m_baked = 0;
+    size_t m_cached = 0;
+
+    std::vector<std::filesystem::path> collect_files() const;
+
+    std::vector<std::byte> bake_cached(const std::string& name,
+                                       std::span<const std::byte> source,
+                                       const std::string& extension,
+                                       const std::function<std::vector<std::byte>(std::span<const std::byte>)>& bake);
+
+    Entry create_entry(std::string name, std::vector<std::byte> bytes) const;
+
+    static bool is_image(const std::filesystem::path& path);
+    static std::vector<std::byte> bake_image(std::span<const std::byte> source);
+    static std::vector<std::byte> rgba_srgb_descriptor();
+
+    static uint64_t hash(std::span<const std::byte> bytes, uint64_t seed);
+    static std::vector<std::byte> read_file(const std::filesystem::path& path);
+    static void write_file(const std::filesystem::path& path, std::span<const std::byte> bytes);
+
+  public:
+    AssetBaker(Options options);
+
+    void run();
+};
+} // namespace steeplejack
@@ -0,0 +1,69 @@
+#include "asset_baker.h"
+
+#include "spdlog/spdlog.h"
+
+#include <exception>
+#include <iostream>
+#include <string_view>
+#include <utility>
+
+namespace
+{
+void usage()
+{
+    std::cerr << "Usage: steeplejack_bake [--output <pack>] [--cache <dir>] [--lz4] [<input dir>...]\n"
+                 "Run from the directory the engine runs in. Inputs default to assets and shaders, the output to "
+                 "assets.pack and the cache to .bake_cache.\n";
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    using namespace steeplejack;
+
+    AssetBaker::Options options = {
+        .inputs = {},
+        .output = "assets.pack",
+        .cache = ".bake_cache",
+        .lz4 = false,
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view arg = argv[i];
+        if ((arg == "--output" || arg == "--cache") && i + 1 < argc)
+        {
+            (arg == "--output" ? options.output : options.cache) = argv[++i];
+        }
+        else if (arg == "--lz4")
+        {
+            options.lz4 = true;
+        }
+        else if (arg.starts_with("-"))
+        {
+            usage();
+            return 1;
+        }
+        else
+        {
+            options.inputs.emplace_back(arg);
+        }
+    }
+
+    if (options.inputs.empty())
+    {
+        options.inputs = {"assets", "shaders"};
+    }
+
+    try
+    {
+        AssetBaker(std::move(options)).run();
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::error("Fatal: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}